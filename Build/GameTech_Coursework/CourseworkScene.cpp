@@ -7,7 +7,9 @@
 #include <ncltech\CommonUtils.h>
 #include <ncltech\CuboidCollisionShape.h>
 #include <ncltech\DistanceConstraint.h>
+#include <ncltech\DynamicTreeBroadphase.h>
 #include <ncltech\HullCollisionShape.h>
+#include <ncltech\IncrementalSortAndSweepBroadphase.h>
 #include <ncltech\ObjectMesh.h>
 #include <ncltech\OctreeBroadphase.h>
 #include <ncltech\PhysicsEngine.h>
@@ -167,6 +169,15 @@ CourseworkScene::CourseworkScene()
       NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: sort and sweep (z axis)");
     });
 
+    State *sortAndSweepIncremental =
+        new State("sort_and_sweep_incremental", m_broadphaseModeStateMachine.RootState(), &m_broadphaseModeStateMachine);
+    sortAndSweepIncremental->AddOnEntryBehaviour(removePrevBroadphase);
+    sortAndSweepIncremental->AddOnEntryBehaviour(
+        [](State *) { PhysicsEngine::Instance()->SetBroadphase(new IncrementalSortAndSweepBroadphase()); });
+    sortAndSweepIncremental->AddOnOperateBehaviour([BROADPHASE_MODE_STATUS_COLOUR]() {
+      NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: incremental sort and sweep (all axes)");
+    });
+
     State *bruteForce = new State("brute_force", m_broadphaseModeStateMachine.RootState(), &m_broadphaseModeStateMachine);
     bruteForce->AddOnEntryBehaviour(removePrevBroadphase);
     bruteForce->AddOnEntryBehaviour([](State *) { PhysicsEngine::Instance()->SetBroadphase(new BruteForceBroadphase()); });
@@ -177,20 +188,26 @@ CourseworkScene::CourseworkScene()
     State *octree = new State("octree", m_broadphaseModeStateMachine.RootState(), &m_broadphaseModeStateMachine);
     octree->AddOnEntryBehaviour(removePrevBroadphase);
     octree->AddOnEntryBehaviour(
-        [](State *) { PhysicsEngine::Instance()->SetBroadphase(new OctreeBroadphase(10, 5, new BruteForceBroadphase())); });
+        [](State *) { PhysicsEngine::Instance()->SetBroadphase(new OctreeBroadphase(10, 5)); });
     octree->AddOnOperateBehaviour([BROADPHASE_MODE_STATUS_COLOUR]() {
-      NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: octree (obj. lim 10, div. lim. 5, brute force)");
+      NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: loose octree (obj. lim 10, div. lim. 5)");
     });
 
-    State *octreeSortSweepHybrid =
-        new State("octree_sortsweep_hybrid", m_broadphaseModeStateMachine.RootState(), &m_broadphaseModeStateMachine);
-    octreeSortSweepHybrid->AddOnEntryBehaviour(removePrevBroadphase);
-    octreeSortSweepHybrid->AddOnEntryBehaviour([](State *) {
-      PhysicsEngine::Instance()->SetBroadphase(
-          new OctreeBroadphase(20, 4, new SortAndSweepBroadphase(Vector3(0.0f, 0.0f, 1.0f))));
+    State *octreeCoarse =
+        new State("octree_coarse", m_broadphaseModeStateMachine.RootState(), &m_broadphaseModeStateMachine);
+    octreeCoarse->AddOnEntryBehaviour(removePrevBroadphase);
+    octreeCoarse->AddOnEntryBehaviour([](State *) {
+      PhysicsEngine::Instance()->SetBroadphase(new OctreeBroadphase(20, 4));
     });
-    octreeSortSweepHybrid->AddOnOperateBehaviour([BROADPHASE_MODE_STATUS_COLOUR]() {
-      NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: octree (obj. lim 20, div. lim. 4, sort/sweep z)");
+    octreeCoarse->AddOnOperateBehaviour([BROADPHASE_MODE_STATUS_COLOUR]() {
+      NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: loose octree (obj. lim 20, div. lim. 4)");
+    });
+
+    State *dynamicTree = new State("dynamic_tree", m_broadphaseModeStateMachine.RootState(), &m_broadphaseModeStateMachine);
+    dynamicTree->AddOnEntryBehaviour(removePrevBroadphase);
+    dynamicTree->AddOnEntryBehaviour([](State *) { PhysicsEngine::Instance()->SetBroadphase(new DynamicTreeBroadphase()); });
+    dynamicTree->AddOnOperateBehaviour([BROADPHASE_MODE_STATUS_COLOUR]() {
+      NCLDebug::AddStatusEntry(BROADPHASE_MODE_STATUS_COLOUR, "Broadphase: dynamic AABB tree (margin 0.1)");
     });
 
     // State transitions
@@ -200,17 +217,24 @@ CourseworkScene::CourseworkScene()
     sortAndSweepY->AddTransferFromTest(
         [sortAndSweepZ]() { return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? sortAndSweepZ : nullptr; });
 
-    sortAndSweepZ->AddTransferFromTest(
+    sortAndSweepZ->AddTransferFromTest([sortAndSweepIncremental]() {
+      return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? sortAndSweepIncremental : nullptr;
+    });
+
+    sortAndSweepIncremental->AddTransferFromTest(
         [bruteForce]() { return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? bruteForce : nullptr; });
 
     bruteForce->AddTransferFromTest(
         [octree]() { return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? octree : nullptr; });
 
-    octree->AddTransferFromTest([octreeSortSweepHybrid]() {
-      return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? octreeSortSweepHybrid : nullptr;
+    octree->AddTransferFromTest([octreeCoarse]() {
+      return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? octreeCoarse : nullptr;
     });
 
-    octreeSortSweepHybrid->AddTransferFromTest(
+    octreeCoarse->AddTransferFromTest(
+        [dynamicTree]() { return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? dynamicTree : nullptr; });
+
+    dynamicTree->AddTransferFromTest(
         [sortAndSweepX]() { return Window::GetKeyboard()->KeyTriggered(BROADPHASE_MODE_KEY) ? sortAndSweepX : nullptr; });
 
     // Default state
@@ -370,21 +394,21 @@ void CourseworkScene::OnInitializeScene()
     m_planet->Physics()->AddCollisionShape(shape);
     m_planet->Physics()->SetInverseInertia(shape->BuildInverseInertia(0.0f));
 
-    // Never perform at rest test on planet (should always rotate)
-    m_planet->Physics()->SetRestVelocityThreshold(0.0f);
+    // Planet motion is scripted, it is never integrated or pushed by other objects
+    m_planet->Physics()->SetKinematic(true);
 
     m_planet->Physics()->AutoResizeBoundingBox();
 
     AddGameObject(m_planet);
 
     // Planet rotation
-    m_planet->Physics()->SetDampingCoefficient(1.0f);
     m_planet->Physics()->SetAngularVelocity(Vector3(0.0f, 0.01f, 0.0f));
 
     // Planet atmosphere
     {
       m_atmosphere = new PhysicsObject();
       m_atmosphere->SetCollisionsEnabled(false);
+      m_atmosphere->SetTrigger(true);
       m_atmosphere->SetPosition(PLANET_POSITION);
 
       // Spherical collision shape bigger than the planet
@@ -392,8 +416,11 @@ void CourseworkScene::OnInitializeScene()
       m_atmosphere->AddCollisionShape(shape);
       m_atmosphere->AutoResizeBoundingBox();
 
-      // Collision handler
-      m_atmosphere->SetOnCollisionCallback([this](PhysicsObject *a, PhysicsObject *b) {
+      // Overlap handler
+      m_atmosphere->AddContactEventCallback([this](PhysicsObject *a, PhysicsObject *b, const ContactEvent &e) {
+        if (e.type == CONTACT_EVENT_END || b == nullptr)
+          return;
+
         bool valid = !(b == m_planet->Physics() || b == m_target->Physics() || b == m_lampPost->Physics());
 
         if (valid)
@@ -411,8 +438,6 @@ void CourseworkScene::OnInitializeScene()
             obj->SetColour(col);
           }
         }
-
-        return false;
       });
 
       PhysicsEngine::Instance()->AddPhysicsObject(m_atmosphere);
@@ -4,6 +4,7 @@
 #include <nclgl/Quaternion.h>
 #include <nclgl/Vector3.h>
 #include <ncltech/PhysicsNetworkController.h>
+#include <ncltech/PhysicsProfile.h>
 #include <ncltech/Utility.h>
 #include <sstream>
 
@@ -123,6 +124,19 @@ void ClientCLI::InitCLI()
             printf("Object \"%s\" collises with \"%s\"", tokens[2].c_str(), msg);
             return true;
           }
+          // Is a profile message?
+          else if (tokens[1] == "profile")
+          {
+            PhysicsProfile p;
+            memcpy(&p, msg, sizeof(PhysicsProfile));
+
+            printf("Physics profile over %zu steps (%.3fms):\n", p.numSteps, p.totalMs);
+            printf("  broadphase %.3fms, narrowphase %.3fms, pre-solve %.3fms, solver %.3fms, integration %.3fms\n",
+                   p.broadphaseMs, p.narrowphaseMs, p.preSolveMs, p.solverMs, p.integrationMs);
+            printf("  %zu pairs, %zu manifolds, %zu contacts, %zu awake bodies, %zu solver iterations\n",
+                   p.numBroadphasePairs, p.numManifolds, p.numContacts, p.numAwakeBodies, p.numSolverIterations);
+            return true;
+          }
 
           return false;
         });
@@ -401,6 +415,38 @@ void ClientCLI::InitCLI()
 
       physicsCommands->registerCommand(std::make_shared<Command>("collsub", func, 2, "Subscribe to collision messages."));
     }
+
+    // Subscribe to profile
+    {
+      auto func = [this](std::istream &in, std::ostream &out, std::vector<std::string> &argv) -> int {
+        if (m_broker == nullptr)
+        {
+          out << "Not connected to a server.\n";
+          return 1;
+        }
+
+        // Generate message
+        bool enable = Utility::StringToBool(argv[1], true);
+        char msg = enable ? 'Y' : 'N';
+
+        // Subscribe to or unsubscribe from profile updates
+        if (enable)
+          m_broker->Subscribe(m_pubSubClients["physics"], "physics/profile");
+        else
+          m_broker->UnSubscribe(m_pubSubClients["physics"], "physics/profile");
+
+        // Broadcast message
+        {
+          std::lock_guard<std::mutex> lock(m_broker->Mutex());
+          m_broker->BroadcastMessage(m_pubSubClients["physics"], "physics/profilesub", &msg, 1);
+        }
+
+        return COMMAND_EXIT_CLEAN;
+      };
+
+      physicsCommands->registerCommand(
+          std::make_shared<Command>("profile", func, 2, "Enables or disables physics profile messages. [enable]"));
+    }
   }
 
   // Game specific commands
@@ -21,9 +21,15 @@ IShootable::IShootable(Player *owner, float lifetime)
 {
   CreatePhysicsNode();
 
+  // Shots are fast enough to pass through thin targets between physics steps
+  m_pPhysicsObject->SetContinuousCollisionEnabled(true);
+
   // Collision handler
   {
-    m_pPhysicsObject->AddOnCollisionManifoldCallback([this](PhysicsObject *a, PhysicsObject *b, Manifold *m) {
+    m_pPhysicsObject->AddContactEventCallback([this](PhysicsObject *a, PhysicsObject *b, const ContactEvent &e) {
+      if (e.type == CONTACT_EVENT_END || b == nullptr)
+        return;
+
       // Check if the ball hit the target
       if (b->GetAssociatedObject() != nullptr && b->GetAssociatedObject()->GetName() == "target")
       {
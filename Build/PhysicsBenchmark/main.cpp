@@ -0,0 +1,399 @@
+#include <nclgl\GameTimer.h>
+#include <ncltech\BruteForceBroadphase.h>
+#include <ncltech\CommonUtils.h>
+#include <ncltech\DynamicTreeBroadphase.h>
+#include <ncltech\IncrementalSortAndSweepBroadphase.h>
+#include <ncltech\OctreeBroadphase.h>
+#include <ncltech\PhysicsEngine.h>
+#include <ncltech\SortAndSweepBroadphase.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <omp.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options controlling a benchmark run.
+ */
+struct BenchmarkOptions
+{
+  std::string scene;      //!< Name of scene to run ("all" for every scene)
+  size_t size;            //!< Scene size parameter (stack height, pyramid base, sphere grid edge or cloth edge)
+  size_t steps;           //!< Number of physics steps to simulate
+  std::string broadphase; //!< Broadphase name
+  std::string solver;     //!< Solver name
+  int threads;            //!< Number of OpenMP threads (0 for the runtime default)
+};
+
+/**
+ * @brief Timings and final state of a single scene run.
+ */
+struct BenchmarkResult
+{
+  size_t numBodies;       //!< Number of physics objects in the scene
+  size_t numConstraints;  //!< Number of misc constraints in the scene
+  float buildMs;          //!< Time taken to build the scene
+  float stepTotalMs;      //!< Total time spent stepping the simulation
+  float stepMinMs;        //!< Shortest physics step
+  float stepMaxMs;        //!< Longest physics step
+  float teardownMs;       //!< Time taken to remove the scene
+  double checksum;        //!< Checksum of final object positions
+  PhysicsProfile profile; //!< Engine stage timings and counts summed over all steps
+};
+
+typedef void (*SceneBuilder)(size_t size, std::vector<Object *> &objects);
+
+/**
+ * @brief Builds a static ground plane large enough for a scene of a given size.
+ * @param size Scene size
+ * @param objects List of objects to append to
+ */
+void BuildGround(size_t size, std::vector<Object *> &objects)
+{
+  float extent = 10.0f + (float)size;
+  objects.push_back(CommonUtils::BuildCuboidObject("ground", Vector3(0.0f, -1.0f, 0.0f), Vector3(extent, 1.0f, extent), true,
+                                                   0.0f, true, false));
+}
+
+/**
+ * @brief Builds a unit cube with material properties suited to resting contact.
+ * @param name Object name
+ * @param pos Initial position
+ * @return New object
+ */
+Object *BuildStackingCube(const std::string &name, const Vector3 &pos)
+{
+  Object *obj = CommonUtils::BuildCuboidObject(name, pos, Vector3(0.5f, 0.5f, 0.5f), true, 1.0f, true, false);
+
+  // Default elasticity is high enough for stacked cubes to bounce apart
+  obj->Physics()->SetFriction(0.8f);
+  obj->Physics()->SetElasticity(0.1f);
+
+  return obj;
+}
+
+/**
+ * @brief Builds a single column of cubes.
+ * @param size Number of cubes
+ * @param objects List of objects to append to
+ */
+void BuildStackScene(size_t size, std::vector<Object *> &objects)
+{
+  BuildGround(size, objects);
+
+  for (size_t i = 0; i < size; ++i)
+    objects.push_back(BuildStackingCube("stack_cube", Vector3(0.0f, 0.5f + (float)i, 0.0f)));
+}
+
+/**
+ * @brief Builds a pyramid of cubes.
+ * @param size Number of cubes along the base
+ * @param objects List of objects to append to
+ */
+void BuildPyramidScene(size_t size, std::vector<Object *> &objects)
+{
+  BuildGround(size, objects);
+
+  for (size_t y = 0; y < size; ++y)
+  {
+    for (size_t x = 0; x < size - y; ++x)
+    {
+      Vector3 pos((float)x - (float)(size - y) * 0.5f + 0.5f, 0.5f + (float)y, 0.0f);
+      objects.push_back(BuildStackingCube("pyramid_cube", pos));
+    }
+  }
+}
+
+/**
+ * @brief Builds a cubic grid of spheres dropped onto the ground.
+ * @param size Number of spheres along each edge
+ * @param objects List of objects to append to
+ */
+void BuildSpheresScene(size_t size, std::vector<Object *> &objects)
+{
+  BuildGround(size, objects);
+
+  const float offset = (float)size * 0.6f;
+  for (size_t y = 0; y < size; ++y)
+  {
+    for (size_t z = 0; z < size; ++z)
+    {
+      for (size_t x = 0; x < size; ++x)
+      {
+        // Alternate layers are offset so the spheres do not settle in perfect columns
+        float shift = (float)(y % 2) * 0.25f;
+        Vector3 pos((float)x * 1.2f - offset + shift, 1.0f + (float)y * 1.2f, (float)z * 1.2f - offset + shift);
+        objects.push_back(CommonUtils::BuildSphereObject("sphere", pos, 0.5f, true, 1.0f, true, false));
+      }
+    }
+  }
+}
+
+/**
+ * @brief Builds a square soft body cloth hanging from a pole.
+ * @param size Number of nodes along each edge
+ * @param objects List of objects to append to
+ */
+void BuildSoftBodyScene(size_t size, std::vector<Object *> &objects)
+{
+  objects.push_back(CommonUtils::BuildSoftBodyDemo(Vector3(-(float)size, 0.0f, 0.0f), size, size));
+}
+
+/**
+ * @brief Builds a disk of small bodies orbiting a heavy central body under N-body gravitation.
+ * @param size Square root of the number of orbiting bodies divided by ten
+ * @param objects List of objects to append to
+ */
+void BuildOrbitsScene(size_t size, std::vector<Object *> &objects)
+{
+  PhysicsEngine *engine = PhysicsEngine::Instance();
+  engine->SetGravity(Vector3(0.0f, 0.0f, 0.0f));
+  engine->SetGravitationConstant(1.0f);
+  engine->SetNBodyGravityEnabled(true);
+
+  const float centralMass = 10000.0f;
+  objects.push_back(CommonUtils::BuildSphereObject("sun", Vector3(0.0f, 0.0f, 0.0f), 1.0f, true, 1.0f / centralMass, false,
+                                                   false));
+
+  // Bodies are spread over the disk on a golden angle spiral and given circular orbit velocities around the centre
+  const size_t numBodies = size * size * 10;
+  const float goldenAngle = 2.39996323f;
+  for (size_t i = 0; i < numBodies; ++i)
+  {
+    float radius = 5.0f + 40.0f * sqrtf(((float)i + 0.5f) / (float)numBodies);
+    float angle = (float)i * goldenAngle;
+    Vector3 dir(cosf(angle), 0.0f, sinf(angle));
+
+    Object *obj = CommonUtils::BuildSphereObject("planet", dir * radius, 0.2f, true, 1.0f, false, false);
+    obj->Physics()->SetLinearVelocity(Vector3(-dir.z, 0.0f, dir.x) * sqrtf(centralMass / radius));
+    objects.push_back(obj);
+  }
+}
+
+/**
+ * @brief Deletes an object and all of its children.
+ * @param obj Object to delete
+ */
+void DeleteObjectTree(Object *obj)
+{
+  for (Object *child : obj->GetChildren())
+    DeleteObjectTree(child);
+
+  delete obj;
+}
+
+/**
+ * @brief Creates the broadphase with a given name.
+ * @param name Broadphase name
+ * @return New broadphase, NULL if the name is not known
+ */
+IBroadphase *CreateBroadphase(const std::string &name)
+{
+  if (name == "brute")
+    return new BruteForceBroadphase();
+  if (name == "sap")
+    return new SortAndSweepBroadphase();
+  if (name == "isap")
+    return new IncrementalSortAndSweepBroadphase();
+  if (name == "octree")
+    return new OctreeBroadphase(10, 4);
+  if (name == "tree")
+    return new DynamicTreeBroadphase();
+  return NULL;
+}
+
+/**
+ * @brief Builds, simulates and removes a single scene.
+ * @param builder Function building the scene
+ * @param options Benchmark options
+ * @return Timings and checksum of the run
+ */
+BenchmarkResult RunScene(SceneBuilder builder, const BenchmarkOptions &options)
+{
+  PhysicsEngine *engine = PhysicsEngine::Instance();
+  BenchmarkResult result;
+  GameTimer timer;
+
+  // Every scene starts from the same engine state so runs are reproducible
+  engine->SetDefaults();
+  if (options.solver == "coloured")
+    engine->SetSolverType(SOLVER_GRAPH_COLOURED);
+
+  // Build
+  std::vector<Object *> objects;
+  timer.GetTimedMS();
+  builder(options.size, objects);
+  result.buildMs = timer.GetTimedMS();
+
+  // Simulate one fixed physics step at a time, independent of the update accumulator
+  result.stepTotalMs = 0.0f;
+  result.stepMinMs = 0.0f;
+  result.stepMaxMs = 0.0f;
+  result.profile.Reset();
+
+  for (size_t i = 0; i < options.steps; ++i)
+  {
+    WorldStepStats stats = engine->Step(1);
+    float stepMs = stats.wallMs;
+
+    result.profile.Accumulate(stats.profile);
+
+    result.stepTotalMs += stepMs;
+    if (i == 0 || stepMs < result.stepMinMs)
+      result.stepMinMs = stepMs;
+    if (i == 0 || stepMs > result.stepMaxMs)
+      result.stepMaxMs = stepMs;
+  }
+
+  // Checksum of final positions, identical between runs with the same options
+  const std::vector<PhysicsObject *> &bodies = engine->GetPhysicsObjects();
+  result.numBodies = bodies.size();
+  result.numConstraints = engine->NumConstraints();
+  result.checksum = 0.0;
+  for (size_t i = 0; i < bodies.size(); ++i)
+  {
+    const Vector3 &p = bodies[i]->GetPosition();
+    result.checksum += (double)(i + 1) * (p.x * 1.1 + p.y * 1.3 + p.z * 1.7);
+  }
+
+  // Teardown
+  timer.GetTimedMS();
+  engine->RemoveAllPhysicsObjects();
+  for (Object *obj : objects)
+    DeleteObjectTree(obj);
+  result.teardownMs = timer.GetTimedMS();
+
+  return result;
+}
+
+/**
+ * @brief Prints command line usage.
+ */
+void PrintUsage()
+{
+  printf("Usage: PhysicsBenchmark [options]\n");
+  printf("  -scene <stack|pyramid|spheres|softbody|orbits|all>  Scene to run (default: all)\n");
+  printf("  -size <n>                                            Scene size (default: 10)\n");
+  printf("  -steps <n>                                           Physics steps per scene (default: 600)\n");
+  printf("  -broadphase <brute|sap|isap|octree|tree>             Broadphase (default: sap)\n");
+  printf("  -solver <sequential|coloured>                        Constraint solver (default: sequential)\n");
+  printf("  -threads <n>                                         OpenMP threads (default: runtime default)\n");
+}
+
+/**
+ * @brief Parses command line options.
+ * @param argc Argument count
+ * @param argv Arguments
+ * @param options Options to populate
+ * @return True if the options are valid
+ */
+bool ParseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+  options.scene = "all";
+  options.size = 10;
+  options.steps = 600;
+  options.broadphase = "sap";
+  options.solver = "sequential";
+  options.threads = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i + 1 >= argc)
+      return false;
+
+    const char *value = argv[i + 1];
+
+    if (strcmp(argv[i], "-scene") == 0)
+      options.scene = value;
+    else if (strcmp(argv[i], "-size") == 0)
+      options.size = (size_t)atoi(value);
+    else if (strcmp(argv[i], "-steps") == 0)
+      options.steps = (size_t)atoi(value);
+    else if (strcmp(argv[i], "-broadphase") == 0)
+      options.broadphase = value;
+    else if (strcmp(argv[i], "-solver") == 0)
+      options.solver = value;
+    else if (strcmp(argv[i], "-threads") == 0)
+      options.threads = atoi(value);
+    else
+      return false;
+
+    ++i;
+  }
+
+  return options.size > 0 && (options.solver == "sequential" || options.solver == "coloured");
+}
+
+int main(int argc, char **argv)
+{
+  BenchmarkOptions options;
+  if (!ParseOptions(argc, argv, options))
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  IBroadphase *broadphase = CreateBroadphase(options.broadphase);
+  if (broadphase == NULL)
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  if (options.threads > 0)
+    omp_set_num_threads(options.threads);
+
+  const char *sceneNames[] = {"stack", "pyramid", "spheres", "softbody", "orbits"};
+  const SceneBuilder sceneBuilders[] = {BuildStackScene,    BuildPyramidScene, BuildSpheresScene,
+                                        BuildSoftBodyScene, BuildOrbitsScene};
+  const size_t numScenes = sizeof(sceneBuilders) / sizeof(SceneBuilder);
+
+  PhysicsEngine::Instance()->SetBroadphase(broadphase);
+
+  printf("size=%zu steps=%zu broadphase=%s solver=%s threads=%d\n\n", options.size, options.steps, options.broadphase.c_str(),
+         options.solver.c_str(), omp_get_max_threads());
+  printf("%-10s %8s %11s %10s %12s %10s %10s %12s %13s %20s\n", "scene", "bodies", "constraints", "build ms", "simulate ms",
+         "step avg", "step min", "step max", "teardown ms", "checksum");
+
+  std::vector<size_t> sceneIndices;
+  std::vector<BenchmarkResult> results;
+  for (size_t i = 0; i < numScenes; ++i)
+  {
+    if (options.scene != "all" && options.scene != sceneNames[i])
+      continue;
+
+    BenchmarkResult r = RunScene(sceneBuilders[i], options);
+    sceneIndices.push_back(i);
+    results.push_back(r);
+
+    printf("%-10s %8zu %11zu %10.3f %12.3f %10.4f %10.4f %12.4f %13.3f %20.6f\n", sceneNames[i], r.numBodies, r.numConstraints,
+           r.buildMs, r.stepTotalMs, r.stepTotalMs / (float)options.steps, r.stepMinMs, r.stepMaxMs, r.teardownMs, r.checksum);
+  }
+
+  // Engine stage timings and counts, averaged per step
+  printf("\n%-10s %12s %12s %12s %12s %12s %8s %10s %10s %8s %11s\n", "scene", "broadphase", "narrowphase", "pre-solve",
+         "solver", "integration", "pairs", "manifolds", "contacts", "awake", "iterations");
+
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const PhysicsProfile &p = results[i].profile;
+    const float n = (p.numSteps > 0) ? (float)p.numSteps : 1.0f;
+
+    printf("%-10s %12.4f %12.4f %12.4f %12.4f %12.4f %8.1f %10.1f %10.1f %8.1f %11.1f\n", sceneNames[sceneIndices[i]],
+           p.broadphaseMs / n, p.narrowphaseMs / n, p.preSolveMs / n, p.solverMs / n, p.integrationMs / n,
+           (float)p.numBroadphasePairs / n, (float)p.numManifolds / n, (float)p.numContacts / n, (float)p.numAwakeBodies / n,
+           (float)p.numSolverIterations / n);
+  }
+
+  PhysicsEngine::Release();
+
+  if (results.empty())
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  return 0;
+}
@@ -148,6 +148,12 @@ public:
                              (drawFlags & DEBUGDRAW_FLAGS_COLLISIONNORMALS) ? "Enabled" : "Disabled");
     NCLDebug::AddStatusEntry(Vector4(1.0f, 0.9f, 0.8f, 1.0f), "     Draw Manifolds : %s (Press M to toggle)",
                              (drawFlags & DEBUGDRAW_FLAGS_MANIFOLD) ? "Enabled" : "Disabled");
+    NCLDebug::AddStatusEntry(Vector4(1.0f, 0.9f, 0.8f, 1.0f), "     Solver : %s (Press B to toggle)",
+                             (PhysicsEngine::Instance()->GetSolverType() == SOLVER_GRAPH_COLOURED) ? "Graph Coloured"
+                                                                                                    : "Sequential");
+    NCLDebug::AddStatusEntry(Vector4(0.5f, 0.9f, 1.0f, 1.0f), "     Solver iterations: %zu (max %zu)",
+                             PhysicsEngine::Instance()->NumLastStepSolverIterations(),
+                             PhysicsEngine::Instance()->GetMaxSolverIterations());
 
     if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_C))
       drawFlags ^= DEBUGDRAW_FLAGS_COLLISIONVOLUMES;
@@ -158,6 +164,10 @@ public:
     if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_M))
       drawFlags ^= DEBUGDRAW_FLAGS_MANIFOLD;
 
+    if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_B))
+      PhysicsEngine::Instance()->SetSolverType(
+          (PhysicsEngine::Instance()->GetSolverType() == SOLVER_GRAPH_COLOURED) ? SOLVER_SEQUENTIAL : SOLVER_GRAPH_COLOURED);
+
     PhysicsEngine::Instance()->SetDebugDrawFlags(drawFlags);
   }
 };
\ No newline at end of file
@@ -82,6 +82,8 @@ void PrintStatusEntries()
   NCLDebug::AddStatusEntry(status_colour_header, "NCLTech Settings");
   NCLDebug::AddStatusEntry(status_colour, "     Physics Engine: %s (Press P to toggle)",
                            PhysicsEngine::Instance()->IsPaused() ? "Paused  " : "Enabled ");
+  NCLDebug::AddStatusEntry(status_colour, "     Physics Thread: %s (Press T to toggle)",
+                           PhysicsEngine::Instance()->IsPhysicsThreadRunning() ? "Running " : "Stopped ");
   NCLDebug::AddStatusEntry(status_colour, "     Monitor V-Sync: %s (Press V to toggle)",
                            SceneManager::Instance()->GetVsyncEnabled() ? "Enabled " : "Disabled");
   NCLDebug::AddStatusEntry(status_colour, "");
@@ -114,6 +116,14 @@ void HandleKeyboardInputs()
   if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_P))
     PhysicsEngine::Instance()->SetPaused(!PhysicsEngine::Instance()->IsPaused());
 
+  if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_T))
+  {
+    if (PhysicsEngine::Instance()->IsPhysicsThreadRunning())
+      PhysicsEngine::Instance()->StopPhysicsThread();
+    else
+      PhysicsEngine::Instance()->StartPhysicsThread();
+  }
+
   if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_V))
     SceneManager::Instance()->SetVsyncEnabled(!SceneManager::Instance()->GetVsyncEnabled());
 
@@ -1,8 +1,11 @@
 #include "Matrix3.h"
 #include "Matrix4.h"
-#include "OGLRenderer.h"
 #include "common.h"
 
+#ifndef NCLTECH_HEADLESS
+#include "OGLRenderer.h"
+#endif
+
 const Matrix3 Matrix3::Identity = Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 
 const Matrix3 Matrix3::ZeroMatrix = Matrix3(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
@@ -278,6 +278,15 @@ Quaternion Quaternion::Interpolate(const Quaternion &start, const Quaternion &en
     real_end.w = -end.w;
   }
 
+  // Rotations are (nearly) identical, slerp coefficients are undefined so interpolate linearly instead
+  if (cos_theta > 0.9999f)
+  {
+    Quaternion out(start.x + (real_end.x - start.x) * factor, start.y + (real_end.y - start.y) * factor,
+                   start.z + (real_end.z - start.z) * factor, start.w + (real_end.w - start.w) * factor);
+    out.Normalise();
+    return out;
+  }
+
   // Calculate interpolation coefficients
   float theta = acosf(cos_theta);    // extract theta from dot product's cos(theta)
   float inv_sin_theta = sinf(theta); // compute inverse rotation length 1.0f / sin(theta)
@@ -75,7 +75,7 @@ public:
     return Quaternion(x + a.x, y + a.y, z + a.z, w + a.w);
   }
 
-  Quaternion Interpolate(const Quaternion &pStart, const Quaternion &pEnd, float pFactor);
+  static Quaternion Interpolate(const Quaternion &pStart, const Quaternion &pEnd, float pFactor);
 
   friend std::ostream &operator<<(std::ostream &o, const Quaternion &q);
 };
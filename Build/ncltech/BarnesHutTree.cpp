@@ -0,0 +1,213 @@
+#include "BarnesHutTree.h"
+
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+/**
+ * @brief Creates a new empty tree.
+ */
+BarnesHutTree::BarnesHutTree()
+{
+}
+
+BarnesHutTree::~BarnesHutTree()
+{
+}
+
+/**
+ * @brief Rebuilds the tree over a set of bodies.
+ * @param positions Position of each body
+ * @param masses Mass of each body, bodies with zero mass are not added to the tree
+ */
+void BarnesHutTree::Build(const std::vector<Vector3> &positions, const std::vector<float> &masses)
+{
+  m_positions = positions;
+  m_masses = masses;
+  m_nodes.clear();
+  m_bodyIndices.clear();
+
+  // Find bounds of all bodies with mass
+  Vector3 lower, upper;
+  for (size_t i = 0; i < m_positions.size(); ++i)
+  {
+    if (m_masses[i] <= 0.0f)
+      continue;
+
+    const Vector3 &p = m_positions[i];
+    if (m_bodyIndices.empty())
+    {
+      lower = p;
+      upper = p;
+    }
+    else
+    {
+      lower = Vector3(min(lower.x, p.x), min(lower.y, p.y), min(lower.z, p.z));
+      upper = Vector3(max(upper.x, p.x), max(upper.y, p.y), max(upper.z, p.z));
+    }
+
+    m_bodyIndices.push_back((uint32_t)i);
+  }
+
+  if (m_bodyIndices.empty())
+    return;
+
+  m_scratch.resize(m_bodyIndices.size());
+
+  // Root is the smallest cube containing all bodies (padded so no body lies exactly on its boundary)
+  Vector3 extent = upper - lower;
+  Node root;
+  root.centre = (lower + upper) * 0.5f;
+  root.halfSize = max(max(extent.x, extent.y), extent.z) * 0.5f + 0.001f;
+  root.begin = 0;
+  root.end = (uint32_t)m_bodyIndices.size();
+  m_nodes.push_back(root);
+
+  BuildNode(0, 0);
+}
+
+/**
+ * @brief Computes the mass properties of a node and recursively subdivides it.
+ * @param nodeIdx Index of the node
+ * @param depth Depth of the node
+ */
+void BarnesHutTree::BuildNode(size_t nodeIdx, size_t depth)
+{
+  const uint32_t begin = m_nodes[nodeIdx].begin;
+  const uint32_t end = m_nodes[nodeIdx].end;
+
+  // Mass properties
+  float mass = 0.0f;
+  Vector3 weightedPosition;
+  for (uint32_t i = begin; i < end; ++i)
+  {
+    uint32_t body = m_bodyIndices[i];
+    mass += m_masses[body];
+    weightedPosition += m_positions[body] * m_masses[body];
+  }
+
+  Node &node = m_nodes[nodeIdx];
+  node.mass = mass;
+  node.centreOfMass = weightedPosition / mass;
+  node.leaf = (end - begin <= MAX_LEAF_BODIES) || (depth >= MAX_DEPTH);
+  for (size_t i = 0; i < 8; ++i)
+    node.children[i] = 0;
+
+  if (node.leaf)
+    return;
+
+  const Vector3 centre = node.centre;
+  const float childHalfSize = node.halfSize * 0.5f;
+
+  // Partition bodies between octants with a counting sort
+  auto octant = [this, &centre](uint32_t body) {
+    const Vector3 &p = m_positions[body];
+    return (p.x >= centre.x ? 1 : 0) | (p.y >= centre.y ? 2 : 0) | (p.z >= centre.z ? 4 : 0);
+  };
+
+  uint32_t counts[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  for (uint32_t i = begin; i < end; ++i)
+    counts[octant(m_bodyIndices[i])]++;
+
+  uint32_t offsets[9];
+  offsets[0] = begin;
+  for (size_t i = 0; i < 8; ++i)
+    offsets[i + 1] = offsets[i] + counts[i];
+
+  uint32_t insert[8];
+  std::copy(offsets, offsets + 8, insert);
+  for (uint32_t i = begin; i < end; ++i)
+  {
+    uint32_t body = m_bodyIndices[i];
+    m_scratch[insert[octant(body)]++] = body;
+  }
+  std::copy(m_scratch.begin() + begin, m_scratch.begin() + end, m_bodyIndices.begin() + begin);
+
+  // Create and build children (node references are invalidated as nodes are added)
+  for (size_t i = 0; i < 8; ++i)
+  {
+    if (counts[i] == 0)
+      continue;
+
+    Node child;
+    child.centre = centre + Vector3((i & 1) ? childHalfSize : -childHalfSize, (i & 2) ? childHalfSize : -childHalfSize,
+                                    (i & 4) ? childHalfSize : -childHalfSize);
+    child.halfSize = childHalfSize;
+    child.begin = offsets[i];
+    child.end = offsets[i + 1];
+
+    size_t childIdx = m_nodes.size();
+    m_nodes.push_back(child);
+    m_nodes[nodeIdx].children[i] = (uint32_t)childIdx;
+
+    BuildNode(childIdx, depth + 1);
+  }
+}
+
+/**
+ * @brief Computes the gravitational acceleration of a body due to all other bodies in the tree.
+ * @param body Index of the body
+ * @param openingAngle Largest ratio of node width to distance at which a node is treated as a point mass
+ * @param softening Softening length, avoids infinite accelerations between (nearly) coincident bodies
+ * @return Acceleration, excluding the gravitational constant
+ *
+ * Safe to call from multiple threads once the tree is built.
+ */
+Vector3 BarnesHutTree::ComputeAcceleration(size_t body, float openingAngle, float softening) const
+{
+  Vector3 acceleration;
+  if (m_nodes.empty())
+    return acceleration;
+
+  const Vector3 p = m_positions[body];
+  const float theta2 = openingAngle * openingAngle;
+  const float softening2 = softening * softening;
+
+  auto accumulate = [&acceleration, &p, softening2](const Vector3 &pos, float mass) {
+    Vector3 r = pos - p;
+    float dist2 = Vector3::Dot(r, r) + softening2;
+    float invDist = 1.0f / sqrtf(dist2);
+    acceleration += r * (mass * invDist * invDist * invDist);
+  };
+
+  // Depth first traversal, each level adds at most seven pending siblings
+  uint32_t stack[7 * MAX_DEPTH + 8];
+  size_t stackSize = 0;
+  stack[stackSize++] = 0;
+
+  while (stackSize > 0)
+  {
+    const Node &node = m_nodes[stack[--stackSize]];
+
+    // Treat the node as a point mass if it is small enough from here and does not contain the body
+    Vector3 r = node.centreOfMass - p;
+    float width = node.halfSize * 2.0f;
+    bool inside = fabsf(p.x - node.centre.x) <= node.halfSize && fabsf(p.y - node.centre.y) <= node.halfSize &&
+                  fabsf(p.z - node.centre.z) <= node.halfSize;
+
+    if (!inside && width * width < theta2 * Vector3::Dot(r, r))
+    {
+      accumulate(node.centreOfMass, node.mass);
+    }
+    else if (node.leaf)
+    {
+      for (uint32_t i = node.begin; i < node.end; ++i)
+      {
+        uint32_t other = m_bodyIndices[i];
+        if (other != body)
+          accumulate(m_positions[other], m_masses[other]);
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < 8; ++i)
+      {
+        if (node.children[i] != 0)
+          stack[stackSize++] = node.children[i];
+      }
+    }
+  }
+
+  return acceleration;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <nclgl\Vector3.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @class BarnesHutTree
+ * @author Dan Nixon
+ * @brief Octree of point masses used to approximate N-body gravitation with the Barnes-Hut method.
+ *
+ * Each node stores the total mass and centre of mass of the bodies below it. When computing the acceleration of a body,
+ * nodes that appear small from the body (node width / distance below the opening angle) are treated as a single point
+ * mass, giving O(n log n) work per step instead of O(n^2). An opening angle of zero gives the exact result.
+ *
+ * Nodes are held in a single array that is reused between builds.
+ */
+class BarnesHutTree
+{
+public:
+  /**
+   * @brief Number of bodies at or below which a node is not subdivided.
+   */
+  static const size_t MAX_LEAF_BODIES = 8;
+
+  /**
+   * @brief Maximum depth of the tree, limits subdivision of (nearly) coincident bodies.
+   */
+  static const size_t MAX_DEPTH = 24;
+
+public:
+  BarnesHutTree();
+  virtual ~BarnesHutTree();
+
+  void Build(const std::vector<Vector3> &positions, const std::vector<float> &masses);
+
+  Vector3 ComputeAcceleration(size_t body, float openingAngle, float softening) const;
+
+  /**
+   * @brief Gets the number of nodes in the tree.
+   * @return Node count
+   */
+  inline size_t NumNodes() const
+  {
+    return m_nodes.size();
+  }
+
+  /**
+   * @brief Gets the total mass of all bodies in the tree.
+   * @return Total mass
+   */
+  inline float TotalMass() const
+  {
+    return m_nodes.empty() ? 0.0f : m_nodes[0].mass;
+  }
+
+protected:
+  /**
+   * @brief Cubic region of space containing a subset of the bodies.
+   */
+  struct Node
+  {
+    Vector3 centre;       //!< Centre of the region
+    float halfSize;       //!< Half of the width of the region
+    Vector3 centreOfMass; //!< Centre of mass of the bodies in the region
+    float mass;           //!< Total mass of the bodies in the region
+    uint32_t begin;       //!< Index of the first body of the region in m_bodyIndices
+    uint32_t end;         //!< Index past the last body of the region in m_bodyIndices
+    uint32_t children[8]; //!< Node index of each non empty octant (0 if empty or a leaf)
+    bool leaf;            //!< Flag indicating the node is not subdivided
+  };
+
+  void BuildNode(size_t nodeIdx, size_t depth);
+
+protected:
+  std::vector<Node> m_nodes;           //!< Tree nodes, the root is at index 0
+  std::vector<Vector3> m_positions;    //!< Position of each body
+  std::vector<float> m_masses;         //!< Mass of each body
+  std::vector<uint32_t> m_bodyIndices; //!< Indices of bodies with mass, ordered so each node covers a contiguous range
+  std::vector<uint32_t> m_scratch;     //!< Temporary storage used when partitioning bodies between octants
+};
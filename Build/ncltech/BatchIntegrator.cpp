@@ -0,0 +1,545 @@
+#include "BatchIntegrator.h"
+
+#include "PhysicsObject.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCHINTEGRATOR_AVX
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define BATCHINTEGRATOR_SSE
+#endif
+
+const float BatchIntegrator::TOLERANCE = 1e-5f;
+
+namespace
+{
+/**
+ * @brief Maximum number of lanes in any SIMD implementation.
+ */
+const size_t MAX_LANES = 8;
+
+/**
+ * @brief Motion state for a group of bodies, with each component laid out across lanes.
+ */
+struct alignas(32) BodyLanes
+{
+  float position[3][MAX_LANES];
+  float linearVelocity[3][MAX_LANES];
+  float linearForce[3][MAX_LANES];
+  float inverseMass[MAX_LANES];
+  float orientation[4][MAX_LANES];
+  float angularVelocity[3][MAX_LANES];
+  float torque[3][MAX_LANES];
+  float inverseInertia[9][MAX_LANES];
+  float damping[MAX_LANES];
+};
+
+/**
+ * @brief Single lane fallback.
+ */
+struct ScalarLanes
+{
+  typedef float Reg;
+  static const size_t WIDTH = 1;
+
+  static inline Reg Load(const float *p)
+  {
+    return *p;
+  }
+
+  static inline void Store(float *p, Reg a)
+  {
+    *p = a;
+  }
+
+  static inline Reg Set(float a)
+  {
+    return a;
+  }
+
+  static inline Reg Add(Reg a, Reg b)
+  {
+    return a + b;
+  }
+
+  static inline Reg Sub(Reg a, Reg b)
+  {
+    return a - b;
+  }
+
+  static inline Reg Mul(Reg a, Reg b)
+  {
+    return a * b;
+  }
+
+  static inline Reg Div(Reg a, Reg b)
+  {
+    return a / b;
+  }
+
+  static inline Reg Neg(Reg a)
+  {
+    return -a;
+  }
+
+  static inline Reg Sqrt(Reg a)
+  {
+    return sqrtf(a);
+  }
+
+  static inline Reg SelectPositive(Reg test, Reg a, Reg b)
+  {
+    return (test > 0.0f) ? a : b;
+  }
+};
+
+#ifdef BATCHINTEGRATOR_SSE
+/**
+ * @brief Four lanes using SSE.
+ */
+struct SseLanes
+{
+  typedef __m128 Reg;
+  static const size_t WIDTH = 4;
+
+  static inline Reg Load(const float *p)
+  {
+    return _mm_load_ps(p);
+  }
+
+  static inline void Store(float *p, Reg a)
+  {
+    _mm_store_ps(p, a);
+  }
+
+  static inline Reg Set(float a)
+  {
+    return _mm_set1_ps(a);
+  }
+
+  static inline Reg Add(Reg a, Reg b)
+  {
+    return _mm_add_ps(a, b);
+  }
+
+  static inline Reg Sub(Reg a, Reg b)
+  {
+    return _mm_sub_ps(a, b);
+  }
+
+  static inline Reg Mul(Reg a, Reg b)
+  {
+    return _mm_mul_ps(a, b);
+  }
+
+  static inline Reg Div(Reg a, Reg b)
+  {
+    return _mm_div_ps(a, b);
+  }
+
+  static inline Reg Neg(Reg a)
+  {
+    return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+  }
+
+  static inline Reg Sqrt(Reg a)
+  {
+    return _mm_sqrt_ps(a);
+  }
+
+  static inline Reg SelectPositive(Reg test, Reg a, Reg b)
+  {
+    Reg mask = _mm_cmpgt_ps(test, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+};
+#endif
+
+#ifdef BATCHINTEGRATOR_AVX
+/**
+ * @brief Eight lanes using AVX.
+ */
+struct AvxLanes
+{
+  typedef __m256 Reg;
+  static const size_t WIDTH = 8;
+
+  static inline Reg Load(const float *p)
+  {
+    return _mm256_load_ps(p);
+  }
+
+  static inline void Store(float *p, Reg a)
+  {
+    _mm256_store_ps(p, a);
+  }
+
+  static inline Reg Set(float a)
+  {
+    return _mm256_set1_ps(a);
+  }
+
+  static inline Reg Add(Reg a, Reg b)
+  {
+    return _mm256_add_ps(a, b);
+  }
+
+  static inline Reg Sub(Reg a, Reg b)
+  {
+    return _mm256_sub_ps(a, b);
+  }
+
+  static inline Reg Mul(Reg a, Reg b)
+  {
+    return _mm256_mul_ps(a, b);
+  }
+
+  static inline Reg Div(Reg a, Reg b)
+  {
+    return _mm256_div_ps(a, b);
+  }
+
+  static inline Reg Neg(Reg a)
+  {
+    return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f));
+  }
+
+  static inline Reg Sqrt(Reg a)
+  {
+    return _mm256_sqrt_ps(a);
+  }
+
+  static inline Reg SelectPositive(Reg test, Reg a, Reg b)
+  {
+    return _mm256_blendv_ps(b, a, _mm256_cmp_ps(test, _mm256_setzero_ps(), _CMP_GT_OQ));
+  }
+};
+#endif
+
+/**
+ * @brief Three component vector across lanes.
+ */
+template <typename L> struct Vector3Lanes
+{
+  typename L::Reg x, y, z;
+};
+
+template <typename L> inline Vector3Lanes<L> Load3(const float (&a)[3][MAX_LANES], size_t lane)
+{
+  Vector3Lanes<L> v = {L::Load(&a[0][lane]), L::Load(&a[1][lane]), L::Load(&a[2][lane])};
+  return v;
+}
+
+template <typename L> inline void Store3(float (&a)[3][MAX_LANES], size_t lane, const Vector3Lanes<L> &v)
+{
+  L::Store(&a[0][lane], v.x);
+  L::Store(&a[1][lane], v.y);
+  L::Store(&a[2][lane], v.z);
+}
+
+template <typename L> inline Vector3Lanes<L> Add3(const Vector3Lanes<L> &a, const Vector3Lanes<L> &b)
+{
+  Vector3Lanes<L> v = {L::Add(a.x, b.x), L::Add(a.y, b.y), L::Add(a.z, b.z)};
+  return v;
+}
+
+template <typename L> inline Vector3Lanes<L> Mul3(const Vector3Lanes<L> &a, typename L::Reg s)
+{
+  Vector3Lanes<L> v = {L::Mul(a.x, s), L::Mul(a.y, s), L::Mul(a.z, s)};
+  return v;
+}
+
+template <typename L> inline Vector3Lanes<L> Div3(const Vector3Lanes<L> &a, typename L::Reg s)
+{
+  Vector3Lanes<L> v = {L::Div(a.x, s), L::Div(a.y, s), L::Div(a.z, s)};
+  return v;
+}
+
+/**
+ * @brief Equivalent of Matrix3 * Vector3.
+ */
+template <typename L> inline Vector3Lanes<L> MulMatrix3(const typename L::Reg (&m)[9], const Vector3Lanes<L> &b)
+{
+  Vector3Lanes<L> v = {L::Add(L::Add(L::Mul(m[0], b.x), L::Mul(m[3], b.y)), L::Mul(m[6], b.z)),
+                       L::Add(L::Add(L::Mul(m[1], b.x), L::Mul(m[4], b.y)), L::Mul(m[7], b.z)),
+                       L::Add(L::Add(L::Mul(m[2], b.x), L::Mul(m[5], b.y)), L::Mul(m[8], b.z))};
+  return v;
+}
+
+/**
+ * @brief Equivalent of q = q + (q * (w * dt * 0.5)); q.Normalise();
+ */
+template <typename L> inline void UpdateOrientation(typename L::Reg (&q)[4], const Vector3Lanes<L> &w, typename L::Reg dt)
+{
+  typedef typename L::Reg Reg;
+
+  Vector3Lanes<L> b = Mul3<L>(Mul3<L>(w, dt), L::Set(0.5f));
+
+  // Quaternion * Vector3 (see Quaternion::operator*)
+  Reg dw = L::Sub(L::Sub(L::Neg(L::Mul(q[0], b.x)), L::Mul(q[1], b.y)), L::Mul(q[2], b.z));
+  Reg dx = L::Sub(L::Add(L::Mul(q[3], b.x), L::Mul(b.y, q[2])), L::Mul(b.z, q[1]));
+  Reg dy = L::Sub(L::Add(L::Mul(q[3], b.y), L::Mul(b.z, q[0])), L::Mul(b.x, q[2]));
+  Reg dz = L::Sub(L::Add(L::Mul(q[3], b.z), L::Mul(b.x, q[1])), L::Mul(b.y, q[0]));
+
+  q[0] = L::Add(q[0], dx);
+  q[1] = L::Add(q[1], dy);
+  q[2] = L::Add(q[2], dz);
+  q[3] = L::Add(q[3], dw);
+
+  // Normalise (zero length quaternions are left untouched)
+  Reg magnitude =
+      L::Sqrt(L::Add(L::Add(L::Add(L::Mul(q[0], q[0]), L::Mul(q[1], q[1])), L::Mul(q[2], q[2])), L::Mul(q[3], q[3])));
+  Reg t = L::SelectPositive(magnitude, L::Div(L::Set(1.0f), magnitude), L::Set(1.0f));
+
+  for (size_t i = 0; i < 4; ++i)
+    q[i] = L::Mul(q[i], t);
+}
+
+/**
+ * @brief Integrates L::WIDTH bodies starting at a given lane.
+ * @param b Body state
+ * @param lane First lane
+ * @param dt Timestep
+ *
+ * Mirrors the operation order of IntegrationHelpers::Integrate(), the scheme is a template parameter.
+ */
+template <typename L, IntegrationType Type> void IntegrateLanes(BodyLanes &b, size_t lane, float dt)
+{
+  typedef typename L::Reg Reg;
+
+  const Reg timestep = L::Set(dt);
+  const Reg zero = L::Set(0.0f);
+  const Reg half = L::Set(0.5f);
+
+  Vector3Lanes<L> position = Load3<L>(b.position, lane);
+  Vector3Lanes<L> linearVelocity = Load3<L>(b.linearVelocity, lane);
+  Vector3Lanes<L> linearForce = Load3<L>(b.linearForce, lane);
+  Vector3Lanes<L> angularVelocity = Load3<L>(b.angularVelocity, lane);
+  Vector3Lanes<L> torque = Load3<L>(b.torque, lane);
+  Reg inverseMass = L::Load(&b.inverseMass[lane]);
+  Reg damping = L::Load(&b.damping[lane]);
+
+  Reg orientation[4];
+  for (size_t i = 0; i < 4; ++i)
+    orientation[i] = L::Load(&b.orientation[i][lane]);
+
+  Reg inverseInertia[9];
+  for (size_t i = 0; i < 9; ++i)
+    inverseInertia[i] = L::Load(&b.inverseInertia[i][lane]);
+
+  Vector3Lanes<L> acceleration = Mul3<L>(linearForce, inverseMass);
+  Vector3Lanes<L> angularAcceleration = MulMatrix3<L>(inverseInertia, torque);
+
+  if (Type == INTEGRATION_EXPLICIT_EULER)
+  {
+    position = Add3<L>(position, Mul3<L>(linearVelocity, timestep));
+    linearVelocity = Mul3<L>(Add3<L>(linearVelocity, Mul3<L>(acceleration, timestep)), damping);
+
+    UpdateOrientation<L>(orientation, angularVelocity, timestep);
+    angularVelocity = Mul3<L>(Add3<L>(angularVelocity, Mul3<L>(angularAcceleration, timestep)), damping);
+  }
+  else
+  {
+    switch (Type)
+    {
+    default:
+    case INTEGRATION_SEMI_IMPLICIT_EULER:
+    {
+      linearVelocity = Mul3<L>(Add3<L>(linearVelocity, Mul3<L>(acceleration, timestep)), damping);
+      position = Add3<L>(position, Mul3<L>(linearVelocity, timestep));
+      break;
+    }
+
+    case INTEGRATION_RUNGE_KUTTA_2:
+    {
+      Vector3Lanes<L> zeroVector = {zero, zero, zero};
+      Vector3Lanes<L> va = Add3<L>(linearVelocity, zeroVector);
+      Vector3Lanes<L> vb = Add3<L>(linearVelocity, Mul3<L>(acceleration, L::Set(dt * 0.5f)));
+
+      Vector3Lanes<L> dxdt = Mul3<L>(Add3<L>(va, vb), half);
+      Vector3Lanes<L> dvdt = Mul3<L>(Add3<L>(acceleration, acceleration), half);
+
+      position = Add3<L>(position, Mul3<L>(dxdt, timestep));
+      linearVelocity = Mul3<L>(Add3<L>(linearVelocity, Mul3<L>(dvdt, timestep)), damping);
+      break;
+    }
+
+    case INTEGRATION_RUNGE_KUTTA_4:
+    {
+      const Reg two = L::Set(2.0f);
+      const Reg six = L::Set(6.0f);
+
+      Vector3Lanes<L> zeroVector = {zero, zero, zero};
+      Vector3Lanes<L> va = Add3<L>(linearVelocity, zeroVector);
+      Vector3Lanes<L> vb = Add3<L>(linearVelocity, Mul3<L>(acceleration, L::Set(dt * 0.5f)));
+      Vector3Lanes<L> vc = vb;
+      Vector3Lanes<L> vd = Add3<L>(linearVelocity, Mul3<L>(acceleration, timestep));
+
+      Vector3Lanes<L> dxdt = Div3<L>(Add3<L>(Add3<L>(va, Mul3<L>(Add3<L>(vb, vc), two)), vd), six);
+      Vector3Lanes<L> dvdt =
+          Div3<L>(Add3<L>(Add3<L>(acceleration, Mul3<L>(Add3<L>(acceleration, acceleration), two)), acceleration), six);
+
+      position = Add3<L>(position, Mul3<L>(dxdt, timestep));
+      linearVelocity = Mul3<L>(Add3<L>(linearVelocity, Mul3<L>(dvdt, timestep)), damping);
+      break;
+    }
+    }
+
+    angularVelocity = Mul3<L>(Add3<L>(angularVelocity, Mul3<L>(angularAcceleration, timestep)), damping);
+    UpdateOrientation<L>(orientation, angularVelocity, timestep);
+  }
+
+  Store3<L>(b.position, lane, position);
+  Store3<L>(b.linearVelocity, lane, linearVelocity);
+  Store3<L>(b.angularVelocity, lane, angularVelocity);
+
+  for (size_t i = 0; i < 4; ++i)
+    L::Store(&b.orientation[i][lane], orientation[i]);
+}
+}
+
+/**
+ * @brief Gets the number of bodies integrated together by the SIMD path in this build.
+ * @return Lane count (1 if built without SIMD support)
+ */
+size_t BatchIntegrator::SimdWidth()
+{
+#if defined(BATCHINTEGRATOR_AVX)
+  return AvxLanes::WIDTH;
+#elif defined(BATCHINTEGRATOR_SSE)
+  return SseLanes::WIDTH;
+#else
+  return ScalarLanes::WIDTH;
+#endif
+}
+
+/**
+ * @brief Creates a new batch integrator.
+ */
+BatchIntegrator::BatchIntegrator()
+    : m_simdEnabled(true)
+{
+}
+
+BatchIntegrator::~BatchIntegrator()
+{
+}
+
+/**
+ * @brief Integrates the motion state of a set of bodies over one timestep.
+ * @param store Store holding body state
+ * @param indices Array indices of the bodies to integrate (normally all awake bodies)
+ * @param type Integration scheme
+ * @param dt Timestep
+ *
+ * Gravity is expected to have already been applied to the velocities of the bodies.
+ */
+void BatchIntegrator::Integrate(PhysicsBodyStore &store, const std::vector<size_t> &indices, IntegrationType type, float dt)
+{
+  switch (type)
+  {
+  case INTEGRATION_EXPLICIT_EULER:
+    Integrate<INTEGRATION_EXPLICIT_EULER>(store, indices, dt);
+    break;
+  default:
+  case INTEGRATION_SEMI_IMPLICIT_EULER:
+    Integrate<INTEGRATION_SEMI_IMPLICIT_EULER>(store, indices, dt);
+    break;
+  case INTEGRATION_RUNGE_KUTTA_2:
+    Integrate<INTEGRATION_RUNGE_KUTTA_2>(store, indices, dt);
+    break;
+  case INTEGRATION_RUNGE_KUTTA_4:
+    Integrate<INTEGRATION_RUNGE_KUTTA_4>(store, indices, dt);
+    break;
+  }
+}
+
+/**
+ * @brief Integrates the motion state of a set of bodies over one timestep using a given integration scheme.
+ * @param store Store holding body state
+ * @param indices Array indices of the bodies to integrate
+ * @param dt Timestep
+ */
+template <IntegrationType Type>
+void BatchIntegrator::Integrate(PhysicsBodyStore &store, const std::vector<size_t> &indices, float dt)
+{
+  const size_t width = m_simdEnabled ? SimdWidth() : 1;
+  BodyLanes lanes;
+
+  for (size_t start = 0; start < indices.size(); start += width)
+  {
+    size_t count = indices.size() - start;
+    if (count > width)
+      count = width;
+
+    // Copy body state into lanes
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+      size_t idx = indices[start + lane];
+
+      const Vector3 &p = store.m_positions[idx];
+      const Vector3 &v = store.m_linearVelocities[idx];
+      const Vector3 &f = store.m_linearForces[idx];
+      const Quaternion &q = store.m_orientations[idx];
+      const Vector3 &w = store.m_angularVelocities[idx];
+      const Vector3 &t = store.m_torques[idx];
+      const Matrix3 &ii = store.m_inverseInertias[idx];
+
+      lanes.position[0][lane] = p.x;
+      lanes.position[1][lane] = p.y;
+      lanes.position[2][lane] = p.z;
+      lanes.linearVelocity[0][lane] = v.x;
+      lanes.linearVelocity[1][lane] = v.y;
+      lanes.linearVelocity[2][lane] = v.z;
+      lanes.linearForce[0][lane] = f.x;
+      lanes.linearForce[1][lane] = f.y;
+      lanes.linearForce[2][lane] = f.z;
+      lanes.inverseMass[lane] = store.m_inverseMasses[idx];
+      lanes.orientation[0][lane] = q.x;
+      lanes.orientation[1][lane] = q.y;
+      lanes.orientation[2][lane] = q.z;
+      lanes.orientation[3][lane] = q.w;
+      lanes.angularVelocity[0][lane] = w.x;
+      lanes.angularVelocity[1][lane] = w.y;
+      lanes.angularVelocity[2][lane] = w.z;
+      lanes.torque[0][lane] = t.x;
+      lanes.torque[1][lane] = t.y;
+      lanes.torque[2][lane] = t.z;
+      for (size_t i = 0; i < 9; ++i)
+        lanes.inverseInertia[i][lane] = ii.mat_array[i];
+      lanes.damping[lane] = store.m_bodies[idx]->GetDampingCoefficient();
+    }
+
+    // Full groups use SIMD lanes, any remainder uses the scalar fallback
+    if (count == width && width > 1)
+    {
+#if defined(BATCHINTEGRATOR_AVX)
+      IntegrateLanes<AvxLanes, Type>(lanes, 0, dt);
+#elif defined(BATCHINTEGRATOR_SSE)
+      IntegrateLanes<SseLanes, Type>(lanes, 0, dt);
+#endif
+    }
+    else
+    {
+      for (size_t lane = 0; lane < count; ++lane)
+        IntegrateLanes<ScalarLanes, Type>(lanes, lane, dt);
+    }
+
+    // Write back updated state
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+      size_t idx = indices[start + lane];
+
+      store.m_positions[idx] = Vector3(lanes.position[0][lane], lanes.position[1][lane], lanes.position[2][lane]);
+      store.m_linearVelocities[idx] =
+          Vector3(lanes.linearVelocity[0][lane], lanes.linearVelocity[1][lane], lanes.linearVelocity[2][lane]);
+      store.m_angularVelocities[idx] =
+          Vector3(lanes.angularVelocity[0][lane], lanes.angularVelocity[1][lane], lanes.angularVelocity[2][lane]);
+      store.m_orientations[idx] = Quaternion(lanes.orientation[0][lane], lanes.orientation[1][lane],
+                                             lanes.orientation[2][lane], lanes.orientation[3][lane]);
+    }
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "IntegrationHelpers.h"
+#include "PhysicsBodyStore.h"
+#include <vector>
+
+/**
+ * @class BatchIntegrator
+ * @author Dan Nixon
+ * @brief Integrates groups of bodies from a PhysicsBodyStore using SIMD lanes.
+ *
+ * Bodies are processed 8 at a time when compiled with AVX support and 4 at a time with SSE, any remaining bodies (or all
+ * bodies when SIMD is disabled) use a scalar path built from the same kernel.
+ *
+ * The kernel performs the same sequence of floating point operations as IntegrationHelpers::Integrate(), so with strict
+ * floating point semantics the results are identical. Where the compiler is allowed to contract operations (e.g. fused
+ * multiply-add under /fp:fast) results may differ by up to TOLERANCE relative error per component per step.
+ */
+class BatchIntegrator
+{
+public:
+  /**
+   * @brief Maximum relative difference per state component per step compared with the scalar integrator.
+   */
+  static const float TOLERANCE;
+
+  static size_t SimdWidth();
+
+public:
+  BatchIntegrator();
+  virtual ~BatchIntegrator();
+
+  /**
+   * @brief Checks if SIMD lanes are used.
+   * @return True if SIMD is enabled
+   */
+  inline bool IsSimdEnabled() const
+  {
+    return m_simdEnabled;
+  }
+
+  /**
+   * @brief Sets if SIMD lanes are used (when disabled all bodies use the scalar fallback).
+   * @param enabled True to enable SIMD
+   */
+  inline void SetSimdEnabled(bool enabled)
+  {
+    m_simdEnabled = enabled;
+  }
+
+  void Integrate(PhysicsBodyStore &store, const std::vector<size_t> &indices, IntegrationType type, float dt);
+
+protected:
+  template <IntegrationType Type> void Integrate(PhysicsBodyStore &store, const std::vector<size_t> &indices, float dt);
+
+protected:
+  bool m_simdEnabled; //!< Flag indicating if SIMD lanes are used
+};
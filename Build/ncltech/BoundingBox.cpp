@@ -3,6 +3,10 @@
 #include "NCLDebug.h"
 
 #include <algorithm>
+#include <cfloat>
+
+using std::min;
+using std::max;
 
 /**
  * @brief Creates a new bounding box with minimum dimensions.
@@ -143,8 +147,7 @@ bool BoundingBox::Intersects(const Vector3 &point) const
  */
 bool BoundingBox::Intersects(const BoundingBox &otherBox) const
 {
-  return (m_lower <= otherBox.m_lower && otherBox.m_lower <= m_upper) ||
-         ((m_lower <= otherBox.m_upper && otherBox.m_upper <= m_upper));
+  return m_lower <= otherBox.m_upper && otherBox.m_lower <= m_upper;
 }
 
 /**
@@ -1,6 +1,12 @@
 #include "CollisionDetectionSAT.h"
 #include "NCLDebug.h"
 
+#include <algorithm>
+#include <cfloat>
+
+using std::min;
+using std::max;
+
 CollisionDetectionSAT::CollisionDetectionSAT()
 {
 }
@@ -1,12 +1,19 @@
 #include "CommonUtils.h"
 
-#include "CommonMeshes.h"
 #include "CuboidCollisionShape.h"
+#include "PhysicsEngine.h"
+#include "SphereCollisionShape.h"
 #include "SpringConstraint.h"
+#include <algorithm>
+
+#ifndef NCLTECH_HEADLESS
+#include "CommonMeshes.h"
 #include "ObjectMesh.h"
 #include "ObjectMeshDragable.h"
-#include "PhysicsEngine.h"
-#include "SphereCollisionShape.h"
+#endif
+
+using std::min;
+using std::max;
 
 /**
  * @brief Generates a unique colour based on scalar parameter in the range of 0-1.
@@ -19,9 +26,9 @@ Vector4 CommonUtils::GenColour(float scalar, float alpha)
   c.w = alpha;
 
   float t;
-  c.x = abs(modf(scalar + 1.0f, &t) * 6.0f - 3.0f) - 1.0f;
-  c.y = abs(modf(scalar + 2.0f / 3.0f, &t) * 6.0f - 3.0f) - 1.0f;
-  c.z = abs(modf(scalar + 1.0f / 3.0f, &t) * 6.0f - 3.0f) - 1.0f;
+  c.x = abs(modff(scalar + 1.0f, &t) * 6.0f - 3.0f) - 1.0f;
+  c.y = abs(modff(scalar + 2.0f / 3.0f, &t) * 6.0f - 3.0f) - 1.0f;
+  c.z = abs(modff(scalar + 1.0f / 3.0f, &t) * 6.0f - 3.0f) - 1.0f;
 
   c.x = min(max(c.x, 0.0f), 1.0f);
   c.y = min(max(c.y, 0.0f), 1.0f);
@@ -36,10 +43,15 @@ Vector4 CommonUtils::GenColour(float scalar, float alpha)
 Object *CommonUtils::BuildSphereObject(const std::string &name, const Vector3 &pos, float radius, bool physics_enabled,
                                        float inverse_mass, bool collidable, bool dragable, const Vector4 &color)
 {
+#ifdef NCLTECH_HEADLESS
+  // No renderer, so only the physical representation is built
+  Object *pSphere = new Object(name);
+#else
   ObjectMesh *pSphere = dragable ? new ObjectMeshDragable(name) : new ObjectMesh(name);
 
   pSphere->SetMesh(CommonMeshes::Sphere(), false);
   pSphere->SetTexture(CommonMeshes::CheckerboardTex(), false);
+#endif
   pSphere->SetLocalTransform(Matrix4::Scale(Vector3(radius, radius, radius)));
   pSphere->SetColour(color);
   pSphere->SetBoundingRadius(radius);
@@ -82,10 +94,15 @@ Object *CommonUtils::BuildSphereObject(const std::string &name, const Vector3 &p
 Object *CommonUtils::BuildCuboidObject(const std::string &name, const Vector3 &pos, const Vector3 &halfdims, bool physics_enabled,
                                        float inverse_mass, bool collidable, bool dragable, const Vector4 &color)
 {
+#ifdef NCLTECH_HEADLESS
+  // No renderer, so only the physical representation is built
+  Object *pCuboid = new Object(name);
+#else
   ObjectMesh *pCuboid = dragable ? new ObjectMeshDragable(name) : new ObjectMesh(name);
 
   pCuboid->SetMesh(CommonMeshes::Cube(), false);
   pCuboid->SetTexture(CommonMeshes::CheckerboardTex(), false);
+#endif
   pCuboid->SetLocalTransform(Matrix4::Scale(halfdims));
   pCuboid->SetColour(color);
   pCuboid->SetBoundingRadius(halfdims.Length());
@@ -139,6 +156,9 @@ Object *CommonUtils::BuildSoftBodyDemo(Vector3 position, size_t xNodeCount, size
   Object *softBody = new Object("soft_body");
   softBody->CreatePhysicsNode();
 
+  // Constraints join the same world as the nodes
+  PhysicsEngine *world = softBody->Physics()->GetWorld();
+
   float poleLength = (xNodeCount * xNodeSpacing) * 0.5f;
 
   Object *pole = CommonUtils::BuildCuboidObject("soft_body_pole", position + Vector3(poleLength - 1.0f, 20.0f, 0.0f),
@@ -170,14 +190,14 @@ Object *CommonUtils::BuildSoftBodyDemo(Vector3 position, size_t xNodeCount, size
       if (i > 0)
       {
         Object *o = softBodyNodes[softBodyNodes.size() - xNodeCount - 1];
-        PhysicsEngine::Instance()->AddConstraint(
+        world->AddConstraint(
             new SpringConstraint(node->Physics(), o->Physics(), node->Physics()->GetPosition(), o->Physics()->GetPosition(), k, d));
 
         // Add constraint to left above node
         if (j > 0)
         {
           Object *o = softBodyNodes[softBodyNodes.size() - xNodeCount - 2];
-          PhysicsEngine::Instance()->AddConstraint(
+          world->AddConstraint(
               new SpringConstraint(node->Physics(), o->Physics(), node->Physics()->GetPosition(), o->Physics()->GetPosition(), k, d));
         }
       }
@@ -186,7 +206,7 @@ Object *CommonUtils::BuildSoftBodyDemo(Vector3 position, size_t xNodeCount, size
       {
         Vector3 pos = pole->Physics()->GetPosition();
         pos.x = x;
-        PhysicsEngine::Instance()->AddConstraint(
+        world->AddConstraint(
             new SpringConstraint(node->Physics(), pole->Physics(), node->Physics()->GetPosition(), pos, k, d));
       }
 
@@ -194,7 +214,7 @@ Object *CommonUtils::BuildSoftBodyDemo(Vector3 position, size_t xNodeCount, size
       if (j > 0)
       {
         Object *o = softBodyNodes[softBodyNodes.size() - 2];
-        PhysicsEngine::Instance()->AddConstraint(
+        world->AddConstraint(
             new SpringConstraint(node->Physics(), o->Physics(), node->Physics()->GetPosition(), o->Physics()->GetPosition(), k, d));
       }
     }
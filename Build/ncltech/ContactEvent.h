@@ -0,0 +1,45 @@
+#pragma once
+
+#include "PhysicsObjectRegistry.h"
+#include <nclgl\Vector3.h>
+
+/**
+ * @brief Stage of contact between two objects reported by a ContactEvent.
+ */
+enum ContactEventType
+{
+  CONTACT_EVENT_BEGIN,   //!< Objects started touching in this step
+  CONTACT_EVENT_PERSIST, //!< Objects were touching in the previous step and still are
+  CONTACT_EVENT_END      //!< Objects were touching in the previous step and no longer are
+};
+
+/**
+ * @brief Change in contact between a pair of objects over a physics step.
+ *
+ * Contact data is summarised over all colliding shape pairs of the two objects by the deepest contact. End events carry
+ * the contact data of the last step in which the objects were touching. Overlaps with trigger volumes have no contact
+ * data (point, normal and penetration are zero).
+ */
+struct ContactEvent
+{
+  ContactEventType type;       //!< Stage of contact
+  PhysicsObjectHandle objectA; //!< Handle of the first object
+  PhysicsObjectHandle objectB; //!< Handle of the second object
+  Vector3 point;               //!< World space point of deepest contact
+  Vector3 normal;              //!< Contact normal, from the first object to the second
+  float penetration;           //!< Penetration of the deepest contact (negative overlap distance)
+  bool trigger;                //!< Flag indicating one of the objects is a trigger volume
+
+  /**
+   * @brief Gets the same event as seen from the second object.
+   * @return Event with the objects swapped
+   */
+  inline ContactEvent Mirrored() const
+  {
+    ContactEvent e = *this;
+    e.objectA = objectB;
+    e.objectB = objectA;
+    e.normal = -normal;
+    return e;
+  }
+};
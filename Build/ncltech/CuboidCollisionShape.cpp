@@ -1,7 +1,11 @@
 #include "CuboidCollisionShape.h"
 #include "PhysicsObject.h"
+#include <cfloat>
 #include <nclgl/Matrix3.h>
+
+#ifndef NCLTECH_HEADLESS
 #include <nclgl/OGLRenderer.h>
+#endif
 
 /**
  * @brief Creates a new cuboid collision shape.
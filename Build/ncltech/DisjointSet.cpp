@@ -0,0 +1,78 @@
+#include "DisjointSet.h"
+
+/**
+ * @brief Creates a new set in which each element is in its own subset.
+ * @param size Number of elements
+ */
+DisjointSet::DisjointSet(size_t size)
+{
+  Reset(size);
+}
+
+DisjointSet::~DisjointSet()
+{
+}
+
+/**
+ * @brief Resizes the set and places each element in its own subset.
+ * @param size Number of elements
+ */
+void DisjointSet::Reset(size_t size)
+{
+  m_parents.resize(size);
+  m_ranks.assign(size, 0);
+
+  for (size_t i = 0; i < size; ++i)
+    m_parents[i] = i;
+}
+
+/**
+ * @brief Finds the representative element of the subset containing an element.
+ * @param element Element to find
+ * @return Root element of subset
+ */
+size_t DisjointSet::Find(size_t element)
+{
+  size_t root = element;
+  while (m_parents[root] != root)
+    root = m_parents[root];
+
+  // Compress the path so subsequent finds are direct
+  while (m_parents[element] != root)
+  {
+    size_t next = m_parents[element];
+    m_parents[element] = root;
+    element = next;
+  }
+
+  return root;
+}
+
+/**
+ * @brief Merges the subsets containing two elements.
+ * @param a First element
+ * @param b Second element
+ * @return True if the elements were in different subsets
+ */
+bool DisjointSet::Union(size_t a, size_t b)
+{
+  size_t rootA = Find(a);
+  size_t rootB = Find(b);
+
+  if (rootA == rootB)
+    return false;
+
+  if (m_ranks[rootA] < m_ranks[rootB])
+  {
+    m_parents[rootA] = rootB;
+  }
+  else
+  {
+    m_parents[rootB] = rootA;
+
+    if (m_ranks[rootA] == m_ranks[rootB])
+      m_ranks[rootA]++;
+  }
+
+  return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class DisjointSet
+ * @author Dan Nixon
+ * @brief Union-find structure over a range of integer elements.
+ *
+ * Uses union by rank and path compression, so both Find() and Union() run in near constant amortised time.
+ */
+class DisjointSet
+{
+public:
+  DisjointSet(size_t size = 0);
+  virtual ~DisjointSet();
+
+  void Reset(size_t size);
+
+  size_t Find(size_t element);
+  bool Union(size_t a, size_t b);
+
+  /**
+   * @brief Gets the number of elements in the set.
+   * @return Number of elements
+   */
+  inline size_t Size() const
+  {
+    return m_parents.size();
+  }
+
+protected:
+  std::vector<size_t> m_parents; //!< Parent of each element (roots are their own parent)
+  std::vector<size_t> m_ranks;   //!< Upper bound on height of the tree under each root
+};
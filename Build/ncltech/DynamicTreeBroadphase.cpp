@@ -0,0 +1,595 @@
+#include "DynamicTreeBroadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+using std::min;
+using std::max;
+
+namespace
+{
+/**
+ * @brief Gets the smallest box containing two boxes.
+ * @param a First box
+ * @param b Second box
+ * @return Union of boxes
+ */
+inline BoundingBox Union(const BoundingBox &a, const BoundingBox &b)
+{
+  BoundingBox box(a);
+  box.ExpandToFit(b);
+  return box;
+}
+
+/**
+ * @brief Gets the surface area of a box, used as the cost of a node when choosing where to insert leaves.
+ * @param box Box
+ * @return Surface area
+ */
+inline float SurfaceArea(const BoundingBox &box)
+{
+  Vector3 d = box.Upper() - box.Lower();
+  return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+/**
+ * @brief Checks if a box is entirely inside another box.
+ * @param outer Containing box
+ * @param inner Contained box
+ * @return True if inner is inside outer
+ */
+inline bool Contains(const BoundingBox &outer, const BoundingBox &inner)
+{
+  return outer.Lower() <= inner.Lower() && inner.Upper() <= outer.Upper();
+}
+
+/**
+ * @brief Checks if a ray segment passes through a box (slab test).
+ * @param origin Ray origin
+ * @param direction Unit ray direction
+ * @param maxDistance Length of the segment
+ * @param box Box
+ * @return True if the segment intersects the box
+ */
+inline bool RayIntersects(const Vector3 &origin, const Vector3 &direction, float maxDistance, const BoundingBox &box)
+{
+  float tMin = 0.0f;
+  float tMax = maxDistance;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (fabs(direction[i]) < 1e-9f)
+    {
+      // Parallel to slab, must start inside it
+      if (origin[i] < box.Lower()[i] || origin[i] > box.Upper()[i])
+        return false;
+    }
+    else
+    {
+      float invD = 1.0f / direction[i];
+      float t1 = (box.Lower()[i] - origin[i]) * invD;
+      float t2 = (box.Upper()[i] - origin[i]) * invD;
+
+      tMin = max(tMin, min(t1, t2));
+      tMax = min(tMax, max(t1, t2));
+
+      if (tMin > tMax)
+        return false;
+    }
+  }
+
+  return true;
+}
+}
+
+/**
+ * @brief Creates a new dynamic tree broadphase instance.
+ * @param margin Distance object AABBs are fattened by in each direction
+ *
+ * Larger margins mean objects are reinserted less often but more pairs are considered when traversing the tree.
+ */
+DynamicTreeBroadphase::DynamicTreeBroadphase(float margin)
+    : IBroadphase()
+    , m_margin(margin)
+    , m_root(NULL_NODE)
+    , m_freeList(NULL_NODE)
+    , m_step(0)
+    , m_numReinsertions(0)
+{
+}
+
+DynamicTreeBroadphase::~DynamicTreeBroadphase()
+{
+}
+
+/**
+ * @brief Removes all objects from the tree.
+ */
+void DynamicTreeBroadphase::Clear()
+{
+  m_nodes.clear();
+  m_leaves.clear();
+  m_root = NULL_NODE;
+  m_freeList = NULL_NODE;
+}
+
+/**
+ * @copydoc IBroadphase::FindPotentialCollisionPairs
+ *
+ * Each object that is awake or was reinserted in this update reports every object whose AABB overlaps its own, except
+ * pairs where both objects are at rest. Pairs are output sorted by the indices of their objects in the object list, with
+ * the lower index as object A, so the output depends only on the objects and not on the shape of the tree.
+ */
+void DynamicTreeBroadphase::FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects,
+                                                        std::vector<CollisionPair> &collisionPairs)
+{
+  UpdateTree(objects);
+
+  m_pairs.clear();
+  for (int leaf : m_moved)
+  {
+    QueryPairs(leaf);
+    m_nodes[leaf].queryStep = m_step;
+  }
+
+  AppendSortedPairs(objects, m_pairs, collisionPairs);
+}
+
+/**
+ * @copydoc IBroadphase::FindObjectsInBox
+ */
+void DynamicTreeBroadphase::FindObjectsInBox(std::vector<PhysicsObject *> &objects, const BoundingBox &box,
+                                             std::vector<PhysicsObject *> &results)
+{
+  UpdateTree(objects);
+
+  if (m_root == NULL_NODE)
+    return;
+
+  m_stack.clear();
+  m_stack.push_back(m_root);
+
+  while (!m_stack.empty())
+  {
+    const Node &node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+
+    if (!node.box.Intersects(box))
+      continue;
+
+    if (node.IsLeaf())
+    {
+      if (node.object->GetWorldSpaceAABB().Intersects(box))
+        results.push_back(node.object);
+    }
+    else
+    {
+      m_stack.push_back(node.children[0]);
+      m_stack.push_back(node.children[1]);
+    }
+  }
+}
+
+/**
+ * @brief Finds all objects that have a world space AABB intersected by a ray.
+ * @param objects All objects in scene
+ * @param origin Ray origin
+ * @param direction Ray direction
+ * @param maxDistance Maximum distance along the ray to search
+ * @param results Objects found are appended to this list (in no particular order)
+ */
+void DynamicTreeBroadphase::FindObjectsOnRay(std::vector<PhysicsObject *> &objects, const Vector3 &origin,
+                                             const Vector3 &direction, float maxDistance,
+                                             std::vector<PhysicsObject *> &results)
+{
+  UpdateTree(objects);
+
+  if (m_root == NULL_NODE)
+    return;
+
+  Vector3 dir = direction;
+  dir.Normalise();
+
+  m_stack.clear();
+  m_stack.push_back(m_root);
+
+  while (!m_stack.empty())
+  {
+    const Node &node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+
+    if (!RayIntersects(origin, dir, maxDistance, node.box))
+      continue;
+
+    if (node.IsLeaf())
+    {
+      if (RayIntersects(origin, dir, maxDistance, node.object->GetWorldSpaceAABB()))
+        results.push_back(node.object);
+    }
+    else
+    {
+      m_stack.push_back(node.children[0]);
+      m_stack.push_back(node.children[1]);
+    }
+  }
+}
+
+/**
+ * @copydoc IBroadphase::DebugDraw
+ */
+void DynamicTreeBroadphase::DebugDraw()
+{
+  if (m_root == NULL_NODE)
+    return;
+
+  m_stack.clear();
+  m_stack.push_back(m_root);
+
+  while (!m_stack.empty())
+  {
+    const Node &node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+
+    if (node.IsLeaf())
+    {
+      node.box.DebugDraw(Matrix4(), Vector4(0.8f, 1.0f, 0.8f, 0.1f), Vector4(0.0f, 1.0f, 0.0f, 1.0f), 0.02f);
+    }
+    else
+    {
+      node.box.DebugDraw(Matrix4(), Vector4(1.0f, 0.8f, 0.8f, 0.05f), Vector4(1.0f, 1.0f, 0.0f, 1.0f), 0.05f);
+      m_stack.push_back(node.children[0]);
+      m_stack.push_back(node.children[1]);
+    }
+  }
+}
+
+/**
+ * @brief Synchronises the tree with the object list.
+ * @param objects All objects in scene
+ *
+ * New objects are inserted, objects no longer in the list are removed and objects whose AABB has left their fattened box
+ * are reinserted. Leaves that need to query for pairs in this update are collected in m_moved.
+ */
+void DynamicTreeBroadphase::UpdateTree(std::vector<PhysicsObject *> &objects)
+{
+  m_step++;
+  m_numReinsertions = 0;
+  m_moved.clear();
+
+  const Vector3 margin(m_margin, m_margin, m_margin);
+
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    PhysicsObject *obj = objects[i];
+    const BoundingBox aabb = obj->GetWorldSpaceAABB();
+    int leaf;
+
+    auto it = m_leaves.find(obj);
+    if (it == m_leaves.end())
+    {
+      leaf = AllocateNode();
+      m_nodes[leaf].object = obj;
+      m_nodes[leaf].box = BoundingBox(aabb.Lower() - margin, aabb.Upper() + margin);
+      m_nodes[leaf].height = 0;
+      InsertLeaf(leaf);
+
+      m_leaves[obj] = leaf;
+      m_moved.push_back(leaf);
+    }
+    else
+    {
+      leaf = it->second;
+
+      if (!Contains(m_nodes[leaf].box, aabb))
+      {
+        RemoveLeaf(leaf);
+        m_nodes[leaf].box = BoundingBox(aabb.Lower() - margin, aabb.Upper() + margin);
+        InsertLeaf(leaf);
+
+        m_numReinsertions++;
+        m_moved.push_back(leaf);
+      }
+      else if (!obj->IsAtRest())
+      {
+        m_moved.push_back(leaf);
+      }
+    }
+
+    m_nodes[leaf].seenStep = m_step;
+    m_nodes[leaf].objectIndex = (uint32_t)i;
+  }
+
+  // Remove objects that are no longer in the scene (only possible if there are more leaves than objects)
+  if (m_leaves.size() > objects.size())
+  {
+    for (auto it = m_leaves.begin(); it != m_leaves.end();)
+    {
+      if (m_nodes[it->second].seenStep != m_step)
+      {
+        RemoveLeaf(it->second);
+        FreeNode(it->second);
+        it = m_leaves.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Takes a node from the free list, growing the pool if it is empty.
+ * @return Index of the new node
+ */
+int DynamicTreeBroadphase::AllocateNode()
+{
+  int node = m_freeList;
+
+  if (node == NULL_NODE)
+  {
+    node = (int)m_nodes.size();
+    m_nodes.push_back(Node());
+  }
+  else
+  {
+    m_freeList = m_nodes[node].parent;
+  }
+
+  Node &n = m_nodes[node];
+  n.object = nullptr;
+  n.objectIndex = 0;
+  n.parent = NULL_NODE;
+  n.children[0] = NULL_NODE;
+  n.children[1] = NULL_NODE;
+  n.height = 0;
+  n.seenStep = 0;
+  n.queryStep = 0;
+
+  return node;
+}
+
+/**
+ * @brief Returns a node to the free list.
+ * @param node Index of the node
+ */
+void DynamicTreeBroadphase::FreeNode(int node)
+{
+  m_nodes[node].object = nullptr;
+  m_nodes[node].height = -1;
+  m_nodes[node].parent = m_freeList;
+  m_freeList = node;
+}
+
+/**
+ * @brief Inserts a leaf into the tree next to the sibling that gives the smallest increase in total surface area.
+ * @param leaf Index of the leaf node
+ */
+void DynamicTreeBroadphase::InsertLeaf(int leaf)
+{
+  if (m_root == NULL_NODE)
+  {
+    m_root = leaf;
+    m_nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  const BoundingBox leafBox = m_nodes[leaf].box;
+
+  // Descend to the best sibling
+  int index = m_root;
+  while (!m_nodes[index].IsLeaf())
+  {
+    const Node &node = m_nodes[index];
+
+    const float area = SurfaceArea(node.box);
+    const float combinedArea = SurfaceArea(Union(node.box, leafBox));
+
+    // Cost of creating a new parent for this node and the leaf
+    const float cost = 2.0f * combinedArea;
+
+    // Minimum cost of pushing the leaf further down the tree
+    const float inheritanceCost = 2.0f * (combinedArea - area);
+
+    float childCost[2];
+    for (int i = 0; i < 2; ++i)
+    {
+      const Node &child = m_nodes[node.children[i]];
+      childCost[i] = SurfaceArea(Union(child.box, leafBox)) + inheritanceCost;
+      if (!child.IsLeaf())
+        childCost[i] -= SurfaceArea(child.box);
+    }
+
+    if (cost < childCost[0] && cost < childCost[1])
+      break;
+
+    index = (childCost[0] < childCost[1]) ? node.children[0] : node.children[1];
+  }
+
+  const int sibling = index;
+
+  // Create a new parent for the sibling and leaf
+  const int oldParent = m_nodes[sibling].parent;
+  const int newParent = AllocateNode();
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].box = Union(leafBox, m_nodes[sibling].box);
+  m_nodes[newParent].height = m_nodes[sibling].height + 1;
+  m_nodes[newParent].children[0] = sibling;
+  m_nodes[newParent].children[1] = leaf;
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  if (oldParent == NULL_NODE)
+  {
+    m_root = newParent;
+  }
+  else
+  {
+    int slot = (m_nodes[oldParent].children[0] == sibling) ? 0 : 1;
+    m_nodes[oldParent].children[slot] = newParent;
+  }
+
+  RefitAncestors(m_nodes[leaf].parent);
+}
+
+/**
+ * @brief Removes a leaf from the tree, its parent is replaced by its sibling.
+ * @param leaf Index of the leaf node
+ *
+ * The leaf node itself is not freed.
+ */
+void DynamicTreeBroadphase::RemoveLeaf(int leaf)
+{
+  if (leaf == m_root)
+  {
+    m_root = NULL_NODE;
+    return;
+  }
+
+  const int parent = m_nodes[leaf].parent;
+  const int grandParent = m_nodes[parent].parent;
+  const int sibling = (m_nodes[parent].children[0] == leaf) ? m_nodes[parent].children[1] : m_nodes[parent].children[0];
+
+  m_nodes[sibling].parent = grandParent;
+  FreeNode(parent);
+
+  if (grandParent == NULL_NODE)
+  {
+    m_root = sibling;
+  }
+  else
+  {
+    int slot = (m_nodes[grandParent].children[0] == parent) ? 0 : 1;
+    m_nodes[grandParent].children[slot] = sibling;
+    RefitAncestors(grandParent);
+  }
+}
+
+/**
+ * @brief Balances and updates the box and height of each node from a given node to the root.
+ * @param node Index of the first node
+ */
+void DynamicTreeBroadphase::RefitAncestors(int node)
+{
+  while (node != NULL_NODE)
+  {
+    node = Balance(node);
+
+    Node &n = m_nodes[node];
+    const Node &c0 = m_nodes[n.children[0]];
+    const Node &c1 = m_nodes[n.children[1]];
+
+    n.height = 1 + max(c0.height, c1.height);
+    n.box = Union(c0.box, c1.box);
+
+    node = n.parent;
+  }
+}
+
+/**
+ * @brief Performs a left or right rotation if a node is imbalanced.
+ * @param a Index of the node
+ * @return Index of the node now in the position of the original node
+ *
+ * The taller child (C) of A is promoted into the position of A, A takes the place of the shorter child of C.
+ */
+int DynamicTreeBroadphase::Balance(int a)
+{
+  Node &nodeA = m_nodes[a];
+  if (nodeA.IsLeaf() || nodeA.height < 2)
+    return a;
+
+  const int b = nodeA.children[0];
+  const int c = nodeA.children[1];
+  const int balance = m_nodes[c].height - m_nodes[b].height;
+
+  if (balance > 1 || balance < -1)
+  {
+    // Taller child is promoted, shorter child stays with A
+    const int up = (balance > 1) ? c : b;
+    const int stay = (balance > 1) ? b : c;
+    const int upSlot = (balance > 1) ? 1 : 0;
+
+    Node &nodeUp = m_nodes[up];
+    const int f = nodeUp.children[0];
+    const int g = nodeUp.children[1];
+
+    // Swap A and the promoted node
+    nodeUp.children[0] = a;
+    nodeUp.parent = nodeA.parent;
+    nodeA.parent = up;
+
+    if (nodeUp.parent == NULL_NODE)
+    {
+      m_root = up;
+    }
+    else
+    {
+      Node &oldParent = m_nodes[nodeUp.parent];
+      int slot = (oldParent.children[0] == a) ? 0 : 1;
+      oldParent.children[slot] = up;
+    }
+
+    // The taller grandchild stays with the promoted node, the shorter one moves to A
+    const int tall = (m_nodes[f].height > m_nodes[g].height) ? f : g;
+    const int shorter = (tall == f) ? g : f;
+
+    nodeUp.children[1] = tall;
+    nodeA.children[upSlot] = shorter;
+    m_nodes[shorter].parent = a;
+
+    nodeA.box = Union(m_nodes[stay].box, m_nodes[shorter].box);
+    nodeA.height = 1 + max(m_nodes[stay].height, m_nodes[shorter].height);
+
+    nodeUp.box = Union(nodeA.box, m_nodes[tall].box);
+    nodeUp.height = 1 + max(nodeA.height, m_nodes[tall].height);
+
+    return up;
+  }
+
+  return a;
+}
+
+/**
+ * @brief Reports every object overlapping the object of a leaf, skipping objects that have already queried this update.
+ * @param leaf Index of the leaf node
+ *
+ * Pairs found are appended to m_pairs.
+ */
+void DynamicTreeBroadphase::QueryPairs(int leaf)
+{
+  PhysicsObject *obj = m_nodes[leaf].object;
+  const BoundingBox aabb = obj->GetWorldSpaceAABB();
+
+  m_stack.clear();
+  m_stack.push_back(m_root);
+
+  while (!m_stack.empty())
+  {
+    const int index = m_stack.back();
+    m_stack.pop_back();
+
+    const Node &node = m_nodes[index];
+    if (!node.box.Intersects(aabb))
+      continue;
+
+    if (node.IsLeaf())
+    {
+      // Pairs with objects that have already queried were reported by that object
+      if (index == leaf || node.queryStep == m_step)
+        continue;
+
+      // Skip pairs of two at rest objects, which would otherwise only be found after one of them was (re)inserted
+      if (obj->IsAtRest() && node.object->IsAtRest())
+        continue;
+
+      if (node.object->GetWorldSpaceAABB().Intersects(aabb))
+        m_pairs.push_back(PairKey(m_nodes[leaf].objectIndex, node.objectIndex));
+    }
+    else
+    {
+      m_stack.push_back(node.children[0]);
+      m_stack.push_back(node.children[1]);
+    }
+  }
+}
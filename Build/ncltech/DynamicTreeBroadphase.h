@@ -0,0 +1,141 @@
+#pragma once
+
+#include "IBroadphase.h"
+
+#include "BoundingBox.h"
+
+#include <unordered_map>
+
+/**
+ * @class DynamicTreeBroadphase
+ * @author Dan Nixon
+ * @brief Broadphase culling using a dynamic bounding volume tree of fattened object AABBs.
+ *
+ * The tree persists between steps. An object is only reinserted when its AABB leaves the fattened box stored in its leaf,
+ * and only objects that are awake (or have just been reinserted) query the tree for pairs, so in mostly static scenes the
+ * cost follows the number of moving objects rather than the total object count. Tree rotations after each insertion and
+ * removal keep the tree height balanced.
+ *
+ * Pairs are reported in the order of the object list (as with BruteForceBroadphase) rather than in tree traversal order,
+ * so the order in which the solver visits contacts does not depend on the shape of the tree.
+ */
+class DynamicTreeBroadphase : public IBroadphase
+{
+public:
+  /**
+   * @brief Value of a node index that does not refer to any node.
+   */
+  static const int NULL_NODE = -1;
+
+  /**
+   * @brief A node in the tree, either a leaf holding a single object or an internal node with exactly two children.
+   */
+  struct Node
+  {
+    BoundingBox box;       //!< Fattened box of the object (leaf) or union of children boxes (internal node)
+    PhysicsObject *object; //!< Object held by a leaf, nullptr for internal nodes
+    uint32_t objectIndex;  //!< Index of the object of a leaf in the object list of the last step
+    int parent;            //!< Index of the parent node (or next free node when in the free list)
+    int children[2];       //!< Indices of the child nodes (NULL_NODE for leaves)
+    int height;            //!< Height of the subtree (0 for leaves, -1 for free nodes)
+    size_t seenStep;       //!< Last step the object of a leaf was present in the object list
+    size_t queryStep;      //!< Last step the object of a leaf was queried for pairs
+
+    /**
+     * @brief Checks if this node is a leaf.
+     * @return True if the node is a leaf
+     */
+    inline bool IsLeaf() const
+    {
+      return children[0] == NULL_NODE;
+    }
+  };
+
+public:
+  DynamicTreeBroadphase(float margin = 0.1f);
+  virtual ~DynamicTreeBroadphase();
+
+  /**
+   * @brief Gets the distance object AABBs are fattened by in each direction.
+   * @return Margin
+   */
+  inline float Margin() const
+  {
+    return m_margin;
+  }
+
+  /**
+   * @brief Sets the distance object AABBs are fattened by in each direction.
+   * @param margin Margin
+   *
+   * Only applies to objects inserted after the change.
+   */
+  inline void SetMargin(float margin)
+  {
+    m_margin = margin;
+  }
+
+  /**
+   * @brief Gets the number of objects in the tree.
+   * @return Object count
+   */
+  inline size_t NumObjects() const
+  {
+    return m_leaves.size();
+  }
+
+  /**
+   * @brief Gets the number of object reinsertions performed in the last update.
+   * @return Reinsertion count
+   */
+  inline size_t NumReinsertions() const
+  {
+    return m_numReinsertions;
+  }
+
+  /**
+   * @brief Gets the height of the tree.
+   * @return Height (0 for a single leaf, -1 for an empty tree)
+   */
+  inline int Height() const
+  {
+    return (m_root == NULL_NODE) ? -1 : m_nodes[m_root].height;
+  }
+
+  virtual void Clear();
+
+  virtual void FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects, std::vector<CollisionPair> &collisionPairs);
+  virtual void FindObjectsInBox(std::vector<PhysicsObject *> &objects, const BoundingBox &box,
+                                std::vector<PhysicsObject *> &results);
+  void FindObjectsOnRay(std::vector<PhysicsObject *> &objects, const Vector3 &origin, const Vector3 &direction,
+                        float maxDistance, std::vector<PhysicsObject *> &results);
+  virtual void DebugDraw();
+
+protected:
+  void UpdateTree(std::vector<PhysicsObject *> &objects);
+
+  int AllocateNode();
+  void FreeNode(int node);
+
+  void InsertLeaf(int leaf);
+  void RemoveLeaf(int leaf);
+  int Balance(int node);
+  void RefitAncestors(int node);
+
+  void QueryPairs(int leaf);
+
+protected:
+  float m_margin; //!< Distance object AABBs are fattened by in each direction
+
+  std::vector<Node> m_nodes; //!< Node pool
+  int m_root;                //!< Index of the root node
+  int m_freeList;            //!< Index of the first free node in the pool
+
+  std::unordered_map<PhysicsObject *, int> m_leaves; //!< Leaf node of each object in the tree
+
+  size_t m_step;                  //!< Counter of tree updates, used to stamp nodes
+  size_t m_numReinsertions;       //!< Number of object reinsertions performed in the last update
+  std::vector<int> m_moved;       //!< Leaves of objects that query the tree for pairs in the current update
+  std::vector<int> m_stack;       //!< Traversal stack
+  std::vector<uint64_t> m_pairs;  //!< Object list indices of the pairs found in the current update (lower index first)
+};
@@ -0,0 +1,213 @@
+#include "GraphColouredSolver.h"
+
+/**
+ * @brief Creates a new solver.
+ */
+GraphColouredSolver::GraphColouredSolver()
+    : m_numColours(0)
+{
+}
+
+GraphColouredSolver::~GraphColouredSolver()
+{
+}
+
+/**
+ * @brief Partitions constraints into batches that share no non static objects.
+ * @param objects All objects in the simulation (object step indices must be valid)
+ * @param manifolds Contact constraints
+ * @param constraints Misc constraints
+ *
+ * Colouring is performed in constraint order, so batches are identical for identical inputs.
+ */
+void GraphColouredSolver::Colour(const std::vector<PhysicsObject *> &objects, std::vector<Manifold *> &manifolds,
+                                 std::vector<IConstraint *> &constraints)
+{
+  m_objectColours.assign(objects.size(), 0);
+
+  for (size_t i = 0; i < m_numColours; ++i)
+  {
+    m_batches[i].manifolds.clear();
+    m_batches[i].constraints.clear();
+  }
+  m_numColours = 0;
+
+  m_serialBatch.manifolds.clear();
+  m_serialBatch.constraints.clear();
+
+  for (Manifold *m : manifolds)
+  {
+    size_t colour = AssignColour(objects, m->NodeA(), m->NodeB());
+    if (colour < MAX_COLOURS)
+      m_batches[colour].manifolds.push_back(m);
+    else
+      m_serialBatch.manifolds.push_back(m);
+  }
+
+  for (IConstraint *c : constraints)
+  {
+    size_t colour = AssignColour(objects, c->NodeA(), c->NodeB());
+    if (colour < MAX_COLOURS)
+      m_batches[colour].constraints.push_back(c);
+    else
+      m_serialBatch.constraints.push_back(c);
+  }
+}
+
+/**
+ * @brief Solves all coloured constraints.
+ * @param dt Timestep
+ * @param minIterations Number of solver iterations always performed
+ * @param maxIterations Maximum number of solver iterations
+ * @param threshold Largest impulse magnitude in an iteration below which the solver is considered converged
+ * @return Number of solver iterations performed
+ */
+size_t GraphColouredSolver::Solve(float dt, size_t minIterations, size_t maxIterations, float threshold)
+{
+  // Pre-solver step may also modify velocities (i.e. warm starting) so is performed by batch
+  for (size_t i = 0; i < m_numColours; ++i)
+    SolveBatch(m_batches[i], true, dt);
+  SolveBatch(m_serialBatch, true, dt);
+
+  size_t n = 0;
+  while (n < maxIterations)
+  {
+    float maxImpulse = 0.0f;
+    for (size_t i = 0; i < m_numColours; ++i)
+    {
+      float impulse = SolveBatch(m_batches[i], false, dt);
+      if (impulse > maxImpulse)
+        maxImpulse = impulse;
+    }
+
+    float impulse = SolveBatch(m_serialBatch, false, dt);
+    if (impulse > maxImpulse)
+      maxImpulse = impulse;
+
+    ++n;
+    if (n >= minIterations && maxImpulse < threshold)
+      break;
+  }
+
+  return n;
+}
+
+/**
+ * @brief Gets the index of an object in the simulation.
+ * @param objects All objects in the simulation
+ * @param obj Object to find
+ * @param index Reference to store index in
+ * @return True if the object is in the simulation
+ */
+bool GraphColouredSolver::ObjectIndex(const std::vector<PhysicsObject *> &objects, PhysicsObject *obj, size_t &index) const
+{
+  if (obj == nullptr || obj->m_stepIndex >= objects.size() || objects[obj->m_stepIndex] != obj)
+    return false;
+
+  index = obj->m_stepIndex;
+  return true;
+}
+
+/**
+ * @brief Finds the lowest colour not yet used by either of a pair of objects and marks it as used.
+ * @param objects All objects in the simulation
+ * @param a First object
+ * @param b Second object
+ * @return Colour, MAX_COLOURS if the constraint must be solved serially
+ */
+size_t GraphColouredSolver::AssignColour(const std::vector<PhysicsObject *> &objects, PhysicsObject *a, PhysicsObject *b)
+{
+  size_t idxA, idxB;
+  if (!ObjectIndex(objects, a, idxA) || !ObjectIndex(objects, b, idxB))
+    return MAX_COLOURS;
+
+  // Static objects are never written to by constraints, so may appear in any number of constraints in a batch
+  const bool staticA = a->IsStatic();
+  const bool staticB = b->IsStatic();
+
+  uint64_t used = 0;
+  if (!staticA)
+    used |= m_objectColours[idxA];
+  if (!staticB)
+    used |= m_objectColours[idxB];
+
+  size_t colour = 0;
+  while (colour < MAX_COLOURS && (used & ((uint64_t)1 << colour)))
+    colour++;
+
+  if (colour == MAX_COLOURS)
+    return MAX_COLOURS;
+
+  if (!staticA)
+    m_objectColours[idxA] |= (uint64_t)1 << colour;
+  if (!staticB)
+    m_objectColours[idxB] |= (uint64_t)1 << colour;
+
+  if (colour >= m_numColours)
+  {
+    m_numColours = colour + 1;
+    if (m_batches.size() < m_numColours)
+      m_batches.resize(m_numColours);
+  }
+
+  return colour;
+}
+
+/**
+ * @brief Performs either the pre-solver step or a single solver iteration on a batch.
+ * @param batch Batch to solve
+ * @param preSolve True to perform the pre-solver step, false to apply impulses
+ * @param dt Timestep
+ * @return Magnitude of the largest impulse applied (zero for the pre-solver step)
+ */
+float GraphColouredSolver::SolveBatch(ConstraintBatch &batch, bool preSolve, float dt)
+{
+  const int numManifolds = (int)batch.manifolds.size();
+  const int numItems = numManifolds + (int)batch.constraints.size();
+
+  // Only the serial batch can contain constraints between objects that are also constrained by other constraints in the
+  // same batch
+  const bool parallel = (&batch != &m_serialBatch);
+
+  float maxImpulse = 0.0f;
+
+#pragma omp parallel if (parallel)
+  {
+    // Each thread tracks its own largest impulse, these are combined once the batch is complete
+    float threadMaxImpulse = 0.0f;
+
+#pragma omp for schedule(static)
+    for (int i = 0; i < numItems; ++i)
+    {
+      float impulse = 0.0f;
+
+      if (i < numManifolds)
+      {
+        Manifold *m = batch.manifolds[i];
+        if (preSolve)
+          m->PreSolverStep(dt);
+        else
+          impulse = m->ApplyImpulse();
+      }
+      else
+      {
+        IConstraint *c = batch.constraints[i - numManifolds];
+        if (preSolve)
+          c->PreSolverStep(dt);
+        else
+          impulse = c->ApplyImpulse();
+      }
+
+      if (impulse > threadMaxImpulse)
+        threadMaxImpulse = impulse;
+    }
+
+#pragma omp critical
+    {
+      if (threadMaxImpulse > maxImpulse)
+        maxImpulse = threadMaxImpulse;
+    }
+  }
+
+  return maxImpulse;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "IConstraint.h"
+#include "Manifold.h"
+#include "PhysicsObject.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief Set of constraints that share no non static objects and can therefore be solved concurrently.
+ */
+struct ConstraintBatch
+{
+  std::vector<Manifold *> manifolds;      //!< Contact constraints in the batch
+  std::vector<IConstraint *> constraints; //!< Misc constraints in the batch
+};
+
+/**
+ * @class GraphColouredSolver
+ * @author Dan Nixon
+ * @brief Parallel Gauss-Seidel solver that colours the constraint graph so that each colour can be solved concurrently.
+ *
+ * Constraints are greedily assigned the lowest colour not already used by either of their (non static) objects. Each
+ * solver iteration then solves the colour batches in turn, distributing the constraints in a batch over OpenMP threads.
+ * Constraints that do not report their objects, or that would need more than MAX_COLOURS colours, are solved serially
+ * after the coloured batches.
+ */
+class GraphColouredSolver
+{
+public:
+  /**
+   * @brief Maximum number of colour batches.
+   */
+  static const size_t MAX_COLOURS = 64;
+
+public:
+  GraphColouredSolver();
+  virtual ~GraphColouredSolver();
+
+  void Colour(const std::vector<PhysicsObject *> &objects, std::vector<Manifold *> &manifolds,
+              std::vector<IConstraint *> &constraints);
+  size_t Solve(float dt, size_t minIterations, size_t maxIterations, float threshold);
+
+  /**
+   * @brief Gets the number of colour batches used in the last colouring.
+   * @return Number of colours
+   */
+  inline size_t NumColours() const
+  {
+    return m_numColours;
+  }
+
+  /**
+   * @brief Gets the number of constraints that could not be coloured in the last colouring.
+   * @return Number of serially solved constraints
+   */
+  inline size_t NumSerialConstraints() const
+  {
+    return m_serialBatch.manifolds.size() + m_serialBatch.constraints.size();
+  }
+
+protected:
+  bool ObjectIndex(const std::vector<PhysicsObject *> &objects, PhysicsObject *obj, size_t &index) const;
+  size_t AssignColour(const std::vector<PhysicsObject *> &objects, PhysicsObject *a, PhysicsObject *b);
+  float SolveBatch(ConstraintBatch &batch, bool preSolve, float dt);
+
+protected:
+  std::vector<ConstraintBatch> m_batches; //!< Colour batches (only the first m_numColours are valid)
+  size_t m_numColours;                    //!< Number of colours used in the current colouring
+  ConstraintBatch m_serialBatch;          //!< Constraints solved serially after the coloured batches
+  std::vector<uint64_t> m_objectColours;  //!< Bit mask of colours used by each object
+};
@@ -1,6 +1,8 @@
 #include "Hull.h"
 #include "BoundingBox.h"
 #include "NCLDebug.h"
+#include <algorithm>
+#include <cfloat>
 
 Hull::Hull()
 {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "PhysicsObject.h"
+#include <algorithm>
+#include <stdint.h>
 #include <vector>
 
 /**
@@ -20,6 +22,10 @@ struct CollisionPair
 class IBroadphase
 {
 public:
+  virtual ~IBroadphase()
+  {
+  }
+
   /**
    * @brief Obtains a list of potential collision pairs.
    * @param objects All objects in scene
@@ -27,8 +33,73 @@ public:
    */
   virtual void FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects, std::vector<CollisionPair> &collisionPairs) = 0;
 
+  /**
+   * @brief Finds all objects that have a world space AABB intersecting a given box.
+   * @param objects All objects in scene
+   * @param box World space box
+   * @param results Objects found are appended to this list
+   *
+   * Used to find the objects a fast moving object may have passed through in continuous collision detection. The default
+   * implementation tests every object.
+   */
+  virtual void FindObjectsInBox(std::vector<PhysicsObject *> &objects, const BoundingBox &box,
+                                std::vector<PhysicsObject *> &results)
+  {
+    for (PhysicsObject *obj : objects)
+    {
+      if (obj->GetWorldSpaceAABB().Intersects(box))
+        results.push_back(obj);
+    }
+  }
+
+  /**
+   * @brief Discards any state kept between updates.
+   *
+   * Called when the state of the scene is replaced (see PhysicsEngine::RestoreSnapshot()), so the pairs found afterwards
+   * do not depend on the history of the broadphase. Broadphases that keep no state have nothing to do.
+   */
+  virtual void Clear()
+  {
+  }
+
   /**
    * @brief Perform visual debugging of culling method.
    */
   virtual void DebugDraw() = 0;
+
+protected:
+  /**
+   * @brief Gets the key of an unordered pair of indices.
+   * @param a First index
+   * @param b Second index
+   * @return Pair key, ordered by the lower index
+   */
+  static inline uint64_t PairKey(uint32_t a, uint32_t b)
+  {
+    return (a < b) ? (((uint64_t)a << 32) | b) : (((uint64_t)b << 32) | a);
+  }
+
+  /**
+   * @brief Outputs pairs of objects in the order of the object list.
+   * @param objects All objects in scene
+   * @param pairKeys Keys of the pairs to output (see PairKey(), of indices in the object list), sorted in place
+   * @param collisionPairs Pairs are appended to this list, with the lower indexed object as object A
+   *
+   * Gives the same pair order as BruteForceBroadphase whatever order the pairs were found in, as the solver visits
+   * contacts in pair order.
+   */
+  static void AppendSortedPairs(std::vector<PhysicsObject *> &objects, std::vector<uint64_t> &pairKeys,
+                                std::vector<CollisionPair> &collisionPairs)
+  {
+    std::sort(pairKeys.begin(), pairKeys.end());
+
+    for (uint64_t key : pairKeys)
+    {
+      CollisionPair cp;
+      cp.pObjectA = objects[(uint32_t)(key >> 32)];
+      cp.pObjectB = objects[(uint32_t)(key & 0xFFFFFFFF)];
+
+      collisionPairs.push_back(cp);
+    }
+  }
 };
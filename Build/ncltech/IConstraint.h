@@ -50,9 +50,12 @@ public:
   /**
    * @brief Apply Velocity Impulse to object(s) in order to satisfy given constraint.
    *
-   * Called by PhysicsEngine upon resolving constraints
+   * Called by PhysicsEngine upon resolving constraints. Velocities of objects in the simulation must be read and modified
+   * through their solver bodies (see PhysicsEngine::GetSolverBody()), which are written back once the solver has finished.
+   *
+   * @return Magnitude of the largest impulse applied, used by the solver to detect convergence
    */
-  virtual void ApplyImpulse() = 0;
+  virtual float ApplyImpulse() = 0;
 
   /**
    * @brief Pre-solver step will be triggered before any calls to ApplyImpulse and only ever be called once per physics timestep
@@ -65,6 +68,27 @@ public:
   {
   }
 
+  /**
+   * @brief Gets the first object affected by this constraint.
+   * @return First object, NULL if the objects are not known
+   *
+   * Used to group constraints into simulation islands, constraints that do not report their objects prevent island
+   * solving.
+   */
+  virtual PhysicsObject *NodeA() const
+  {
+    return NULL;
+  }
+
+  /**
+   * @brief Gets the second object affected by this constraint.
+   * @return Second object, NULL if the objects are not known
+   */
+  virtual PhysicsObject *NodeB() const
+  {
+    return NULL;
+  }
+
   /**
    * @brief Visually debug constraint.
    */
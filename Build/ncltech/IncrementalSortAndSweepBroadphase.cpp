@@ -0,0 +1,445 @@
+#include "IncrementalSortAndSweepBroadphase.h"
+
+#include "NCLDebug.h"
+
+#include <algorithm>
+
+/**
+ * @brief Creates a new incremental sort and sweep broadphase instance.
+ * @param margin Distance object AABBs are expanded by in each direction
+ *
+ * The margin keeps pairs of resting objects whose AABBs only just touch from dropping in and out of the pair set as the
+ * contact jitters, which would discard their cached manifolds.
+ */
+IncrementalSortAndSweepBroadphase::IncrementalSortAndSweepBroadphase(float margin)
+    : IBroadphase()
+    , m_margin(margin)
+    , m_step(0)
+    , m_numSwaps(0)
+{
+}
+
+IncrementalSortAndSweepBroadphase::~IncrementalSortAndSweepBroadphase()
+{
+}
+
+/**
+ * @brief Removes all objects and pairs.
+ */
+void IncrementalSortAndSweepBroadphase::Clear()
+{
+  for (int axis = 0; axis < 3; ++axis)
+    m_endpoints[axis].clear();
+
+  m_proxies.clear();
+  m_freeProxies.clear();
+  m_proxyIndices.clear();
+  m_pairs.clear();
+  m_pairIndices.clear();
+  m_outputPairs.clear();
+}
+
+/**
+ * @copydoc IBroadphase::FindPotentialCollisionPairs
+ *
+ * Reports every pair of objects with overlapping (expanded) AABBs, except pairs where both objects are at rest. Pairs
+ * are output sorted by the indices of their objects in the object list, with the lower index as object A.
+ */
+void IncrementalSortAndSweepBroadphase::FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects,
+                                                                    std::vector<CollisionPair> &collisionPairs)
+{
+  m_step++;
+  m_numSwaps = 0;
+
+  // Add new objects and move endpoints of existing objects into place
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    PhysicsObject *obj = objects[i];
+    const BoundingBox aabb = obj->GetWorldSpaceAABB();
+    uint32_t proxy;
+
+    auto it = m_proxyIndices.find(obj);
+    if (it == m_proxyIndices.end())
+    {
+      proxy = AddProxy(obj, aabb);
+    }
+    else
+    {
+      proxy = it->second;
+      UpdateProxy(proxy, aabb);
+    }
+
+    m_proxies[proxy].objectIndex = (uint32_t)i;
+  }
+
+  // Remove objects that are no longer in the scene (only possible if there are more proxies than objects)
+  if (m_proxyIndices.size() > objects.size())
+    RemoveProxies();
+
+  // Pairs are kept in the order they started overlapping, which depends on the history of the endpoint lists
+  m_outputPairs.clear();
+  for (uint64_t key : m_pairs)
+  {
+    const Proxy &a = m_proxies[(uint32_t)(key >> 32)];
+    const Proxy &b = m_proxies[(uint32_t)(key & 0xFFFFFFFF)];
+
+    // Skip pairs of two at rest objects
+    if (a.object->IsAtRest() && b.object->IsAtRest())
+      continue;
+
+    m_outputPairs.push_back(PairKey(a.objectIndex, b.objectIndex));
+  }
+
+  AppendSortedPairs(objects, m_outputPairs, collisionPairs);
+}
+
+/**
+ * @copydoc IBroadphase::DebugDraw
+ */
+void IncrementalSortAndSweepBroadphase::DebugDraw()
+{
+  NCLDebug::DrawPointNDT(Vector3(0.0f, 0.0f, 0.0f), 0.05f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+  NCLDebug::DrawThickLine(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), 0.02f, Vector4(1.0f, 0.0f, 0.0f, 1.0f));
+  NCLDebug::DrawThickLine(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), 0.02f, Vector4(0.0f, 1.0f, 0.0f, 1.0f));
+  NCLDebug::DrawThickLine(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), 0.02f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+/**
+ * @brief Starts tracking an object.
+ * @param obj Object
+ * @param aabb World space AABB of the object
+ * @return Index of the proxy of the object
+ *
+ * Endpoints are appended to the end of each axis and sorted down into place. Overlaps are only updated when sorting the
+ * last axis, at which point the endpoints on the other axes are already correct.
+ */
+uint32_t IncrementalSortAndSweepBroadphase::AddProxy(PhysicsObject *obj, const BoundingBox &aabb)
+{
+  uint32_t proxy;
+  if (m_freeProxies.empty())
+  {
+    proxy = (uint32_t)m_proxies.size();
+    m_proxies.push_back(Proxy());
+  }
+  else
+  {
+    proxy = m_freeProxies.back();
+    m_freeProxies.pop_back();
+  }
+
+  m_proxies[proxy].object = obj;
+  m_proxies[proxy].seenStep = m_step;
+  m_proxyIndices[obj] = proxy;
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<Endpoint> &endpoints = m_endpoints[axis];
+
+    m_proxies[proxy].min[axis] = (uint32_t)endpoints.size();
+    m_proxies[proxy].max[axis] = (uint32_t)endpoints.size() + 1;
+
+    Endpoint minEndpoint = {aabb.Lower()[axis] - m_margin, proxy << 1};
+    Endpoint maxEndpoint = {aabb.Upper()[axis] + m_margin, (proxy << 1) | 1};
+    endpoints.push_back(minEndpoint);
+    endpoints.push_back(maxEndpoint);
+
+    SortMinDown(axis, m_proxies[proxy].min[axis], axis == 2);
+    SortMaxDown(axis, m_proxies[proxy].max[axis], axis == 2);
+  }
+
+  return proxy;
+}
+
+/**
+ * @brief Moves the endpoints of an object to match its current AABB.
+ * @param proxy Proxy index
+ * @param aabb World space AABB of the object
+ */
+void IncrementalSortAndSweepBroadphase::UpdateProxy(uint32_t proxy, const BoundingBox &aabb)
+{
+  m_proxies[proxy].seenStep = m_step;
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<Endpoint> &endpoints = m_endpoints[axis];
+    const uint32_t minIndex = m_proxies[proxy].min[axis];
+    const uint32_t maxIndex = m_proxies[proxy].max[axis];
+
+    const float newMin = aabb.Lower()[axis] - m_margin;
+    const float newMax = aabb.Upper()[axis] + m_margin;
+    const float dMin = newMin - endpoints[minIndex].value;
+    const float dMax = newMax - endpoints[maxIndex].value;
+
+    endpoints[minIndex].value = newMin;
+    endpoints[maxIndex].value = newMax;
+
+    // Expand first so the lower endpoint never passes the upper endpoint of the same object
+    if (dMin < 0.0f)
+      SortMinDown(axis, minIndex, true);
+    if (dMax > 0.0f)
+      SortMaxUp(axis, maxIndex, true);
+    if (dMin > 0.0f)
+      SortMinUp(axis, m_proxies[proxy].min[axis], true);
+    if (dMax < 0.0f)
+      SortMaxDown(axis, m_proxies[proxy].max[axis], true);
+  }
+}
+
+/**
+ * @brief Removes all proxies for objects that were not present in the object list this step.
+ */
+void IncrementalSortAndSweepBroadphase::RemoveProxies()
+{
+  auto removed = [this](uint32_t proxy) { return m_proxies[proxy].seenStep != m_step; };
+
+  // Remove pairs involving removed proxies
+  for (size_t i = 0; i < m_pairs.size();)
+  {
+    uint64_t key = m_pairs[i];
+    if (removed((uint32_t)(key >> 32)) || removed((uint32_t)(key & 0xFFFFFFFF)))
+      RemovePair((uint32_t)(key >> 32), (uint32_t)(key & 0xFFFFFFFF));
+    else
+      ++i;
+  }
+
+  // Remove endpoints and reindex the remaining endpoints
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<Endpoint> &endpoints = m_endpoints[axis];
+    endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+                                   [this](const Endpoint &e) { return m_proxies[e.Proxy()].seenStep != m_step; }),
+                    endpoints.end());
+
+    for (uint32_t i = 0; i < (uint32_t)endpoints.size(); ++i)
+    {
+      Proxy &p = m_proxies[endpoints[i].Proxy()];
+      if (endpoints[i].IsMax())
+        p.max[axis] = i;
+      else
+        p.min[axis] = i;
+    }
+  }
+
+  // Free proxies
+  for (auto it = m_proxyIndices.begin(); it != m_proxyIndices.end();)
+  {
+    if (removed(it->second))
+    {
+      m_proxies[it->second].object = nullptr;
+      m_freeProxies.push_back(it->second);
+      it = m_proxyIndices.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Moves a lower endpoint towards the start of an axis until it is in order.
+ * @param axis Axis index
+ * @param endpoint Index of the endpoint
+ * @param updateOverlaps If pairs should be added when the endpoint passes the upper endpoint of another object
+ */
+void IncrementalSortAndSweepBroadphase::SortMinDown(int axis, uint32_t endpoint, bool updateOverlaps)
+{
+  std::vector<Endpoint> &endpoints = m_endpoints[axis];
+  const uint32_t proxy = endpoints[endpoint].Proxy();
+
+  while (endpoint > 0 && endpoints[endpoint - 1].value > endpoints[endpoint].value)
+  {
+    const Endpoint &prev = endpoints[endpoint - 1];
+    Proxy &other = m_proxies[prev.Proxy()];
+
+    if (prev.IsMax())
+    {
+      // Start of overlap on this axis
+      if (updateOverlaps && OverlapsOnOtherAxes(proxy, prev.Proxy(), axis))
+        AddPair(proxy, prev.Proxy());
+
+      other.max[axis]++;
+    }
+    else
+    {
+      other.min[axis]++;
+    }
+
+    m_proxies[proxy].min[axis]--;
+    std::swap(endpoints[endpoint - 1], endpoints[endpoint]);
+    endpoint--;
+    m_numSwaps++;
+  }
+}
+
+/**
+ * @brief Moves a lower endpoint towards the end of an axis until it is in order.
+ * @param axis Axis index
+ * @param endpoint Index of the endpoint
+ * @param updateOverlaps If pairs should be removed when the endpoint passes the upper endpoint of another object
+ */
+void IncrementalSortAndSweepBroadphase::SortMinUp(int axis, uint32_t endpoint, bool updateOverlaps)
+{
+  std::vector<Endpoint> &endpoints = m_endpoints[axis];
+  const uint32_t proxy = endpoints[endpoint].Proxy();
+
+  while (endpoint + 1 < endpoints.size() && endpoints[endpoint + 1].value < endpoints[endpoint].value)
+  {
+    const Endpoint &next = endpoints[endpoint + 1];
+    Proxy &other = m_proxies[next.Proxy()];
+
+    if (next.IsMax())
+    {
+      // End of overlap on this axis
+      if (updateOverlaps)
+        RemovePair(proxy, next.Proxy());
+
+      other.max[axis]--;
+    }
+    else
+    {
+      other.min[axis]--;
+    }
+
+    m_proxies[proxy].min[axis]++;
+    std::swap(endpoints[endpoint], endpoints[endpoint + 1]);
+    endpoint++;
+    m_numSwaps++;
+  }
+}
+
+/**
+ * @brief Moves an upper endpoint towards the start of an axis until it is in order.
+ * @param axis Axis index
+ * @param endpoint Index of the endpoint
+ * @param updateOverlaps If pairs should be removed when the endpoint passes the lower endpoint of another object
+ */
+void IncrementalSortAndSweepBroadphase::SortMaxDown(int axis, uint32_t endpoint, bool updateOverlaps)
+{
+  std::vector<Endpoint> &endpoints = m_endpoints[axis];
+  const uint32_t proxy = endpoints[endpoint].Proxy();
+
+  while (endpoint > 0 && endpoints[endpoint - 1].value > endpoints[endpoint].value)
+  {
+    const Endpoint &prev = endpoints[endpoint - 1];
+    Proxy &other = m_proxies[prev.Proxy()];
+
+    if (!prev.IsMax())
+    {
+      // End of overlap on this axis
+      if (updateOverlaps)
+        RemovePair(proxy, prev.Proxy());
+
+      other.min[axis]++;
+    }
+    else
+    {
+      other.max[axis]++;
+    }
+
+    m_proxies[proxy].max[axis]--;
+    std::swap(endpoints[endpoint - 1], endpoints[endpoint]);
+    endpoint--;
+    m_numSwaps++;
+  }
+}
+
+/**
+ * @brief Moves an upper endpoint towards the end of an axis until it is in order.
+ * @param axis Axis index
+ * @param endpoint Index of the endpoint
+ * @param updateOverlaps If pairs should be added when the endpoint passes the lower endpoint of another object
+ */
+void IncrementalSortAndSweepBroadphase::SortMaxUp(int axis, uint32_t endpoint, bool updateOverlaps)
+{
+  std::vector<Endpoint> &endpoints = m_endpoints[axis];
+  const uint32_t proxy = endpoints[endpoint].Proxy();
+
+  while (endpoint + 1 < endpoints.size() && endpoints[endpoint + 1].value < endpoints[endpoint].value)
+  {
+    const Endpoint &next = endpoints[endpoint + 1];
+    Proxy &other = m_proxies[next.Proxy()];
+
+    if (!next.IsMax())
+    {
+      // Start of overlap on this axis
+      if (updateOverlaps && OverlapsOnOtherAxes(proxy, next.Proxy(), axis))
+        AddPair(proxy, next.Proxy());
+
+      other.min[axis]--;
+    }
+    else
+    {
+      other.max[axis]--;
+    }
+
+    m_proxies[proxy].max[axis]++;
+    std::swap(endpoints[endpoint], endpoints[endpoint + 1]);
+    endpoint++;
+    m_numSwaps++;
+  }
+}
+
+/**
+ * @brief Checks if two proxies overlap on the two axes other than a given axis.
+ * @param a First proxy index
+ * @param b Second proxy index
+ * @param axis Axis to ignore
+ * @return True if the endpoint intervals overlap on both other axes
+ */
+bool IncrementalSortAndSweepBroadphase::OverlapsOnOtherAxes(uint32_t a, uint32_t b, int axis) const
+{
+  const Proxy &pa = m_proxies[a];
+  const Proxy &pb = m_proxies[b];
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (i == axis)
+      continue;
+
+    if (pa.max[i] < pb.min[i] || pb.max[i] < pa.min[i])
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Adds a pair to the overlapping pair set, if it is not already present.
+ * @param a First proxy index
+ * @param b Second proxy index
+ */
+void IncrementalSortAndSweepBroadphase::AddPair(uint32_t a, uint32_t b)
+{
+  const uint64_t key = PairKey(a, b);
+
+  if (m_pairIndices.find(key) != m_pairIndices.end())
+    return;
+
+  m_pairIndices[key] = m_pairs.size();
+  m_pairs.push_back(key);
+}
+
+/**
+ * @brief Removes a pair from the overlapping pair set, if it is present.
+ * @param a First proxy index
+ * @param b Second proxy index
+ */
+void IncrementalSortAndSweepBroadphase::RemovePair(uint32_t a, uint32_t b)
+{
+  auto it = m_pairIndices.find(PairKey(a, b));
+  if (it == m_pairIndices.end())
+    return;
+
+  // Move the last pair into the removed slot
+  const size_t index = it->second;
+  m_pairIndices.erase(it);
+
+  if (index + 1 < m_pairs.size())
+  {
+    m_pairs[index] = m_pairs.back();
+    m_pairIndices[m_pairs[index]] = index;
+  }
+
+  m_pairs.pop_back();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "IBroadphase.h"
+
+#include <stdint.h>
+#include <unordered_map>
+
+/**
+ * @class IncrementalSortAndSweepBroadphase
+ * @author Dan Nixon
+ * @brief Broadphase collision pair culling using persistent sorted endpoint lists on all three axes.
+ *
+ * The lower and upper AABB bounds of each object are kept as endpoints in a sorted list per axis. Each step the endpoints
+ * of objects that have moved are moved into place by insertion sort, which is close to linear when objects move little
+ * between steps. Whenever a lower and upper endpoint of two objects swap the pair either starts or stops overlapping on
+ * that axis, so the set of pairs overlapping on all three axes is kept up to date without testing every pair.
+ */
+class IncrementalSortAndSweepBroadphase : public IBroadphase
+{
+public:
+  IncrementalSortAndSweepBroadphase(float margin = 0.01f);
+  virtual ~IncrementalSortAndSweepBroadphase();
+
+  /**
+   * @brief Gets the distance object AABBs are expanded by in each direction.
+   * @return Margin
+   */
+  inline float Margin() const
+  {
+    return m_margin;
+  }
+
+  /**
+   * @brief Gets the number of objects tracked.
+   * @return Object count
+   */
+  inline size_t NumObjects() const
+  {
+    return m_proxyIndices.size();
+  }
+
+  /**
+   * @brief Gets the number of pairs of objects with overlapping AABBs.
+   * @return Overlapping pair count
+   */
+  inline size_t NumOverlappingPairs() const
+  {
+    return m_pairs.size();
+  }
+
+  /**
+   * @brief Gets the number of endpoint swaps performed in the last update.
+   * @return Swap count
+   */
+  inline size_t NumSwaps() const
+  {
+    return m_numSwaps;
+  }
+
+  virtual void Clear();
+
+  virtual void FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects, std::vector<CollisionPair> &collisionPairs);
+  virtual void DebugDraw();
+
+protected:
+  /**
+   * @brief Lower or upper bound of an object on one axis.
+   */
+  struct Endpoint
+  {
+    float value;   //!< Position along the axis
+    uint32_t data; //!< Proxy index shifted left by one, lowest bit set for upper bounds
+
+    /**
+     * @brief Gets the index of the proxy this endpoint belongs to.
+     * @return Proxy index
+     */
+    inline uint32_t Proxy() const
+    {
+      return data >> 1;
+    }
+
+    /**
+     * @brief Checks if this is an upper bound.
+     * @return True for upper bounds
+     */
+    inline bool IsMax() const
+    {
+      return (data & 1) != 0;
+    }
+  };
+
+  /**
+   * @brief Broadphase representation of a single object.
+   */
+  struct Proxy
+  {
+    PhysicsObject *object; //!< Object, nullptr for free proxies
+    uint32_t objectIndex;  //!< Index of the object in the object list of the last update
+    uint32_t min[3];       //!< Index of the lower endpoint on each axis
+    uint32_t max[3];       //!< Index of the upper endpoint on each axis
+    size_t seenStep;       //!< Last step the object was present in the object list
+  };
+
+  uint32_t AddProxy(PhysicsObject *obj, const BoundingBox &aabb);
+  void UpdateProxy(uint32_t proxy, const BoundingBox &aabb);
+  void RemoveProxies();
+
+  void SortMinDown(int axis, uint32_t endpoint, bool updateOverlaps);
+  void SortMinUp(int axis, uint32_t endpoint, bool updateOverlaps);
+  void SortMaxDown(int axis, uint32_t endpoint, bool updateOverlaps);
+  void SortMaxUp(int axis, uint32_t endpoint, bool updateOverlaps);
+
+  bool OverlapsOnOtherAxes(uint32_t a, uint32_t b, int axis) const;
+  void AddPair(uint32_t a, uint32_t b);
+  void RemovePair(uint32_t a, uint32_t b);
+
+protected:
+  float m_margin; //!< Distance object AABBs are expanded by in each direction
+
+  std::vector<Endpoint> m_endpoints[3]; //!< Sorted endpoints on each axis
+  std::vector<Proxy> m_proxies;         //!< Proxy pool
+  std::vector<uint32_t> m_freeProxies;  //!< Indices of free proxies in the pool
+
+  std::unordered_map<PhysicsObject *, uint32_t> m_proxyIndices; //!< Proxy of each tracked object
+
+  std::vector<uint64_t> m_pairs;                      //!< Keys of pairs overlapping on all axes
+  std::unordered_map<uint64_t, size_t> m_pairIndices; //!< Index of each overlapping pair in m_pairs
+  std::vector<uint64_t> m_outputPairs;                //!< Object list indices of the pairs output in the current update
+
+  size_t m_step;     //!< Counter of updates, used to stamp proxies
+  size_t m_numSwaps; //!< Number of endpoint swaps performed in the last update
+};
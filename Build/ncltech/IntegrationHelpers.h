@@ -1,7 +1,20 @@
 #pragma once
 
+#include <nclgl\Matrix3.h>
+#include <nclgl\Quaternion.h>
 #include <nclgl\Vector3.h>
 
+/**
+ * @brief Represents different integration schemes.
+ */
+enum IntegrationType
+{
+  INTEGRATION_EXPLICIT_EULER,
+  INTEGRATION_SEMI_IMPLICIT_EULER,
+  INTEGRATION_RUNGE_KUTTA_2,
+  INTEGRATION_RUNGE_KUTTA_4
+};
+
 /**
  * @class IntegrationHelpers
  * @author Dan Nixon
@@ -25,4 +38,78 @@ public:
   static void RK4(State &state, float dt);
 
   static State Evaluate(State initial, float dt, const State &derivative);
+
+  /**
+   * @brief Integrates the motion state of a single body over one timestep.
+   * @param dt Timestep
+   * @param damping Velocity damping coefficient
+   * @param position Position
+   * @param linearVelocity Linear velocity
+   * @param linearForce Linear force
+   * @param inverseMass Inverse mass
+   * @param orientation Orientation
+   * @param angularVelocity Angular velocity
+   * @param torque Torque
+   * @param inverseInertia Inverse inertia
+   *
+   * The scheme is a template parameter so every test on it is resolved at compile time, callers should select the
+   * instantiation once for a whole range of bodies.
+   */
+  template <IntegrationType Type>
+  static inline void Integrate(float dt, float damping, Vector3 &position, Vector3 &linearVelocity, const Vector3 &linearForce,
+                               float inverseMass, Quaternion &orientation, Vector3 &angularVelocity, const Vector3 &torque,
+                               const Matrix3 &inverseInertia)
+  {
+    const bool explicitEuler = (Type == INTEGRATION_EXPLICIT_EULER);
+    const bool rungeKutta = (Type == INTEGRATION_RUNGE_KUTTA_2 || Type == INTEGRATION_RUNGE_KUTTA_4);
+
+    // Linear motion, explicit Euler moves with the velocity from the start of the step
+    if (explicitEuler)
+      position += linearVelocity * dt;
+
+    if (rungeKutta)
+    {
+      State state = {position, linearVelocity, linearForce * inverseMass};
+
+      if (Type == INTEGRATION_RUNGE_KUTTA_2)
+        RK2(state, dt);
+      else
+        RK4(state, dt);
+
+      position = state.position;
+      linearVelocity = state.velocity;
+    }
+    else
+    {
+      // v = u + at
+      linearVelocity += linearForce * inverseMass * dt;
+    }
+
+    linearVelocity = linearVelocity * damping;
+
+    if (!explicitEuler && !rungeKutta)
+      position += linearVelocity * dt;
+
+    // Angular motion, again explicit Euler rotates with the velocity from the start of the step
+    if (explicitEuler)
+      IntegrateOrientation(orientation, angularVelocity, dt);
+
+    angularVelocity += inverseInertia * torque * dt;
+    angularVelocity = angularVelocity * damping;
+
+    if (!explicitEuler)
+      IntegrateOrientation(orientation, angularVelocity, dt);
+  }
+
+  /**
+   * @brief Rotates an orientation by an angular velocity over one timestep.
+   * @param orientation Orientation
+   * @param angularVelocity Angular velocity
+   * @param dt Timestep
+   */
+  static inline void IntegrateOrientation(Quaternion &orientation, const Vector3 &angularVelocity, float dt)
+  {
+    orientation = orientation + (orientation * (angularVelocity * dt * 0.5f));
+    orientation.Normalise();
+  }
 };
\ No newline at end of file
@@ -1,16 +1,60 @@
 #include "Manifold.h"
 #include "NCLDebug.h"
 #include "PhysicsEngine.h"
+#include <algorithm>
 #include <nclgl\Matrix3.h>
 
+using std::min;
+using std::max;
+
 #define persistentThresholdSq 0.025f
 
 typedef std::list<ContactPoint> ContactList;
 typedef ContactList::iterator ContactListItr;
 
+// Effective mass of a contact along a direction, static (and kinematic) bodies have no response so contribute nothing
+static inline float EffectiveMass(const SolverBody &bodyA, const SolverBody &bodyB, const Vector3 &r1, const Vector3 &r2,
+                                  const Vector3 &dir)
+{
+  if (bodyA.isStatic)
+    return bodyB.inverseMass + Vector3::Dot(dir, Vector3::Cross(bodyB.inverseInertia * Vector3::Cross(r2, dir), r2));
+
+  if (bodyB.isStatic)
+    return bodyA.inverseMass + Vector3::Dot(dir, Vector3::Cross(bodyA.inverseInertia * Vector3::Cross(r1, dir), r1));
+
+  return (bodyA.inverseMass + bodyB.inverseMass) +
+         Vector3::Dot(dir, Vector3::Cross(bodyA.inverseInertia * Vector3::Cross(r1, dir), r1) +
+                               Vector3::Cross(bodyB.inverseInertia * Vector3::Cross(r2, dir), r2));
+}
+
+// Copies the state of an object used by the solver into a solver body, as PhysicsEngine::BuildSolverBodies() does
+static void LoadSolverBody(const PhysicsObject *obj, SolverBody &body)
+{
+  body.linearVelocity = obj->GetLinearVelocity();
+  body.angularVelocity = obj->GetAngularVelocity();
+  body.isStatic = obj->IsStatic();
+
+  if (body.isStatic)
+  {
+    body.inverseMass = 0.0f;
+    body.inverseInertia = Matrix3::ZeroMatrix;
+  }
+  else
+  {
+    body.inverseMass = obj->GetInverseMass();
+
+    Matrix3 rotation = obj->GetOrientation().ToMatrix3();
+    body.inverseInertia = rotation * obj->GetInverseInertia() * Matrix3::Transpose(rotation);
+  }
+}
+
 Manifold::Manifold()
     : m_pNodeA(NULL)
     , m_pNodeB(NULL)
+    , m_pBodyA(&m_objectBodyA)
+    , m_pBodyB(&m_objectBodyB)
+    , m_friction(0.0f)
+    , m_elasticity(0.0f)
 {
 }
 
@@ -20,67 +64,70 @@ Manifold::~Manifold()
 
 void Manifold::Initiate(PhysicsObject *nodeA, PhysicsObject *nodeB)
 {
+  m_vPrevContacts.swap(m_vContacts);
   m_vContacts.clear();
 
   m_pNodeA = nodeA;
   m_pNodeB = nodeB;
 }
 
-void Manifold::ApplyImpulse()
+float Manifold::ApplyImpulse()
 {
+  LoadObjectBodies();
+
+  float maxImpulse = 0.0f;
   for (auto it = m_vContacts.begin(); it != m_vContacts.end(); ++it)
-    SolveContactPoint(*it);
+  {
+    float impulse = SolveContactPoint(*it);
+    if (impulse > maxImpulse)
+      maxImpulse = impulse;
+  }
+
+  StoreObjectBodies();
+
+  return maxImpulse;
 }
 
-void Manifold::SolveContactPoint(ContactPoint &c)
+float Manifold::SolveContactPoint(ContactPoint &c)
 {
-  if (m_pNodeA->GetInverseMass() + m_pNodeB->GetInverseMass() == 0.0f)
-    return;
+  SolverBody &bodyA = *m_pBodyA;
+  SolverBody &bodyB = *m_pBodyB;
+
+  if (bodyA.inverseMass + bodyB.inverseMass == 0.0f)
+    return 0.0f;
+
+  float maxImpulse = 0.0f;
 
   Vector3 r1 = c.relPosA;
   Vector3 r2 = c.relPosB;
 
-  Vector3 v0 = m_pNodeA->GetLinearVelocity() + Vector3::Cross(m_pNodeA->GetAngularVelocity(), r1);
-  Vector3 v1 = m_pNodeB->GetLinearVelocity() + Vector3::Cross(m_pNodeB->GetAngularVelocity(), r2);
+  Vector3 v0 = bodyA.linearVelocity + Vector3::Cross(bodyA.angularVelocity, r1);
+  Vector3 v1 = bodyB.linearVelocity + Vector3::Cross(bodyB.angularVelocity, r2);
 
   Vector3 normal = c.collisionNormal;
   Vector3 dv = v0 - v1;
 
   // Collision Resolution
   {
-    float constraintMass =
-        (m_pNodeA->GetInverseMass() + m_pNodeB->GetInverseMass()) +
-        Vector3::Dot(normal, Vector3::Cross(m_pNodeA->GetInverseInertia() * Vector3::Cross(r1, normal), r1) +
-                                 Vector3::Cross(m_pNodeB->GetInverseInertia() * Vector3::Cross(r2, normal), r2));
-
-    // Baumgarte Offset (Adds energy to the system to counter slight solving errors that accumulate over time called as
-    // 'constraint drift')
-    float b = 0.0f;
-    {
-      float distanceOffset = c.collisionPenetration;
-
-      float baumgarteScalar = 0.3f; // Amount of force to add to the system to solve error
-      float baumgarteSlop = 0.001f; // Amount of allowed penetration, ensures a complete manifold each frame
-
-      float penetrationSlop = min(c.collisionPenetration + baumgarteSlop, 0.0f);
-
-      b = -(baumgarteScalar / PhysicsEngine::Instance()->GetDeltaTime()) * penetrationSlop;
-    }
-
-    float bReal = max(b, c.elatisity_term + b * 0.2f);
-    float jn = -(Vector3::Dot(dv, normal) + bReal) / constraintMass;
+    float jn = -(Vector3::Dot(dv, normal) + c.bias) / c.constraintMass;
 
     float oldSumImpulseContact = c.sumImpulseContact;
     c.sumImpulseContact = min(c.sumImpulseContact + jn, 0.0f);
     jn = c.sumImpulseContact - oldSumImpulseContact;
+    maxImpulse = fabsf(jn);
 
-    m_pNodeA->SetLinearVelocity(m_pNodeA->GetLinearVelocity() + normal * (jn * m_pNodeA->GetInverseMass()));
-    m_pNodeB->SetLinearVelocity(m_pNodeB->GetLinearVelocity() - normal * (jn * m_pNodeB->GetInverseMass()));
+    // Static objects are never written to as they may be shared between islands solved in parallel
+    if (!bodyA.isStatic)
+    {
+      bodyA.linearVelocity += normal * (jn * bodyA.inverseMass);
+      bodyA.angularVelocity += bodyA.inverseInertia * Vector3::Cross(r1, normal * jn);
+    }
 
-    m_pNodeA->SetAngularVelocity(m_pNodeA->GetAngularVelocity() +
-                                 m_pNodeA->GetInverseInertia() * Vector3::Cross(r1, normal * jn));
-    m_pNodeB->SetAngularVelocity(m_pNodeB->GetAngularVelocity() -
-                                 m_pNodeB->GetInverseInertia() * Vector3::Cross(r2, normal * jn));
+    if (!bodyB.isStatic)
+    {
+      bodyB.linearVelocity -= normal * (jn * bodyB.inverseMass);
+      bodyB.angularVelocity -= bodyB.inverseInertia * Vector3::Cross(r2, normal * jn);
+    }
   }
 
   // Friction
@@ -92,51 +139,135 @@ void Manifold::SolveContactPoint(ContactPoint &c)
     {
       tangent = tangent * (1.0f / tangent_len);
 
-      float frictionalMass =
-          (m_pNodeA->GetInverseMass() + m_pNodeB->GetInverseMass()) +
-          Vector3::Dot(tangent, Vector3::Cross(m_pNodeA->GetInverseInertia() * Vector3::Cross(r1, tangent), r1) +
-                                    Vector3::Cross(m_pNodeB->GetInverseInertia() * Vector3::Cross(r2, tangent), r2));
+      float frictionalMass = EffectiveMass(bodyA, bodyB, r1, r2, tangent);
 
-      float frictionCoef = sqrtf(m_pNodeA->GetFriction() * m_pNodeB->GetFriction());
-
-      float jt = -1.0f * frictionCoef * Vector3::Dot(dv, tangent) / frictionalMass;
+      float jt = -1.0f * m_friction * Vector3::Dot(dv, tangent) / frictionalMass;
 
       float oldImpulseTangent = c.sumImpulseFriction;
-      float maxJt = frictionCoef * c.sumImpulseContact;
+      float maxJt = m_friction * c.sumImpulseContact;
       c.sumImpulseFriction = min(max(oldImpulseTangent + jt, maxJt), -maxJt);
       jt = c.sumImpulseFriction - oldImpulseTangent;
+      maxImpulse = max(maxImpulse, fabsf(jt));
 
-      m_pNodeA->SetLinearVelocity(m_pNodeA->GetLinearVelocity() + tangent * (jt * m_pNodeA->GetInverseMass()));
-      m_pNodeB->SetLinearVelocity(m_pNodeB->GetLinearVelocity() - tangent * (jt * m_pNodeB->GetInverseMass()));
+      if (!bodyA.isStatic)
+      {
+        bodyA.linearVelocity += tangent * (jt * bodyA.inverseMass);
+        bodyA.angularVelocity += bodyA.inverseInertia * Vector3::Cross(r1, tangent * jt);
+      }
 
-      m_pNodeA->SetAngularVelocity(m_pNodeA->GetAngularVelocity() +
-                                   m_pNodeA->GetInverseInertia() * Vector3::Cross(r1, tangent * jt));
-      m_pNodeB->SetAngularVelocity(m_pNodeB->GetAngularVelocity() -
-                                   m_pNodeB->GetInverseInertia() * Vector3::Cross(r2, tangent * jt));
+      if (!bodyB.isStatic)
+      {
+        bodyB.linearVelocity -= tangent * (jt * bodyB.inverseMass);
+        bodyB.angularVelocity -= bodyB.inverseInertia * Vector3::Cross(r2, tangent * jt);
+      }
     }
   }
+
+  return maxImpulse;
 }
 
 void Manifold::PreSolverStep(float dt)
 {
+  PhysicsEngine *engine = m_pNodeA->GetWorld();
+  const bool warmStart = engine != NULL && engine->IsWarmStartingEnabled();
+
+  // Velocities are read from and written to the solver bodies of the objects until the solver has finished. When the
+  // manifold is solved outside of the engine solver there are no solver bodies, so the objects are solved directly.
+  m_pBodyA = engine != NULL ? engine->GetSolverBody(m_pNodeA) : NULL;
+  m_pBodyB = engine != NULL ? engine->GetSolverBody(m_pNodeB) : NULL;
+
+  if (m_pBodyA == NULL)
+    m_pBodyA = &m_objectBodyA;
+  if (m_pBodyB == NULL)
+    m_pBodyB = &m_objectBodyB;
+
+  LoadObjectBodies();
+
+  // Material coefficients do not change during the solve so are combined once per step
+  m_friction = sqrtf(m_pNodeA->GetFriction() * m_pNodeB->GetFriction());
+  m_elasticity = sqrtf(m_pNodeA->GetElasticity() * m_pNodeB->GetElasticity());
+
   for (auto it = m_vContacts.begin(); it != m_vContacts.end(); ++it)
-    UpdateConstraint(*it);
+  {
+    // Reset total impulse forces computed this physics timestep, contact impulses may be carried over from the previous
+    // step by warm starting (friction is not, as its direction is recomputed from the relative velocity in every
+    // iteration)
+    it->sumImpulseContact = 0.0f;
+    it->sumImpulseFriction = 0.0f;
+
+    UpdateConstraint(*it, dt);
+
+    if (warmStart)
+      WarmStart(*it);
+  }
+
+  StoreObjectBodies();
 }
 
-void Manifold::UpdateConstraint(ContactPoint &contact)
+/**
+ * @brief Copies the state of objects without an engine solver body into the solver bodies owned by this manifold.
+ *
+ * Reloaded before every solve as the object may also be modified by other constraints.
+ */
+void Manifold::LoadObjectBodies()
 {
-  // Reset total impulse forces computed this physics timestep
-  contact.sumImpulseContact = 0.0f;
-  contact.sumImpulseFriction = 0.0f;
+  if (m_pBodyA == &m_objectBodyA)
+    LoadSolverBody(m_pNodeA, m_objectBodyA);
+
+  if (m_pBodyB == &m_objectBodyB)
+    LoadSolverBody(m_pNodeB, m_objectBodyB);
+}
+
+/**
+ * @brief Writes the velocities of the solver bodies owned by this manifold back to their objects.
+ */
+void Manifold::StoreObjectBodies()
+{
+  if (m_pBodyA == &m_objectBodyA && !m_objectBodyA.isStatic)
+  {
+    m_pNodeA->SetLinearVelocity(m_objectBodyA.linearVelocity);
+    m_pNodeA->SetAngularVelocity(m_objectBodyA.angularVelocity);
+  }
 
+  if (m_pBodyB == &m_objectBodyB && !m_objectBodyB.isStatic)
   {
-    const float elasticity = sqrtf(m_pNodeA->GetElasticity() * m_pNodeB->GetElasticity());
+    m_pNodeB->SetLinearVelocity(m_objectBodyB.linearVelocity);
+    m_pNodeB->SetAngularVelocity(m_objectBodyB.angularVelocity);
+  }
+}
+
+void Manifold::WarmStart(ContactPoint &c)
+{
+  // Reapply part of the contact impulse accumulated on the matching contact in the previous step so the solver starts
+  // close to the converged solution (see WARM_START_FACTOR). The carried over impulse is left untouched, the total for
+  // this step starts from the amount applied so the solver clamps against the impulse the bodies actually received.
+  c.sumImpulseContact = c.warmStartImpulse * WARM_START_FACTOR;
+  Vector3 impulse = c.collisionNormal * c.sumImpulseContact;
 
+  if (!m_pBodyA->isStatic)
+  {
+    m_pBodyA->linearVelocity += impulse * m_pBodyA->inverseMass;
+    m_pBodyA->angularVelocity += m_pBodyA->inverseInertia * Vector3::Cross(c.relPosA, impulse);
+  }
+
+  if (!m_pBodyB->isStatic)
+  {
+    m_pBodyB->linearVelocity -= impulse * m_pBodyB->inverseMass;
+    m_pBodyB->angularVelocity -= m_pBodyB->inverseInertia * Vector3::Cross(c.relPosB, impulse);
+  }
+}
+
+void Manifold::UpdateConstraint(ContactPoint &contact, float dt)
+{
+  const SolverBody &bodyA = *m_pBodyA;
+  const SolverBody &bodyB = *m_pBodyB;
+
+  {
     float elatisity_term =
-        elasticity * Vector3::Dot(contact.collisionNormal, m_pNodeA->GetLinearVelocity() +
-                                                               Vector3::Cross(contact.relPosA, m_pNodeA->GetAngularVelocity()) -
-                                                               m_pNodeB->GetLinearVelocity() -
-                                                               Vector3::Cross(contact.relPosB, m_pNodeB->GetAngularVelocity()));
+        m_elasticity * Vector3::Dot(contact.collisionNormal, bodyA.linearVelocity +
+                                                                 Vector3::Cross(contact.relPosA, bodyA.angularVelocity) -
+                                                                 bodyB.linearVelocity -
+                                                                 Vector3::Cross(contact.relPosB, bodyB.angularVelocity));
 
     if (elatisity_term < 0.0f)
     {
@@ -159,6 +290,23 @@ void Manifold::UpdateConstraint(ContactPoint &contact)
       contact.elatisity_term = elatisity_term;
     }
   }
+
+  // Effective mass along the contact normal
+  {
+    contact.constraintMass = EffectiveMass(bodyA, bodyB, contact.relPosA, contact.relPosB, contact.collisionNormal);
+  }
+
+  // Baumgarte Offset (Adds energy to the system to counter slight solving errors that accumulate over time called as
+  // 'constraint drift')
+  {
+    float baumgarteScalar = 0.3f; // Amount of force to add to the system to solve error
+    float baumgarteSlop = 0.001f; // Amount of allowed penetration, ensures a complete manifold each frame
+
+    float penetrationSlop = min(contact.collisionPenetration + baumgarteSlop, 0.0f);
+
+    float b = -(baumgarteScalar / dt) * penetrationSlop;
+    contact.bias = max(b, contact.elatisity_term + b * 0.2f);
+  }
 }
 
 void Manifold::AddContact(const Vector3 &globalOnA, const Vector3 &globalOnB, const Vector3 &_normal, const float &_penetration)
@@ -174,6 +322,22 @@ void Manifold::AddContact(const Vector3 &globalOnA, const Vector3 &globalOnB, co
   contact.relPosB = r2;
   contact.collisionNormal = _normal;
   contact.collisionPenetration = _penetration;
+  contact.sumImpulseContact = 0.0f;
+  contact.sumImpulseFriction = 0.0f;
+  contact.warmStartImpulse = 0.0f;
+
+  // Carry over the accumulated impulse from a contact at (almost) the same location in the previous step
+  for (const ContactPoint &prev : m_vPrevContacts)
+  {
+    Vector3 da = prev.relPosA - contact.relPosA;
+    Vector3 db = prev.relPosB - contact.relPosB;
+
+    if (Vector3::Dot(da, da) < persistentThresholdSq && Vector3::Dot(db, db) < persistentThresholdSq)
+    {
+      contact.warmStartImpulse = prev.sumImpulseContact;
+      break;
+    }
+  }
 
   // Check to see if we already contain a contact point almost in that location
   const float min_allowed_dist_sq = 0.2f * 0.2f;
@@ -24,6 +24,7 @@ additional energy to the system or negate existing velocity.
 #pragma once
 
 #include "PhysicsObject.h"
+#include "SolverBody.h"
 #include <nclgl\Vector3.h>
 
 /* A contact constraint is actually the summation of a normal distance
@@ -36,8 +37,11 @@ struct ContactPoint
 {
   float sumImpulseContact;
   float sumImpulseFriction;
+  float warmStartImpulse; // Contact impulse accumulated on the matching contact in the previous step
 
   float elatisity_term;
+  float constraintMass; // Effective mass along the collision normal
+  float bias;           // Velocity bias from elasticity and penetration correction
 
   Vector3 collisionNormal;
   float collisionPenetration;
@@ -46,6 +50,33 @@ struct ContactPoint
   Vector3 relPosB; // Position relative to objectB
 };
 
+/**
+ * @brief Identifies a manifold between a pair of collision shapes on a pair of objects.
+ */
+struct ManifoldKey
+{
+  PhysicsObject *objA;     //!< First object
+  PhysicsObject *objB;     //!< Second object
+  ICollisionShape *shapeA; //!< Collision shape on first object
+  ICollisionShape *shapeB; //!< Collision shape on second object
+
+  /**
+   * @brief Defines a strict ordering on keys.
+   * @param other Key to compare to
+   * @return True if this key is ordered before other
+   */
+  bool operator<(const ManifoldKey &other) const
+  {
+    if (objA != other.objA)
+      return objA < other.objA;
+    if (objB != other.objB)
+      return objB < other.objB;
+    if (shapeA != other.shapeA)
+      return shapeA < other.shapeA;
+    return shapeB < other.shapeB;
+  }
+};
+
 class Manifold
 {
 public:
@@ -53,13 +84,15 @@ public:
   ~Manifold();
 
   // Initiate for collision pair
+  // - Contacts from the previous initiation are kept to warm start matching new contacts
   void Initiate(PhysicsObject *nodeA, PhysicsObject *nodeB);
 
   // Called whenever a new collision contact between A & B are found
   void AddContact(const Vector3 &globalOnA, const Vector3 &globalOnB, const Vector3 &_normal, const float &_penetration);
 
   // Sequentially solves each contact constraint
-  void ApplyImpulse();
+  // - Returns the magnitude of the largest impulse applied
+  float ApplyImpulse();
   void PreSolverStep(float dt);
 
   // Debug draws the manifold surface area
@@ -86,11 +119,22 @@ public:
   }
 
 protected:
-  void SolveContactPoint(ContactPoint &c);
-  void UpdateConstraint(ContactPoint &c);
+  float SolveContactPoint(ContactPoint &c);
+  void UpdateConstraint(ContactPoint &c, float dt);
+  void WarmStart(ContactPoint &c);
+
+  void LoadObjectBodies();
+  void StoreObjectBodies();
 
 protected:
   PhysicsObject *m_pNodeA;
   PhysicsObject *m_pNodeB;
+  SolverBody *m_pBodyA;     // Solver state of object A for the current step
+  SolverBody *m_pBodyB;     // Solver state of object B for the current step
+  SolverBody m_objectBodyA; // Solver state of object A when the engine has no solver body for it
+  SolverBody m_objectBodyB; // Solver state of object B when the engine has no solver body for it
+  float m_friction;         // Combined friction coefficient
+  float m_elasticity;       // Combined elasticity coefficient
   std::vector<ContactPoint> m_vContacts;
+  std::vector<ContactPoint> m_vPrevContacts; // Contacts from the previous physics step
 };
\ No newline at end of file
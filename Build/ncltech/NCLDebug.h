@@ -67,6 +67,11 @@ Note: All functions have an "<function>NDT" varient which refers to a 'non depth
 
 #pragma once
 
+#ifdef NCLTECH_HEADLESS
+// Headless builds have no renderer, debug drawing is compiled out and logging goes to the console
+#include "NCLDebugHeadless.h"
+#else
+
 #include <mutex>
 #include <nclgl\Matrix3.h>
 #include <nclgl\Matrix4.h>
@@ -227,4 +232,6 @@ protected:
   static GLuint m_glArray, m_glBuffer;
   static GLuint m_glFontTex;
   static size_t m_OffsetChars;
-};
\ No newline at end of file
+};
+
+#endif // NCLTECH_HEADLESS
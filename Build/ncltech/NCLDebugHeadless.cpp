@@ -0,0 +1,59 @@
+#include "NCLDebug.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+std::mutex NCLDebug::m_LogMutex;
+
+/**
+ * @brief Writes a formatted log entry to the console.
+ * @param colour Unused
+ * @param text Format string
+ */
+void NCLDebug::Log(const Vector3 &colour, const std::string text, ...)
+{
+  std::lock_guard<std::mutex> lock(m_LogMutex);
+
+  va_list args;
+  va_start(args, text);
+  vprintf(text.c_str(), args);
+  va_end(args);
+
+  printf("\n");
+}
+
+/**
+ * @brief Writes a formatted log entry to the console.
+ * @param text Format string
+ */
+void NCLDebug::Log(const std::string text, ...)
+{
+  std::lock_guard<std::mutex> lock(m_LogMutex);
+
+  va_list args;
+  va_start(args, text);
+  vprintf(text.c_str(), args);
+  va_end(args);
+
+  printf("\n");
+}
+
+/**
+ * @brief Writes a formatted error to the console, use NCLERROR() to fill in the source location.
+ * @param filename Source file the error was raised in
+ * @param linenumber Source line the error was raised on
+ * @param text Format string
+ */
+void NCLDebug::LogE(const char *filename, int linenumber, const std::string text, ...)
+{
+  std::lock_guard<std::mutex> lock(m_LogMutex);
+
+  fprintf(stderr, "[ERROR] %s:%d\n\t \"", filename, linenumber);
+
+  va_list args;
+  va_start(args, text);
+  vfprintf(stderr, text.c_str(), args);
+  va_end(args);
+
+  fprintf(stderr, "\"\n");
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <mutex>
+#include <nclgl\Matrix3.h>
+#include <nclgl\Matrix4.h>
+#include <nclgl\Vector3.h>
+#include <nclgl\Vector4.h>
+#include <string>
+
+enum TextAlignment
+{
+  TEXTALIGN_LEFT,
+  TEXTALIGN_RIGHT,
+  TEXTALIGN_CENTRE
+};
+
+#define NCLERROR(str, ...) NCLDebug::LogE(__FILE__, __LINE__, str, ##__VA_ARGS__)
+
+/**
+ * @class NCLDebug
+ * @author Dan Nixon
+ * @brief Replacement for NCLDebug used in headless (NCLTECH_HEADLESS) builds.
+ *
+ * Provides the same interface as the rendering version so that physics code can be built without OpenGL or a window.
+ * Drawing functions and status entries do nothing, log entries are written to the console.
+ */
+class NCLDebug
+{
+public:
+  static void DrawPoint(const Vector3 &, float, const Vector3 &)
+  {
+  }
+
+  static void DrawPoint(const Vector3 &, float, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawPointNDT(const Vector3 &, float, const Vector3 &)
+  {
+  }
+
+  static void DrawPointNDT(const Vector3 &, float, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawThickLine(const Vector3 &, const Vector3 &, float, const Vector3 &)
+  {
+  }
+
+  static void DrawThickLine(const Vector3 &, const Vector3 &, float, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawThickLineNDT(const Vector3 &, const Vector3 &, float, const Vector3 &)
+  {
+  }
+
+  static void DrawThickLineNDT(const Vector3 &, const Vector3 &, float, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawHairLine(const Vector3 &, const Vector3 &, const Vector3 &)
+  {
+  }
+
+  static void DrawHairLine(const Vector3 &, const Vector3 &, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawHairLineNDT(const Vector3 &, const Vector3 &, const Vector3 &)
+  {
+  }
+
+  static void DrawHairLineNDT(const Vector3 &, const Vector3 &, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawMatrix(const Matrix4 &)
+  {
+  }
+
+  static void DrawMatrix(const Matrix3 &, const Vector3 &)
+  {
+  }
+
+  static void DrawMatrixNDT(const Matrix4 &)
+  {
+  }
+
+  static void DrawMatrixNDT(const Matrix3 &, const Vector3 &)
+  {
+  }
+
+  static void DrawTriangle(const Vector3 &, const Vector3 &, const Vector3 &, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawTriangleNDT(const Vector3 &, const Vector3 &, const Vector3 &,
+                              const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawPolygon(int, const Vector3 *, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawPolygonNDT(int, const Vector3 *, const Vector4 & = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void DrawTextWs(const Vector3 &, const float, const TextAlignment, const Vector4, const std::string, ...)
+  {
+  }
+
+  static void DrawTextWsNDT(const Vector3 &, const float, const TextAlignment, const Vector4, const std::string, ...)
+  {
+  }
+
+  static void DrawTextCs(const Vector4 &, const float, const std::string &, const TextAlignment = TEXTALIGN_LEFT,
+                         const Vector4 = Vector4(1.0f, 1.0f, 1.0f, 1.0f))
+  {
+  }
+
+  static void AddStatusEntry(const Vector4 &, const std::string, ...)
+  {
+  }
+
+  static void Log(const Vector3 &colour, const std::string text, ...);
+  static void Log(const std::string text, ...);
+
+  static void LogE(const char *filename, int linenumber, const std::string text, ...);
+
+protected:
+  static std::mutex m_LogMutex; //!< Mutex guarding console output
+};
@@ -18,19 +18,22 @@ Object::~Object()
 {
   if (m_pPhysicsObject != NULL)
   {
-    PhysicsEngine::Instance()->RemovePhysicsObject(m_pPhysicsObject);
+    PhysicsEngine *world = m_pPhysicsObject->GetWorld();
+    if (world != nullptr)
+      world->RemovePhysicsObject(m_pPhysicsObject);
+
     delete m_pPhysicsObject;
     m_pPhysicsObject = NULL;
   }
 }
 
-void Object::CreatePhysicsNode()
+void Object::CreatePhysicsNode(PhysicsEngine *world)
 {
   if (m_pPhysicsObject == NULL)
   {
     m_pPhysicsObject = new PhysicsObject();
     m_pPhysicsObject->SetAssociatedObject(this);
-    PhysicsEngine::Instance()->AddPhysicsObject(m_pPhysicsObject);
+    ((world != nullptr) ? world : PhysicsEngine::Instance())->AddPhysicsObject(m_pPhysicsObject);
   }
 }
 
@@ -45,7 +45,8 @@ public:
   //<---------- PHYSICS ------------>
   // This function creates a new physics node for the object in question.
   // - MUST be called before setting any parameters with Physics()
-  void CreatePhysicsNode();
+  // - The node is added to the given world, or the default world if none is given
+  void CreatePhysicsNode(PhysicsEngine *world = nullptr);
 
   // Returns true if this object has a physicsObject attached
   bool HasPhysics()
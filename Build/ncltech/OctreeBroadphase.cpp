@@ -1,49 +1,121 @@
 #include "OctreeBroadphase.h"
 
+#include <algorithm>
+#include <cmath>
+
+using std::max;
+
 /**
  * @brief Creates a new octree broadphase instance.
  * @param maxObjectsPerPartition Target maximum number of objects in each world division
  * @param maxPartitionDepth Maximum recursion depth
- * @param secondaryBroadphase Broadphase method used to generate collision pairs in each division
+ * @param maxDivisions Size of the division pool (including the root)
  */
-OctreeBroadphase::OctreeBroadphase(size_t maxObjectsPerPartition, size_t maxPartitionDepth, IBroadphase *secondaryBroadphase)
+OctreeBroadphase::OctreeBroadphase(size_t maxObjectsPerPartition, size_t maxPartitionDepth, size_t maxDivisions)
     : m_maxObjectsPerPartition(maxObjectsPerPartition)
     , m_maxPartitionDepth(maxPartitionDepth)
-    , m_secondaryBroadphase(secondaryBroadphase)
+    , m_step(0)
+    , m_numRelocations(0)
 {
+  // Root followed by whole blocks of eight subdivisions
+  const size_t numBlocks = (max(maxDivisions, (size_t)1) - 1) / 8;
+  m_divisions.resize(1 + numBlocks * 8);
+
+  Clear();
 }
 
 OctreeBroadphase::~OctreeBroadphase()
 {
-  delete m_secondaryBroadphase;
+}
+
+/**
+ * @brief Removes all objects and subdivisions.
+ */
+void OctreeBroadphase::Clear()
+{
+  ResetDivisions();
+
+  m_entries.clear();
+  m_freeEntries.clear();
+  m_entryIndices.clear();
+  m_pairs.clear();
+}
+
+/**
+ * @brief Removes all subdivisions and all entries from the root, leaving the entry pool intact.
+ */
+void OctreeBroadphase::ResetDivisions()
+{
+  for (auto it = m_divisions.begin(); it != m_divisions.end(); ++it)
+  {
+    it->children = NULL_INDEX;
+    it->entries.clear();
+  }
+
+  m_divisions[0].centre = Vector3(0.0f, 0.0f, 0.0f);
+  m_divisions[0].halfSize = 0.0f;
+  m_divisions[0].depth = 0;
+  m_divisions[0].parent = NULL_INDEX;
+
+  m_freeBlocks.clear();
+  for (int block = (int)m_divisions.size() - 8; block >= 1; block -= 8)
+    m_freeBlocks.push_back(block);
 }
 
 /**
  * @copydoc IBroadphase::FindPotentialCollisionPairs
+ *
+ * Pairs where both objects are at rest are skipped. Pairs are output sorted by the indices of their objects in the object
+ * list, with the lower index as object A, so the output depends only on the objects and not on the layout of the octree.
  */
 void OctreeBroadphase::FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects,
                                                    std::vector<CollisionPair> &collisionPairs)
 {
-  // Delete old data
-  delete m_world;
-  m_leafDivisions.clear();
+  UpdateOctree(objects);
 
-  // Init root world space
-  m_world = new WorldDivision();
-  for (auto it = objects.begin(); it != objects.end(); ++it)
+  m_pairs.clear();
+  for (int entry : m_moved)
   {
-    PhysicsObject *o = *it;
-
-    m_world->box.ExpandToFit(o->GetWorldSpaceAABB());
-    m_world->objects.push_back(o);
+    QueryPairs(entry);
+    m_entries[entry].queryStep = m_step;
   }
 
-  // Recursively divide world
-  DivideWorld(m_world, 0);
+  AppendSortedPairs(objects, m_pairs, collisionPairs);
+}
+
+/**
+ * @copydoc IBroadphase::FindObjectsInBox
+ */
+void OctreeBroadphase::FindObjectsInBox(std::vector<PhysicsObject *> &objects, const BoundingBox &box,
+                                        std::vector<PhysicsObject *> &results)
+{
+  UpdateOctree(objects);
+
+  m_stack.clear();
+  m_stack.push_back(0);
+
+  while (!m_stack.empty())
+  {
+    const int division = m_stack.back();
+    m_stack.pop_back();
+
+    // Objects outside the root cell are kept in the root, so it is always searched
+    if (division != 0 && !LooseBounds(division).Intersects(box))
+      continue;
+
+    const WorldDivision &d = m_divisions[division];
+    for (int e : d.entries)
+    {
+      if (m_entries[e].aabb.Intersects(box))
+        results.push_back(m_entries[e].object);
+    }
 
-  // Add collision pairs in leaf world divisions
-  for (auto it = m_leafDivisions.begin(); it != m_leafDivisions.end(); ++it)
-    m_secondaryBroadphase->FindPotentialCollisionPairs((*it)->objects, collisionPairs);
+    if (d.children != NULL_INDEX)
+    {
+      for (int i = 0; i < 8; ++i)
+        m_stack.push_back(d.children + i);
+    }
+  }
 }
 
 /**
@@ -51,84 +123,418 @@ void OctreeBroadphase::FindPotentialCollisionPairs(std::vector<PhysicsObject *>
  */
 void OctreeBroadphase::DebugDraw()
 {
-  DebugDrawWorldDivision(m_world);
+  m_stack.clear();
+  m_stack.push_back(0);
+
+  while (!m_stack.empty())
+  {
+    const WorldDivision &d = m_divisions[m_stack.back()];
+    m_stack.pop_back();
+
+    // Draw division cell
+    const Vector3 halfDims(d.halfSize, d.halfSize, d.halfSize);
+    BoundingBox(d.centre - halfDims, d.centre + halfDims)
+        .DebugDraw(Matrix4(), Vector4(1.0f, 0.8f, 0.8f, 0.2f), Vector4(1.0f, 1.0f, 0.0f, 1.0f), 0.05f);
+
+    // Draw sub divisions
+    if (d.children != NULL_INDEX)
+    {
+      for (int i = 0; i < 8; ++i)
+        m_stack.push_back(d.children + i);
+    }
+  }
 }
 
 /**
- * @brief Recursively divides the world.
- * @param division Current division
- * @param iteration Iteration count
+ * @brief Synchronises the octree with the object list.
+ * @param objects All objects in scene
+ *
+ * New objects are inserted, objects no longer in the list are removed and objects that no longer fit in their division
+ * are relocated. Entries that need to query for pairs in this update are collected in m_moved.
  */
-void OctreeBroadphase::DivideWorld(WorldDivision *division, size_t iteration)
+void OctreeBroadphase::UpdateOctree(std::vector<PhysicsObject *> &objects)
 {
-  // Exit conditions (partition depth limit or target object count reached)
-  if (iteration > m_maxPartitionDepth || division->objects.size() <= m_maxObjectsPerPartition)
+  m_step++;
+  m_numRelocations = 0;
+  m_moved.clear();
+
+  // Size the root to the scene whenever the octree is empty
+  if (m_entryIndices.empty())
+    ResetRoot(objects);
+
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    PhysicsObject *obj = objects[i];
+    int entry;
+
+    auto it = m_entryIndices.find(obj);
+    if (it == m_entryIndices.end())
+    {
+      if (m_freeEntries.empty())
+      {
+        entry = (int)m_entries.size();
+        m_entries.push_back(Entry());
+      }
+      else
+      {
+        entry = m_freeEntries.back();
+        m_freeEntries.pop_back();
+      }
+
+      Entry &e = m_entries[entry];
+      e.object = obj;
+      e.aabb = obj->GetWorldSpaceAABB();
+      e.queryStep = 0;
+      InsertEntry(entry);
+
+      m_entryIndices[obj] = entry;
+      m_moved.push_back(entry);
+    }
+    else
+    {
+      entry = it->second;
+
+      Entry &e = m_entries[entry];
+      e.aabb = obj->GetWorldSpaceAABB();
+
+      // Relocate objects that have left their division or can move into a subdivision
+      const bool canDescend =
+          m_divisions[e.division].children != NULL_INDEX && ChildIndex(e.division, e.aabb) != NULL_INDEX;
+
+      if (canDescend || !Fits(e.division, e.aabb))
+      {
+        RemoveEntry(entry);
+        InsertEntry(entry);
+
+        m_numRelocations++;
+        m_moved.push_back(entry);
+      }
+      else if (!obj->IsAtRest())
+      {
+        m_moved.push_back(entry);
+      }
+    }
+
+    m_entries[entry].seenStep = m_step;
+    m_entries[entry].objectIndex = (uint32_t)i;
+  }
+
+  // Remove objects that are no longer in the scene (only possible if there are more entries than objects)
+  if (m_entryIndices.size() > objects.size())
+  {
+    for (auto it = m_entryIndices.begin(); it != m_entryIndices.end();)
+    {
+      if (m_entries[it->second].seenStep != m_step)
+      {
+        RemoveEntry(it->second);
+        m_entries[it->second].object = nullptr;
+        m_freeEntries.push_back(it->second);
+        it = m_entryIndices.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  // Rebuild around the whole scene once too many objects have left the root cell
+  const WorldDivision &root = m_divisions[0];
+  size_t numOutside = 0;
+  for (int entry : root.entries)
   {
-    // Ignore any subdivisions that contain no objects
-    if (!division->objects.empty())
-      m_leafDivisions.push_back(division);
+    const Vector3 centre = m_entries[entry].aabb.Centre();
+    if (fabs(centre.x - root.centre.x) > root.halfSize || fabs(centre.y - root.centre.y) > root.halfSize ||
+        fabs(centre.z - root.centre.z) > root.halfSize)
+      numOutside++;
+  }
+
+  if (numOutside > m_maxObjectsPerPartition)
+    Rebuild(objects);
+}
+
+/**
+ * @brief Resizes the root cell to fit all objects and reinserts every entry.
+ * @param objects All objects in scene
+ *
+ * Object positions are unchanged so the entries that query for pairs in this update stay the same.
+ */
+void OctreeBroadphase::Rebuild(std::vector<PhysicsObject *> &objects)
+{
+  ResetDivisions();
+  ResetRoot(objects);
 
+  for (auto it = m_entryIndices.begin(); it != m_entryIndices.end(); ++it)
+    InsertEntry(it->second);
+}
+
+/**
+ * @brief Sets the root cell to the smallest cube containing all objects.
+ * @param objects All objects in scene
+ *
+ * Objects that later move outside of the root cell are stored in the root until the octree is rebuilt.
+ */
+void OctreeBroadphase::ResetRoot(std::vector<PhysicsObject *> &objects)
+{
+  if (objects.empty())
     return;
+
+  BoundingBox world;
+  for (PhysicsObject *obj : objects)
+    world.ExpandToFit(obj->GetWorldSpaceAABB());
+
+  const Vector3 dims = world.Upper() - world.Lower();
+
+  m_divisions[0].centre = world.Centre();
+  m_divisions[0].halfSize = 0.5f * max(dims.x, max(dims.y, dims.z));
+}
+
+/**
+ * @brief Stores an entry in the deepest division it fits in, subdividing full divisions on the way down.
+ * @param entry Index of the entry
+ */
+void OctreeBroadphase::InsertEntry(int entry)
+{
+  const BoundingBox &aabb = m_entries[entry].aabb;
+  int division = 0;
+
+  while (true)
+  {
+    const int index = ChildIndex(division, aabb);
+    if (index == NULL_INDEX)
+      break;
+
+    if (m_divisions[division].children == NULL_INDEX)
+    {
+      // Subdivide full divisions
+      const WorldDivision &d = m_divisions[division];
+      if (d.entries.size() < m_maxObjectsPerPartition || d.depth >= m_maxPartitionDepth)
+        break;
+
+      if (!DivideWorld(division))
+        break;
+    }
+
+    division = m_divisions[division].children + index;
+  }
+
+  m_divisions[division].entries.push_back(entry);
+  m_entries[entry].division = division;
+}
+
+/**
+ * @brief Removes an entry from its division, freeing subdivisions that are no longer used.
+ * @param entry Index of the entry
+ */
+void OctreeBroadphase::RemoveEntry(int entry)
+{
+  const int division = m_entries[entry].division;
+  std::vector<int> &entries = m_divisions[division].entries;
+
+  auto it = std::find(entries.begin(), entries.end(), entry);
+  *it = entries.back();
+  entries.pop_back();
+
+  if (entries.empty())
+    Prune((m_divisions[division].children == NULL_INDEX) ? m_divisions[division].parent : division);
+}
+
+/**
+ * @brief Subdivides a division into eight, moving objects that fit into the subdivisions.
+ * @param division Index of the division
+ * @return True if the division was subdivided, false if the division pool is exhausted
+ */
+bool OctreeBroadphase::DivideWorld(int division)
+{
+  if (m_freeBlocks.empty())
+    return false;
+
+  const int block = m_freeBlocks.back();
+  m_freeBlocks.pop_back();
+
+  const float childHalfSize = 0.5f * m_divisions[division].halfSize;
+
+  for (int i = 0; i < 8; ++i)
+  {
+    WorldDivision &child = m_divisions[block + i];
+    child.centre = m_divisions[division].centre + Vector3((i & 1) ? childHalfSize : -childHalfSize,
+                                                          (i & 2) ? childHalfSize : -childHalfSize,
+                                                          (i & 4) ? childHalfSize : -childHalfSize);
+    child.halfSize = childHalfSize;
+    child.depth = m_divisions[division].depth + 1;
+    child.parent = division;
+    child.children = NULL_INDEX;
+    child.entries.clear();
   }
 
-  Vector3 divisionPoints[] = {division->box.Lower(), division->box.Centre(), division->box.Upper()};
-
-  // clang-format off
-  static const size_t NUM_DIVISIONS = 8;
-  static const size_t DIVISION_POINT_INDICES[NUM_DIVISIONS][6] = {
-    {0, 0, 0, 1, 1, 1},
-    {1, 0, 0, 2, 1, 1},
-    {0, 1, 0, 1, 2, 1},
-    {1, 1, 0, 2, 2, 1},
-    {0, 0, 1, 1, 1, 2},
-    {1, 0, 1, 2, 1, 2},
-    {0, 1, 1, 1, 2, 2},
-    {1, 1, 1, 2, 2, 2}
-  };
-  // clang-format on
-
-  // Create new world divisions
-  for (size_t i = 0; i < NUM_DIVISIONS; i++)
+  m_divisions[division].children = block;
+
+  // Move objects into subdivisions
+  std::vector<int> &entries = m_divisions[division].entries;
+  for (size_t i = 0; i < entries.size();)
   {
-    WorldDivision *newDivision = new WorldDivision();
-
-    // Set bounds
-    // clang-format off
-    Vector3 lower(divisionPoints[DIVISION_POINT_INDICES[i][0]].x,
-                  divisionPoints[DIVISION_POINT_INDICES[i][1]].y,
-                  divisionPoints[DIVISION_POINT_INDICES[i][2]].z);
-    Vector3 upper(divisionPoints[DIVISION_POINT_INDICES[i][3]].x,
-                  divisionPoints[DIVISION_POINT_INDICES[i][4]].y,
-                  divisionPoints[DIVISION_POINT_INDICES[i][5]].z);
-    // clang-format on
-
-    newDivision->box = BoundingBox(lower, upper);
-
-    // Add objects inside division
-    for (auto it = division->objects.begin(); it != division->objects.end(); ++it)
+    const int index = ChildIndex(division, m_entries[entries[i]].aabb);
+    if (index != NULL_INDEX)
+    {
+      const int child = block + index;
+      m_divisions[child].entries.push_back(entries[i]);
+      m_entries[entries[i]].division = child;
+
+      entries[i] = entries.back();
+      entries.pop_back();
+    }
+    else
     {
-      if (newDivision->box.Intersects((*it)->GetWorldSpaceAABB()))
-        newDivision->objects.push_back(*it);
+      ++i;
     }
+  }
+
+  return true;
+}
 
-    // Add to parent division
-    division->subdivisions.push_back(newDivision);
+/**
+ * @brief Frees the subdivisions of a division and its ancestors while all subdivisions are empty.
+ * @param division Index of the first division to test
+ */
+void OctreeBroadphase::Prune(int division)
+{
+  while (division != NULL_INDEX)
+  {
+    WorldDivision &d = m_divisions[division];
+    if (d.children == NULL_INDEX)
+      return;
 
-    // Do further subdivisioning
-    DivideWorld(newDivision, iteration + 1);
+    for (int i = 0; i < 8; ++i)
+    {
+      const WorldDivision &child = m_divisions[d.children + i];
+      if (child.children != NULL_INDEX || !child.entries.empty())
+        return;
+    }
+
+    m_freeBlocks.push_back(d.children);
+    d.children = NULL_INDEX;
+
+    if (!d.entries.empty())
+      return;
+
+    division = d.parent;
   }
 }
 
 /**
- * @brief Recursively draws world partitions.
- * @param division Root world division
+ * @brief Tests if an AABB can be stored in a division.
+ * @param division Index of the division
+ * @param aabb World space AABB
+ * @return True if the AABB centre is inside the division cell and the AABB is no larger than the cell
+ *
+ * Everything fits in the root.
+ */
+bool OctreeBroadphase::Fits(int division, const BoundingBox &aabb) const
+{
+  if (division == 0)
+    return true;
+
+  const WorldDivision &d = m_divisions[division];
+  const Vector3 centre = aabb.Centre();
+  const Vector3 halfDims = (aabb.Upper() - aabb.Lower()) * 0.5f;
+
+  if (max(halfDims.x, max(halfDims.y, halfDims.z)) > d.halfSize)
+    return false;
+
+  return fabs(centre.x - d.centre.x) <= d.halfSize && fabs(centre.y - d.centre.y) <= d.halfSize &&
+         fabs(centre.z - d.centre.z) <= d.halfSize;
+}
+
+/**
+ * @brief Gets the subdivision of a division an AABB should be stored in.
+ * @param division Index of the division
+ * @param aabb World space AABB
+ * @return Index of the subdivision within the block of eight (whether or not the division is subdivided), NULL_INDEX if
+ *         the AABB does not fit in a subdivision
  */
-void OctreeBroadphase::DebugDrawWorldDivision(WorldDivision *division)
+int OctreeBroadphase::ChildIndex(int division, const BoundingBox &aabb) const
 {
-  // Draw bounding box
-  division->box.DebugDraw(Matrix4(), Vector4(1.0f, 0.8f, 0.8f, 0.2f), Vector4(1.0f, 1.0f, 0.0f, 1.0f), 0.05f);
+  const WorldDivision &d = m_divisions[division];
+  const Vector3 centre = aabb.Centre();
+
+  int index = 0;
+  if (centre.x >= d.centre.x)
+    index |= 1;
+  if (centre.y >= d.centre.y)
+    index |= 2;
+  if (centre.z >= d.centre.z)
+    index |= 4;
+
+  // Test against the cell the subdivision would have if it does not exist yet
+  const float childHalfSize = 0.5f * d.halfSize;
+  const Vector3 childCentre = d.centre + Vector3((index & 1) ? childHalfSize : -childHalfSize,
+                                                 (index & 2) ? childHalfSize : -childHalfSize,
+                                                 (index & 4) ? childHalfSize : -childHalfSize);
+  const Vector3 halfDims = (aabb.Upper() - aabb.Lower()) * 0.5f;
+
+  if (max(halfDims.x, max(halfDims.y, halfDims.z)) > childHalfSize)
+    return NULL_INDEX;
 
-  // Draw sub divisions
-  for (auto it = division->subdivisions.begin(); it != division->subdivisions.end(); ++it)
-    DebugDrawWorldDivision(*it);
+  if (fabs(centre.x - childCentre.x) > childHalfSize || fabs(centre.y - childCentre.y) > childHalfSize ||
+      fabs(centre.z - childCentre.z) > childHalfSize)
+    return NULL_INDEX;
+
+  return index;
+}
+
+/**
+ * @brief Gets the loose bounds of a division, the division cell expanded to twice its size.
+ * @param division Index of the division
+ * @return Loose bounds
+ */
+BoundingBox OctreeBroadphase::LooseBounds(int division) const
+{
+  const WorldDivision &d = m_divisions[division];
+  const Vector3 halfDims(2.0f * d.halfSize, 2.0f * d.halfSize, 2.0f * d.halfSize);
+  return BoundingBox(d.centre - halfDims, d.centre + halfDims);
+}
+
+/**
+ * @brief Reports every object overlapping the object of an entry, except objects that have already queried this update.
+ * @param entry Index of the entry
+ *
+ * Pairs found are appended to m_pairs.
+ */
+void OctreeBroadphase::QueryPairs(int entry)
+{
+  const Entry &e = m_entries[entry];
+
+  m_stack.clear();
+  m_stack.push_back(0);
+
+  while (!m_stack.empty())
+  {
+    const int division = m_stack.back();
+    m_stack.pop_back();
+
+    // Objects outside the root cell are kept in the root, so it is always searched
+    if (division != 0 && !LooseBounds(division).Intersects(e.aabb))
+      continue;
+
+    const WorldDivision &d = m_divisions[division];
+    for (int other : d.entries)
+    {
+      // Pairs with objects that have already queried were reported by that object
+      if (other == entry || m_entries[other].queryStep == m_step)
+        continue;
+
+      // Skip pairs of two at rest objects, which would otherwise only be found after one of them was relocated
+      if (e.object->IsAtRest() && m_entries[other].object->IsAtRest())
+        continue;
+
+      if (m_entries[other].aabb.Intersects(e.aabb))
+        m_pairs.push_back(PairKey(e.objectIndex, m_entries[other].objectIndex));
+    }
+
+    if (d.children != NULL_INDEX)
+    {
+      for (int i = 0; i < 8; ++i)
+        m_stack.push_back(d.children + i);
+    }
+  }
 }
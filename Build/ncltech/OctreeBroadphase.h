@@ -4,48 +4,127 @@
 
 #include "BoundingBox.h"
 
+#include <unordered_map>
+
 /**
  * @class OctreeBroadphase
  * @author Dan Nixon
- * @brief Broadphase culling using octree method.
+ * @brief Broadphase culling using a persistent loose octree.
+ *
+ * Each object is stored in exactly one division, the deepest existing division whose cell contains the centre of the object
+ * AABB and is at least as large as the AABB. Divisions are queried with loose bounds twice the size of their cell, so an
+ * object can never extend outside the loose bounds of its division. Objects that leave the root cell are kept in the root
+ * and the octree is rebuilt around the whole scene once too many have done so.
+ *
+ * The octree persists between steps and only objects that have left their division are relocated. Divisions are split
+ * once they hold more than the target number of objects and are taken from a pool allocated on construction, if the pool
+ * runs out objects are kept in the deepest available division. Only objects that are awake (or were relocated) query the
+ * octree for pairs and each pair is reported once. Pairs are reported in the order of the object list (as with
+ * BruteForceBroadphase) rather than in traversal order.
  */
 class OctreeBroadphase : public IBroadphase
 {
 public:
+  /**
+   * @brief Value of a node or entry index that does not refer to anything.
+   */
+  static const int NULL_INDEX = -1;
+
   /**
    * @brief Stores data relating to a subdivision of the world space.
    */
   struct WorldDivision
   {
-    ~WorldDivision()
-    {
-      // Delete all subdivisions
-      for (auto it = subdivisions.begin(); it != subdivisions.end(); ++it)
-        delete *it;
-    }
-
-    BoundingBox box;                           //!< Division bounding box
-    std::vector<PhysicsObject *> objects;      //!< Objects withing this division
-    std::vector<WorldDivision *> subdivisions; //!< Subdivisions within this division
+    Vector3 centre;           //!< Centre of the division cell
+    float halfSize;           //!< Half of the side length of the division cell
+    size_t depth;             //!< Depth of the division in the octree (0 for the root)
+    int parent;               //!< Index of the parent division
+    int children;             //!< Index of the first of the eight subdivisions, NULL_INDEX if not subdivided
+    std::vector<int> entries; //!< Entries of objects stored in this division
+  };
+
+  /**
+   * @brief Stores the placement of a single object.
+   */
+  struct Entry
+  {
+    PhysicsObject *object; //!< Object, nullptr for free entries
+    uint32_t objectIndex;  //!< Index of the object in the object list of the last update
+    BoundingBox aabb;      //!< World space AABB of the object in the current step
+    int division;          //!< Index of the division the object is stored in
+    size_t seenStep;       //!< Last step the object was present in the object list
+    size_t queryStep;      //!< Last step the object queried for pairs
   };
 
 public:
-  OctreeBroadphase(size_t maxObjectsPerPartition, size_t maxPartitionDepth, IBroadphase *secondaryBroadphase);
+  OctreeBroadphase(size_t maxObjectsPerPartition, size_t maxPartitionDepth, size_t maxDivisions = 4097);
   virtual ~OctreeBroadphase();
 
+  /**
+   * @brief Gets the number of objects in the octree.
+   * @return Object count
+   */
+  inline size_t NumObjects() const
+  {
+    return m_entryIndices.size();
+  }
+
+  /**
+   * @brief Gets the number of divisions currently in use (including the root).
+   * @return Division count
+   */
+  inline size_t NumDivisions() const
+  {
+    return m_divisions.size() - m_freeBlocks.size() * 8;
+  }
+
+  /**
+   * @brief Gets the number of objects relocated in the last update.
+   * @return Relocation count
+   */
+  inline size_t NumRelocations() const
+  {
+    return m_numRelocations;
+  }
+
+  virtual void Clear();
+
   virtual void FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects, std::vector<CollisionPair> &collisionPairs);
+  virtual void FindObjectsInBox(std::vector<PhysicsObject *> &objects, const BoundingBox &box,
+                                std::vector<PhysicsObject *> &results);
   virtual void DebugDraw();
 
 protected:
-  void DivideWorld(WorldDivision *division, size_t iteration);
-  void DebugDrawWorldDivision(WorldDivision *division);
+  void UpdateOctree(std::vector<PhysicsObject *> &objects);
+  void ResetRoot(std::vector<PhysicsObject *> &objects);
+  void Rebuild(std::vector<PhysicsObject *> &objects);
+  void ResetDivisions();
+
+  void InsertEntry(int entry);
+  void RemoveEntry(int entry);
+  bool DivideWorld(int division);
+  void Prune(int division);
+
+  bool Fits(int division, const BoundingBox &aabb) const;
+  int ChildIndex(int division, const BoundingBox &aabb) const;
+  BoundingBox LooseBounds(int division) const;
+
+  void QueryPairs(int entry);
 
 protected:
-  size_t m_maxObjectsPerPartition; //!< Maximum number of objects in a single world partition before subdivision
-  size_t m_maxPartitionDepth;      //!< Maximum number of sub world partitions to recursively create
+  size_t m_maxObjectsPerPartition; //!< Number of objects in a division before it is subdivided
+  size_t m_maxPartitionDepth;      //!< Maximum depth of subdivision
+
+  std::vector<WorldDivision> m_divisions; //!< Division pool, root followed by blocks of eight subdivisions
+  std::vector<int> m_freeBlocks;          //!< Indices of the first division of each free block in the pool
 
-  IBroadphase *m_secondaryBroadphase; //!< Broadphase stage used to determine collision pairs within subdivisions
+  std::vector<Entry> m_entries;                            //!< Entry pool
+  std::vector<int> m_freeEntries;                          //!< Indices of free entries in the pool
+  std::unordered_map<PhysicsObject *, int> m_entryIndices; //!< Entry of each object in the octree
 
-  WorldDivision *m_world;                       //!< Root world space
-  std::vector<WorldDivision *> m_leafDivisions; //!< Subdivisions containing objects to generate collision pairs for
+  size_t m_step;                 //!< Counter of octree updates, used to stamp entries
+  size_t m_numRelocations;       //!< Number of objects relocated in the last update
+  std::vector<int> m_moved;      //!< Entries of objects that query the octree for pairs in the current update
+  std::vector<int> m_stack;      //!< Traversal stack
+  std::vector<uint64_t> m_pairs; //!< Object list indices of the pairs found in the current update
 };
@@ -0,0 +1,123 @@
+#include "PhysicsBodyStore.h"
+
+#include "PhysicsObject.h"
+
+/**
+ * @brief Creates a new empty body store.
+ */
+PhysicsBodyStore::PhysicsBodyStore()
+{
+}
+
+PhysicsBodyStore::~PhysicsBodyStore()
+{
+  Clear();
+}
+
+/**
+ * @brief Moves the motion state of an object into the store.
+ * @param obj Object to add
+ * @return Handle to the new body
+ *
+ * Once added, the accessors of the object read and write the arrays in this store.
+ */
+BodyHandle PhysicsBodyStore::Add(PhysicsObject *obj)
+{
+  // Allocate a handle, reusing a freed one if possible
+  BodyHandle handle;
+  if (m_freeHandles.empty())
+  {
+    handle = (BodyHandle)m_handleIndices.size();
+    m_handleIndices.push_back(0);
+  }
+  else
+  {
+    handle = m_freeHandles.back();
+    m_freeHandles.pop_back();
+  }
+
+  m_handleIndices[handle] = m_bodies.size();
+  m_indexHandles.push_back(handle);
+  m_bodies.push_back(obj);
+
+  // Copy the current state of the object
+  m_positions.push_back(obj->m_position);
+  m_linearVelocities.push_back(obj->m_linearVelocity);
+  m_linearForces.push_back(obj->m_linearForce);
+  m_inverseMasses.push_back(obj->m_inverseMass);
+  m_orientations.push_back(obj->m_orientation);
+  m_angularVelocities.push_back(obj->m_angularVelocity);
+  m_torques.push_back(obj->m_torque);
+  m_inverseInertias.push_back(obj->m_inverseInertia);
+
+  obj->m_bodyStore = this;
+  obj->m_bodyHandle = handle;
+
+  return handle;
+}
+
+/**
+ * @brief Moves the motion state of a body back into its object and removes it from the store.
+ * @param handle Handle of the body to remove
+ */
+void PhysicsBodyStore::Remove(BodyHandle handle)
+{
+  size_t idx = m_handleIndices[handle];
+  size_t last = m_bodies.size() - 1;
+
+  // Return state to the object
+  PhysicsObject *obj = m_bodies[idx];
+  obj->m_position = m_positions[idx];
+  obj->m_linearVelocity = m_linearVelocities[idx];
+  obj->m_linearForce = m_linearForces[idx];
+  obj->m_inverseMass = m_inverseMasses[idx];
+  obj->m_orientation = m_orientations[idx];
+  obj->m_angularVelocity = m_angularVelocities[idx];
+  obj->m_torque = m_torques[idx];
+  obj->m_inverseInertia = m_inverseInertias[idx];
+  obj->m_bodyStore = nullptr;
+  obj->m_bodyHandle = INVALID_BODY_HANDLE;
+
+  // Move the last body into the freed slot
+  if (idx != last)
+  {
+    m_bodies[idx] = m_bodies[last];
+    m_indexHandles[idx] = m_indexHandles[last];
+    m_handleIndices[m_indexHandles[idx]] = idx;
+
+    m_positions[idx] = m_positions[last];
+    m_linearVelocities[idx] = m_linearVelocities[last];
+    m_linearForces[idx] = m_linearForces[last];
+    m_inverseMasses[idx] = m_inverseMasses[last];
+    m_orientations[idx] = m_orientations[last];
+    m_angularVelocities[idx] = m_angularVelocities[last];
+    m_torques[idx] = m_torques[last];
+    m_inverseInertias[idx] = m_inverseInertias[last];
+  }
+
+  m_bodies.pop_back();
+  m_indexHandles.pop_back();
+
+  m_positions.pop_back();
+  m_linearVelocities.pop_back();
+  m_linearForces.pop_back();
+  m_inverseMasses.pop_back();
+  m_orientations.pop_back();
+  m_angularVelocities.pop_back();
+  m_torques.pop_back();
+  m_inverseInertias.pop_back();
+
+  m_freeHandles.push_back(handle);
+}
+
+/**
+ * @brief Removes all bodies from the store, returning their state to the owning objects.
+ */
+void PhysicsBodyStore::Clear()
+{
+  while (!m_bodies.empty())
+    Remove(m_indexHandles.back());
+
+  m_handleIndices.clear();
+  m_freeHandles.clear();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <nclgl\Matrix3.h>
+#include <nclgl\Quaternion.h>
+#include <nclgl\Vector3.h>
+#include <stdint.h>
+#include <vector>
+
+class PhysicsObject;
+
+/**
+ * @brief Stable handle to a body in a PhysicsBodyStore.
+ */
+typedef uint32_t BodyHandle;
+
+/**
+ * @brief Value of a BodyHandle that does not refer to any body.
+ */
+static const BodyHandle INVALID_BODY_HANDLE = 0xFFFFFFFF;
+
+/**
+ * @class PhysicsBodyStore
+ * @author Dan Nixon
+ * @brief Structure of arrays storage for the motion state of rigid bodies.
+ *
+ * Each property is held in its own contiguous array, indexed by a dense body index. Bodies are referred to externally by
+ * a handle that remains valid while the body is in the store; removal swaps the last body into the freed slot so the
+ * arrays never contain holes.
+ */
+class PhysicsBodyStore
+{
+  friend class PhysicsEngine;
+  friend class PhysicsObject;
+  friend class BatchIntegrator;
+
+public:
+  PhysicsBodyStore();
+  virtual ~PhysicsBodyStore();
+
+  BodyHandle Add(PhysicsObject *obj);
+  void Remove(BodyHandle handle);
+  void Clear();
+
+  /**
+   * @brief Gets the number of bodies in the store.
+   * @return Body count
+   */
+  inline size_t Size() const
+  {
+    return m_bodies.size();
+  }
+
+  /**
+   * @brief Gets the dense array index of a body.
+   * @param handle Body handle
+   * @return Array index
+   */
+  inline size_t Index(BodyHandle handle) const
+  {
+    return m_handleIndices[handle];
+  }
+
+  /**
+   * @brief Gets the object that owns the body at a given array index.
+   * @param idx Array index
+   * @return Owning physics object
+   */
+  inline PhysicsObject *BodyAt(size_t idx) const
+  {
+    return m_bodies[idx];
+  }
+
+protected:
+  std::vector<PhysicsObject *> m_bodies;  //!< Object owning the body at each index
+  std::vector<BodyHandle> m_indexHandles; //!< Handle of the body at each index
+  std::vector<size_t> m_handleIndices;    //!< Array index of each allocated handle
+  std::vector<BodyHandle> m_freeHandles;  //!< Handles available for reuse
+
+  std::vector<Vector3> m_positions;        //!< Body positions
+  std::vector<Vector3> m_linearVelocities; //!< Body linear velocities
+  std::vector<Vector3> m_linearForces;     //!< Body linear forces
+  std::vector<float> m_inverseMasses;      //!< Body inverse masses
+
+  std::vector<Quaternion> m_orientations;   //!< Body orientations
+  std::vector<Vector3> m_angularVelocities; //!< Body angular velocities
+  std::vector<Vector3> m_torques;           //!< Body torques
+  std::vector<Matrix3> m_inverseInertias;   //!< Body inverse inertia matrices
+};
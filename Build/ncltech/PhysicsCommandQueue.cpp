@@ -0,0 +1,64 @@
+#include "PhysicsCommandQueue.h"
+
+/**
+ * @brief Creates a new, empty queue.
+ */
+PhysicsCommandQueue::PhysicsCommandQueue()
+{
+  Node *placeholder = new Node();
+  placeholder->next.store(nullptr, std::memory_order_relaxed);
+
+  m_head.store(placeholder, std::memory_order_relaxed);
+  m_tail = placeholder;
+}
+
+/**
+ * @brief Destroys the queue, discarding any commands that were not popped.
+ *
+ * No pushes may be in progress.
+ */
+PhysicsCommandQueue::~PhysicsCommandQueue()
+{
+  PhysicsCommand command;
+  while (Pop(command))
+    ;
+
+  delete m_tail;
+}
+
+/**
+ * @brief Adds a command to the back of the queue, may be called from any thread.
+ * @param command Command to add
+ */
+void PhysicsCommandQueue::Push(PhysicsCommand command)
+{
+  Node *node = new Node();
+  node->next.store(nullptr, std::memory_order_relaxed);
+  node->command = std::move(command);
+
+  // Claim the head, then link the previous head to the new node to publish it to the consumer
+  Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+/**
+ * @brief Removes the command at the front of the queue, may only be called by the consumer.
+ * @param command Destination for the removed command
+ * @return False if the queue was empty
+ */
+bool PhysicsCommandQueue::Pop(PhysicsCommand &command)
+{
+  Node *tail = m_tail;
+  Node *next = tail->next.load(std::memory_order_acquire);
+
+  if (next == nullptr)
+    return false;
+
+  // The popped node becomes the new placeholder
+  command = std::move(next->command);
+  next->command = nullptr;
+  m_tail = next;
+
+  delete tail;
+  return true;
+}
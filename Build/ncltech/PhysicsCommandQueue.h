@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+class PhysicsEngine;
+
+/**
+ * @brief Deferred mutation of a world, invoked with the world it was queued on.
+ */
+typedef std::function<void(PhysicsEngine &)> PhysicsCommand;
+
+/**
+ * @class PhysicsCommandQueue
+ * @author Dan Nixon
+ * @brief Lock free multiple producer, single consumer FIFO queue of physics commands.
+ *
+ * Any number of threads may Push() concurrently, only the thread stepping the simulation may Pop(). Producers never
+ * block or spin: a push is a single atomic exchange followed by a store. A command whose push is still in progress when
+ * the consumer reaches it is left for the next Pop() (i.e. the next step boundary).
+ */
+class PhysicsCommandQueue
+{
+public:
+  PhysicsCommandQueue();
+  virtual ~PhysicsCommandQueue();
+
+  void Push(PhysicsCommand command);
+  bool Pop(PhysicsCommand &command);
+
+  /**
+   * @brief Checks if the queue holds any completely pushed commands, may only be called by the consumer.
+   * @return True if the queue is empty
+   */
+  inline bool IsEmpty() const
+  {
+    return m_tail->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+protected:
+  /**
+   * @brief Link in the queue, the node at the tail is a placeholder whose command has already been popped.
+   */
+  struct Node
+  {
+    std::atomic<Node *> next; //!< Next (newer) node, nullptr for the most recently pushed node
+    PhysicsCommand command;   //!< Queued command
+  };
+
+protected:
+  std::atomic<Node *> m_head; //!< Most recently pushed node, exchanged by producers
+  Node *m_tail;               //!< Placeholder before the oldest queued node, only accessed by the consumer
+};
@@ -5,9 +5,13 @@
 #include "NCLDebug.h"
 #include "Object.h"
 #include <algorithm>
-#include <nclgl\Window.h>
+#include <nclgl\GameTimer.h>
 #include <omp.h>
 
+#ifndef NCLTECH_HEADLESS
+#include <nclgl\Window.h>
+#endif
+
 /**
  * @brief Sets default engine settings.
  */
@@ -20,7 +24,18 @@ void PhysicsEngine::SetDefaults()
   m_LinearGravity = Vector3(0.0f, -9.81f, 0.0f);
   m_PointGravity = -9.81f;
   m_PointGravitation = 6.674e-11f;
+  m_nBodyGravityEnabled = false;
+  m_nBodyOpeningAngle = 0.5f;
+  m_nBodySoftening = 0.1f;
   m_integrationType = INTEGRATION_SEMI_IMPLICIT_EULER;
+  m_warmStartingEnabled = true;
+  m_islandSolvingEnabled = true;
+  m_islandSleepingEnabled = true;
+  m_solverType = SOLVER_SEQUENTIAL;
+  m_minSolverIterations = SOLVER_MIN_ITERATIONS;
+  m_maxSolverIterations = SOLVER_ITERATIONS;
+  m_solverConvergenceThreshold = SOLVER_CONVERGENCE_THRESHOLD;
+  m_profilingEnabled = true;
 }
 
 /**
@@ -29,26 +44,102 @@ void PhysicsEngine::SetDefaults()
  * (handled by singleton)
  */
 PhysicsEngine::PhysicsEngine()
-    : m_broadphaseDetection(nullptr)
+    : m_stepCount(0)
+    , m_physicsThreadRunFlag(false)
+    , m_broadphaseDetection(nullptr)
+    , m_bodyStoreEnabled(false)
+    , m_batchIntegrationEnabled(false)
+    , m_lastStepSolverIterations(0)
+    , m_solverIterationCount(0)
+    , m_numIslands(0)
 {
+  m_lastStepProfile.Reset();
+  m_updateProfile.Reset();
+
   SetDefaults();
 }
 
 PhysicsEngine::~PhysicsEngine()
 {
+  StopPhysicsThread();
   RemoveAllPhysicsObjects();
 
   if (m_broadphaseDetection != nullptr)
     delete m_broadphaseDetection;
 }
 
+/**
+ * @brief Updates several worlds at the same time.
+ * @param worlds Worlds to update
+ * @param deltaTime Time passed in seconds
+ *
+ * Worlds are distributed over OpenMP threads, parallel stages within each world then run on a single thread.
+ */
+void PhysicsEngine::UpdateWorlds(const std::vector<PhysicsEngine *> &worlds, float deltaTime)
+{
+  const int numWorlds = (int)worlds.size();
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int i = 0; i < numWorlds; ++i)
+    worlds[i]->Update(deltaTime);
+}
+
+/**
+ * @brief Performs a fixed number of physics steps in each of several worlds as fast as possible.
+ * @param worlds Worlds to step
+ * @param numSteps Number of steps to perform in each world
+ * @return Stats for each world, in the same order as worlds
+ *
+ * Worlds are distributed over OpenMP threads, parallel stages within each world then run on a single thread. See
+ * Step().
+ */
+std::vector<WorldStepStats> PhysicsEngine::StepWorlds(const std::vector<PhysicsEngine *> &worlds, size_t numSteps)
+{
+  std::vector<WorldStepStats> stats(worlds.size());
+  const int numWorlds = (int)worlds.size();
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int i = 0; i < numWorlds; ++i)
+    stats[i] = worlds[i]->Step(numSteps);
+
+  return stats;
+}
+
 /**
  * @brief Adds a new object to the simulation.
  * @param obj Object to add
+ *
+ * An object that is in another world is removed from it first.
  */
 void PhysicsEngine::AddPhysicsObject(PhysicsObject *obj)
 {
+  // Ignore objects that are already in the simulation
+  if (obj->m_world == this)
+    return;
+
+  // Leave the previous world before locking this one, so moves between worlds in opposite directions cannot deadlock
+  if (obj->m_world != nullptr)
+    obj->m_world->RemovePhysicsObject(obj);
+
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+
+  obj->m_world = this;
+
+  Object *parent = obj->GetAssociatedObject();
+  obj->m_handle = m_registry.Add(obj, (parent != nullptr) ? parent->GetName() : std::string());
+
+  obj->m_stepIndex = m_PhysicsObjects.size();
   m_PhysicsObjects.push_back(obj);
+
+  if (m_bodyStoreEnabled)
+    m_bodyStore.Add(obj);
+
+  // Objects added while threaded are rendered at their initial transform until the next step is published
+  if (m_physicsThreadRunFlag)
+  {
+    std::lock_guard<std::mutex> snapshotLock(m_snapshotMutex);
+    obj->StoreSnapshot(false);
+  }
 }
 
 /**
@@ -57,12 +148,83 @@ void PhysicsEngine::AddPhysicsObject(PhysicsObject *obj)
  */
 void PhysicsEngine::RemovePhysicsObject(PhysicsObject *obj)
 {
-  // Lookup the object in question
-  auto it = std::find(m_PhysicsObjects.begin(), m_PhysicsObjects.end(), obj);
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+
+  if (obj->m_world != this || !m_registry.Remove(obj->m_handle))
+    return;
+
+  obj->m_world = nullptr;
+  obj->m_handle = INVALID_OBJECT_HANDLE;
+
+  // Move the last object into the removed slot
+  PhysicsObject *last = m_PhysicsObjects.back();
+  m_PhysicsObjects[obj->m_stepIndex] = last;
+  last->m_stepIndex = obj->m_stepIndex;
+  m_PhysicsObjects.pop_back();
+
+  RemoveCachedManifolds(obj);
+
+  if (obj->m_bodyStore == &m_bodyStore)
+    m_bodyStore.Remove(obj->m_bodyHandle);
+}
+
+/**
+ * @brief Sets if the motion state of objects in the simulation is held in the contiguous body store.
+ * @param enabled True to use the body store
+ *
+ * When enabled the state of every object is moved into a PhysicsBodyStore (the object accessors remain valid) and
+ * integration iterates over the store arrays rather than over individual objects.
+ */
+void PhysicsEngine::SetBodyStoreEnabled(bool enabled)
+{
+  if (enabled == m_bodyStoreEnabled)
+    return;
+
+  m_bodyStoreEnabled = enabled;
+
+  if (enabled)
+  {
+    for (PhysicsObject *obj : m_PhysicsObjects)
+      m_bodyStore.Add(obj);
+  }
+  else
+  {
+    m_bodyStore.Clear();
+  }
+}
+
+/**
+ * @brief Sets if awake bodies are integrated together using SIMD lanes.
+ * @param enabled True to use batch integration
+ *
+ * Batch integration operates on the body store, which is enabled if required.
+ *
+ * Gravity is applied to all bodies before any are integrated, so objects using point gravitation towards another
+ * movable object may see forces one step earlier than with per object integration. All other results match
+ * IntegrateBody() within BatchIntegrator::TOLERANCE.
+ */
+void PhysicsEngine::SetBatchIntegrationEnabled(bool enabled)
+{
+  m_batchIntegrationEnabled = enabled;
+
+  if (enabled)
+    SetBodyStoreEnabled(true);
+}
+
+/**
+ * @brief Sets the range of constraint solver iterations performed per step.
+ * @param minIterations Number of iterations always performed
+ * @param maxIterations Largest number of iterations performed
+ *
+ * Setting both to the same value gives a fixed number of iterations regardless of convergence.
+ */
+void PhysicsEngine::SetSolverIterationLimits(size_t minIterations, size_t maxIterations)
+{
+  if (minIterations > maxIterations)
+    minIterations = maxIterations;
 
-  // If found, remove it from the list
-  if (it != m_PhysicsObjects.end())
-    m_PhysicsObjects.erase(it);
+  m_minSolverIterations = minIterations;
+  m_maxSolverIterations = maxIterations;
 }
 
 /**
@@ -70,14 +232,18 @@ void PhysicsEngine::RemovePhysicsObject(PhysicsObject *obj)
  */
 void PhysicsEngine::RemoveAllPhysicsObjects()
 {
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+
   // Delete and remove all constraints/collision manifolds
   for (IConstraint *c : m_vpConstraints)
     delete c;
   m_vpConstraints.clear();
 
-  for (Manifold *m : m_vpManifolds)
-    delete m;
   m_vpManifolds.clear();
+  ClearManifoldCache();
+
+  m_contactPairs.clear();
+  m_contactEvents.clear();
 
   // Delete and remove all physics objects
   // - we also need to inform the (possible) associated game-object
@@ -89,373 +255,1779 @@ void PhysicsEngine::RemoveAllPhysicsObjects()
     delete obj;
   }
   m_PhysicsObjects.clear();
+  m_registry.Clear();
 }
 
 /**
  * @brief Performs an update of the physics system.
  * @param deltaTime Time passed in seconds
+ *
+ * Does nothing while the physics thread is running, as it steps the simulation itself.
  */
 void PhysicsEngine::Update(float deltaTime)
 {
-  m_broadphaseCollisionPairCount = 0;
-
-  if (!m_IsPaused)
-  {
-    m_UpdateAccum += deltaTime;
-
-    for (uint8_t i = 0; (m_UpdateAccum >= m_UpdateTimestep) && i < MAX_UPDATES_PER_FRAME; ++i)
-    {
-      m_UpdateAccum -= m_UpdateTimestep;
-
-      // Additional check here in case physics was paused mid-update and the contents of the physics need to be displayed
-      if (!m_IsPaused)
-      {
-        UpdatePhysics();
-        m_broadphaseCollisionPairCount += m_BroadphaseCollisionPairs.size();
-      }
-    }
+  if (m_physicsThreadRunFlag)
+    return;
 
-    if (m_UpdateAccum >= m_UpdateTimestep)
-    {
-      NCLERROR("Physics too slow to run in real time!");
-      // Drop Time in the hope that it can continue to run in real-time
-      m_UpdateAccum = 0.0f;
-    }
-  }
+  AdvanceTime(deltaTime);
 }
 
 /**
- * @brief Updates the physical objects in the simulation.
+ * @brief Performs a fixed number of physics steps as fast as possible.
+ * @param numSteps Number of steps to perform
+ * @return Work done and time taken
+ *
+ * Intended for offline simulation (e.g. tuning and automated tests). Unlike Update(), steps are not limited by
+ * MAX_UPDATES_PER_FRAME, no time is dropped and the timestep accumulator and paused state are ignored.
  */
-void PhysicsEngine::UpdatePhysics()
+WorldStepStats PhysicsEngine::Step(size_t numSteps)
 {
-  for (Manifold *m : m_vpManifolds)
-    delete m;
-  m_vpManifolds.clear();
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
 
-  // Broadphase collision detection
-  m_BroadphaseCollisionPairs.clear();
-  m_broadphaseDetection->FindPotentialCollisionPairs(m_PhysicsObjects, m_BroadphaseCollisionPairs);
-  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_BROADPHASE)
-    m_broadphaseDetection->DebugDraw();
+  GameTimer timer;
 
-  // Narrowphase collision detection
-  NarrowPhaseCollisions();
+  m_broadphaseCollisionPairCount = 0;
+  m_solverIterationCount = 0;
 
-  // Solve collision constraints
-  SolveConstraints();
+  PhysicsProfile updateProfile;
+  updateProfile.Reset();
 
-  // Update movement
-  for (PhysicsObject *obj : m_PhysicsObjects)
-    UpdatePhysicsObject(obj);
+  for (size_t i = 0; i < numSteps; ++i)
+    PerformStep(updateProfile);
+
+  SetUpdateProfile(updateProfile);
+
+  WorldStepStats stats;
+  stats.numSteps = numSteps;
+  stats.wallMs = timer.GetTimedMS();
+  stats.numBroadphasePairs = m_broadphaseCollisionPairCount;
+  stats.numSolverIterations = m_solverIterationCount;
+  stats.atRest = SimulationIsAtRest();
+  stats.profile = updateProfile;
+
+  return stats;
 }
 
 /**
- * @brief Solves constraints between objects.
+ * @brief Captures the state of the simulation into a snapshot.
+ * @param snapshot Snapshot to write to, any previously captured world is replaced
+ *
+ * Captures every object, the objects affected by each constraint, all persistent manifolds (including accumulated
+ * impulses used for warm starting), the pairs of objects touching in the last step and the timestep accumulator, so that
+ * stepping after RestoreSnapshot() reproduces the steps taken after the snapshot was saved.
  */
-void PhysicsEngine::SolveConstraints()
+void PhysicsEngine::SaveSnapshot(PhysicsWorldSnapshot &snapshot)
 {
-  // Optional step to allow constraints to precompute values based off current velocities before they are updated in the
-  // main loop below.
-  for (Manifold *m : m_vpManifolds)
-    m->PreSolverStep(m_UpdateTimestep);
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+
+  snapshot.Clear();
+  snapshot.m_bodies = m_PhysicsObjects;
+  snapshot.m_constraints = m_vpConstraints;
+
+  const size_t numObjects = m_PhysicsObjects.size();
+
+  // Index objects so records can refer to them by index
+  for (size_t i = 0; i < numObjects; ++i)
+    m_PhysicsObjects[i]->m_stepIndex = i;
+
+  auto bodyIndex = [this, numObjects](PhysicsObject *obj) -> int32_t {
+    if (obj != nullptr && obj->m_stepIndex < numObjects && m_PhysicsObjects[obj->m_stepIndex] == obj)
+      return (int32_t)obj->m_stepIndex;
+    return -1;
+  };
+
+  SnapshotHeader header;
+  header.magic = PHYSICS_SNAPSHOT_MAGIC;
+  header.version = PHYSICS_SNAPSHOT_VERSION;
+  header.numBodies = (uint32_t)numObjects;
+  header.numConstraints = (uint32_t)m_vpConstraints.size();
+  header.numManifolds = (uint32_t)m_manifoldCache.size();
+  header.numContactPairs = (uint32_t)m_contactPairs.size();
+  header.timestep = m_UpdateTimestep;
+  header.updateAccum = m_UpdateAccum;
+  header.stepCount = m_stepCount;
+  snapshot.Write(header);
 
-  for (IConstraint *c : m_vpConstraints)
-    c->PreSolverStep(m_UpdateTimestep);
+  for (PhysicsObject *obj : m_PhysicsObjects)
+  {
+    SnapshotBodyRecord body;
+    body.position = obj->GetPosition();
+    body.linearVelocity = obj->GetLinearVelocity();
+    body.linearForce = obj->GetForce();
+    body.inverseMass = obj->GetInverseMass();
+    body.orientation = obj->GetOrientation();
+    body.angularVelocity = obj->GetAngularVelocity();
+    body.torque = obj->GetTorque();
+    body.inverseInertia = obj->GetInverseInertia();
+    body.boundsLower = obj->m_localBoundingBox.Lower();
+    body.boundsUpper = obj->m_localBoundingBox.Upper();
+    body.elasticity = obj->m_elasticity;
+    body.friction = obj->m_friction;
+    body.dampingCoefficient = obj->m_dampingCoefficient;
+    body.restVelocityThresholdSquared = obj->m_restVelocityThresholdSquared;
+    body.averageSummedVelocity = obj->m_averageSummedVelocity;
+    body.gravitationTarget = bodyIndex(obj->m_gravitationTarget);
+    body.numShapes = (uint32_t)obj->m_collisionShapes.size();
+    body.atRest = obj->m_atRest ? 1 : 0;
+    body.collisionEnabled = obj->m_collisionEnabled ? 1 : 0;
+    body.trigger = obj->m_trigger ? 1 : 0;
+    body.kinematic = obj->m_kinematic ? 1 : 0;
+    body.contactEventsEnabled = obj->m_contactEventsEnabled ? 1 : 0;
+    snapshot.Write(body);
+  }
 
-  // Solve all Constraints and Collision Manifolds
-  for (size_t i = 0; i < SOLVER_ITERATIONS; i++)
+  for (IConstraint *c : m_vpConstraints)
   {
-    for (Manifold *m : m_vpManifolds)
-      m->ApplyImpulse();
+    SnapshotConstraintRecord constraint;
+    constraint.bodyA = bodyIndex(c->NodeA());
+    constraint.bodyB = bodyIndex(c->NodeB());
+    snapshot.Write(constraint);
+  }
 
-    for (IConstraint *c : m_vpConstraints)
-      c->ApplyImpulse();
+  for (auto &entry : m_manifoldCache)
+  {
+    const ManifoldKey &key = entry.first;
+    const std::vector<ContactPoint> &contacts = entry.second.manifold->ContactPoints();
+    const std::vector<ICollisionShape *> &shapesA = key.objA->m_collisionShapes;
+    const std::vector<ICollisionShape *> &shapesB = key.objB->m_collisionShapes;
+
+    SnapshotManifoldRecord manifold;
+    manifold.bodyA = (uint32_t)bodyIndex(key.objA);
+    manifold.bodyB = (uint32_t)bodyIndex(key.objB);
+    manifold.shapeA = (uint32_t)(std::find(shapesA.begin(), shapesA.end(), key.shapeA) - shapesA.begin());
+    manifold.shapeB = (uint32_t)(std::find(shapesB.begin(), shapesB.end(), key.shapeB) - shapesB.begin());
+    manifold.lastStep = entry.second.lastStep;
+    manifold.numContacts = (uint32_t)contacts.size();
+    snapshot.Write(manifold);
+    snapshot.Write(contacts.data(), contacts.size() * sizeof(ContactPoint));
   }
+
+  // Contact pairs refer to objects by handle, which is unchanged in the world the snapshot is restored into
+  snapshot.Write(m_contactPairs.data(), m_contactPairs.size() * sizeof(ContactEvent));
 }
 
 /**
- * @brief Updates the position and velocity of a given object based on their state and world gravity.
- * @param obj Object to update
+ * @brief Restores the simulation to the state captured in a snapshot.
+ * @param snapshot Snapshot to restore
+ * @return True if the snapshot was restored, false if it is invalid or was captured from a different world
+ *
+ * The simulation must contain exactly the objects and constraints it did when the snapshot was saved, the snapshot is
+ * rejected (and the simulation left untouched) otherwise. Objects are not reallocated, persistent manifolds are reused
+ * where possible.
  */
-void PhysicsEngine::UpdatePhysicsObject(PhysicsObject *obj)
+bool PhysicsEngine::RestoreSnapshot(const PhysicsWorldSnapshot &snapshot)
 {
-  if (obj->IsAwake())
-  {
-    float damping = obj->m_dampingCoefficient;
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
 
-    // Apply gravity
-    if (obj->m_inverseMass > 0.0f)
-    {
-      if (obj->m_gravitationTarget == nullptr)
-      {
-        // Uniform directional gravity
-        obj->m_linearVelocity += m_LinearGravity * m_UpdateTimestep;
-      }
-      else
-      {
-        Vector3 ab = obj->m_gravitationTarget->m_position - obj->m_position;
-        Vector3 abn = ab;
-        abn.Normalise();
+  if (!ValidateSnapshot(snapshot))
+    return false;
 
-        if (obj->m_gravitationTarget->m_inverseMass > 0.0f)
-        {
-          // Handle gravity between points (target is pulled towards self)
-          float r2 = ab.LengthSquared();
-          float f = m_PointGravitation / (r2 * obj->m_inverseMass * obj->m_gravitationTarget->m_inverseMass);
-          obj->ApplyForce(abn * f);
-          obj->m_gravitationTarget->ApplyForce(abn * -f);
-          obj->m_gravitationTarget->WakeUp();
-        }
-        else
-        {
-          // Handle gravity between points (target is immovable)
-          obj->m_linearVelocity += abn * -m_PointGravity * m_UpdateTimestep;
-        }
-      }
-    }
+  size_t offset = 0;
+  SnapshotHeader header;
+  snapshot.Read(offset, header);
 
-    switch (m_integrationType)
-    {
-    case INTEGRATION_EXPLICIT_EULER:
-    {
-      // Update position
-      obj->m_position += obj->m_linearVelocity * m_UpdateTimestep;
+  m_UpdateTimestep = header.timestep;
+  m_UpdateAccum = header.updateAccum;
+  m_stepCount = header.stepCount;
 
-      // Update linear velocity (v = u + at)
-      obj->m_linearVelocity += obj->m_linearForce * obj->m_inverseMass * m_UpdateTimestep;
+  // Object order is significant (broadphases may sort the object list in place)
+  m_PhysicsObjects = snapshot.m_bodies;
+  m_vpConstraints = snapshot.m_constraints;
 
-      // Linear velocity damping
-      obj->m_linearVelocity = obj->m_linearVelocity * damping;
+  for (size_t i = 0; i < m_PhysicsObjects.size(); ++i)
+    m_PhysicsObjects[i]->m_stepIndex = i;
 
-      // Update orientation
-      obj->m_orientation = obj->m_orientation + (obj->m_orientation * (obj->m_angularVelocity * m_UpdateTimestep * 0.5f));
-      obj->m_orientation.Normalise();
+  for (PhysicsObject *obj : m_PhysicsObjects)
+  {
+    SnapshotBodyRecord body;
+    snapshot.Read(offset, body);
+
+    obj->PositionRef() = body.position;
+    obj->LinearVelocityRef() = body.linearVelocity;
+    obj->LinearForceRef() = body.linearForce;
+    obj->InverseMassRef() = body.inverseMass;
+    obj->OrientationRef() = body.orientation;
+    obj->AngularVelocityRef() = body.angularVelocity;
+    obj->TorqueRef() = body.torque;
+    obj->InverseInertiaRef() = body.inverseInertia;
+    obj->m_localBoundingBox = BoundingBox(body.boundsLower, body.boundsUpper);
+    obj->m_elasticity = body.elasticity;
+    obj->m_friction = body.friction;
+    obj->m_dampingCoefficient = body.dampingCoefficient;
+    obj->m_restVelocityThresholdSquared = body.restVelocityThresholdSquared;
+    obj->m_averageSummedVelocity = body.averageSummedVelocity;
+    obj->m_gravitationTarget = (body.gravitationTarget < 0) ? nullptr : m_PhysicsObjects[body.gravitationTarget];
+    obj->m_atRest = (body.atRest != 0);
+    obj->m_collisionEnabled = (body.collisionEnabled != 0);
+    obj->m_trigger = (body.trigger != 0);
+    obj->m_kinematic = (body.kinematic != 0);
+    obj->m_contactEventsEnabled = (body.contactEventsEnabled != 0);
 
-      // Update angular velocity
-      obj->m_angularVelocity += obj->m_inverseInertia * obj->m_torque * m_UpdateTimestep;
+    obj->m_wsTransformInvalidated = true;
+    obj->m_wsAabbInvalidated = true;
+  }
 
-      // Angular velocity damping
-      obj->m_angularVelocity = obj->m_angularVelocity * damping;
+  offset += header.numConstraints * sizeof(SnapshotConstraintRecord);
 
-      break;
-    }
+  // Existing manifolds are reused for the restored ones, any left over are deleted
+  m_vpManifolds.clear();
+  for (auto &entry : m_manifoldCache)
+    m_vpManifolds.push_back(entry.second.manifold);
+  m_manifoldCache.clear();
 
-    default:
-    case INTEGRATION_SEMI_IMPLICIT_EULER:
-    {
-      // Update linear velocity (v = u + at)
-      obj->m_linearVelocity += obj->m_linearForce * obj->m_inverseMass * m_UpdateTimestep;
+  for (size_t i = 0; i < header.numManifolds; ++i)
+  {
+    SnapshotManifoldRecord record;
+    snapshot.Read(offset, record);
 
-      // Linear velocity damping
-      obj->m_linearVelocity = obj->m_linearVelocity * damping;
+    if (i == m_vpManifolds.size())
+      m_vpManifolds.push_back(new Manifold());
 
-      // Update position
-      obj->m_position += obj->m_linearVelocity * m_UpdateTimestep;
+    PhysicsObject *objA = m_PhysicsObjects[record.bodyA];
+    PhysicsObject *objB = m_PhysicsObjects[record.bodyB];
 
-      // Update angular velocity
-      obj->m_angularVelocity += obj->m_inverseInertia * obj->m_torque * m_UpdateTimestep;
+    Manifold *manifold = m_vpManifolds[i];
+    manifold->Initiate(objA, objB);
 
-      // Angular velocity damping
-      obj->m_angularVelocity = obj->m_angularVelocity * damping;
+    std::vector<ContactPoint> &contacts = manifold->ContactPoints();
+    contacts.resize(record.numContacts);
+    snapshot.Read(offset, contacts.data(), contacts.size() * sizeof(ContactPoint));
 
-      // Update orientation
-      obj->m_orientation = obj->m_orientation + (obj->m_orientation * (obj->m_angularVelocity * m_UpdateTimestep * 0.5f));
-      obj->m_orientation.Normalise();
+    ManifoldKey key = {objA, objB, objA->m_collisionShapes[record.shapeA], objB->m_collisionShapes[record.shapeB]};
+    m_manifoldCache[key] = {manifold, record.lastStep};
+  }
 
-      break;
-    }
+  for (size_t i = header.numManifolds; i < m_vpManifolds.size(); ++i)
+    delete m_vpManifolds[i];
+  m_vpManifolds.resize(header.numManifolds);
 
-    case INTEGRATION_RUNGE_KUTTA_2:
-    {
-      // RK2 integration for linear motion
-      IntegrationHelpers::State state = {obj->m_position, obj->m_linearVelocity, obj->m_linearForce * obj->m_inverseMass};
-      IntegrationHelpers::RK2(state, m_UpdateTimestep);
-      obj->m_position = state.position;
-      obj->m_linearVelocity = state.velocity;
+  m_contactPairs.resize(header.numContactPairs);
+  snapshot.Read(offset, m_contactPairs.data(), m_contactPairs.size() * sizeof(ContactEvent));
 
-      // Linear velocity damping
-      obj->m_linearVelocity = obj->m_linearVelocity * damping;
+  // Events of the last step describe the state before the restore
+  m_contactEvents.clear();
 
-      // Update angular velocity
-      obj->m_angularVelocity += obj->m_inverseInertia * obj->m_torque * m_UpdateTimestep;
+  // Persistent broadphase state was built from the objects before the restore, it is rebuilt in the next step
+  if (m_broadphaseDetection != nullptr)
+    m_broadphaseDetection->Clear();
 
-      // Angular velocity damping
-      obj->m_angularVelocity = obj->m_angularVelocity * damping;
+  // Rendering must not interpolate from the state before the restore
+  if (m_physicsThreadRunFlag)
+    PublishSnapshot(false);
 
-      // Update orientation
-      obj->m_orientation = obj->m_orientation + (obj->m_orientation * (obj->m_angularVelocity * m_UpdateTimestep * 0.5f));
-      obj->m_orientation.Normalise();
+  return true;
+}
 
-      break;
-    }
+/**
+ * @brief Checks that a snapshot is well formed and was captured from the current simulation.
+ * @param snapshot Snapshot to check
+ * @return True if the snapshot can be restored
+ */
+bool PhysicsEngine::ValidateSnapshot(const PhysicsWorldSnapshot &snapshot) const
+{
+  size_t offset = 0;
+  SnapshotHeader header;
+  if (!snapshot.Read(offset, header) || header.magic != PHYSICS_SNAPSHOT_MAGIC || header.version != PHYSICS_SNAPSHOT_VERSION ||
+      header.numBodies != snapshot.m_bodies.size() || header.numConstraints != snapshot.m_constraints.size())
+  {
+    NCLERROR("Invalid physics snapshot");
+    return false;
+  }
 
-    case INTEGRATION_RUNGE_KUTTA_4:
-    {
-      // RK4 integration for linear motion
-      IntegrationHelpers::State state = {obj->m_position, obj->m_linearVelocity, obj->m_linearForce * obj->m_inverseMass};
-      IntegrationHelpers::RK4(state, m_UpdateTimestep);
-      obj->m_position = state.position;
-      obj->m_linearVelocity = state.velocity;
+  // Snapshot tables must hold the same objects and constraints as the simulation (in any order)
+  std::vector<PhysicsObject *> bodies(snapshot.m_bodies);
+  std::vector<PhysicsObject *> objects(m_PhysicsObjects);
+  std::sort(bodies.begin(), bodies.end());
+  std::sort(objects.begin(), objects.end());
 
-      // Linear velocity damping
-      obj->m_linearVelocity = obj->m_linearVelocity * damping;
+  std::vector<IConstraint *> snapshotConstraints(snapshot.m_constraints);
+  std::vector<IConstraint *> constraints(m_vpConstraints);
+  std::sort(snapshotConstraints.begin(), snapshotConstraints.end());
+  std::sort(constraints.begin(), constraints.end());
 
-      // Update angular velocity
-      obj->m_angularVelocity += obj->m_inverseInertia * obj->m_torque * m_UpdateTimestep;
+  if (bodies != objects || snapshotConstraints != constraints)
+  {
+    NCLERROR("Physics snapshot was captured from a different set of objects or constraints");
+    return false;
+  }
 
-      // Angular velocity damping
-      obj->m_angularVelocity = obj->m_angularVelocity * damping;
+  // Records must be complete and refer to valid objects and shapes
+  for (uint32_t i = 0; i < header.numBodies; ++i)
+  {
+    SnapshotBodyRecord body;
+    if (!snapshot.Read(offset, body) || body.numShapes != snapshot.m_bodies[i]->m_collisionShapes.size() ||
+        body.gravitationTarget >= (int32_t)header.numBodies)
+    {
+      NCLERROR("Physics snapshot body %d is invalid", i);
+      return false;
+    }
+  }
 
-      // Update orientation
-      obj->m_orientation = obj->m_orientation + (obj->m_orientation * (obj->m_angularVelocity * m_UpdateTimestep * 0.5f));
-      obj->m_orientation.Normalise();
+  offset += header.numConstraints * sizeof(SnapshotConstraintRecord);
 
-      break;
-    }
+  for (uint32_t i = 0; i < header.numManifolds; ++i)
+  {
+    SnapshotManifoldRecord manifold;
+    if (!snapshot.Read(offset, manifold) || manifold.bodyA >= header.numBodies || manifold.bodyB >= header.numBodies ||
+        manifold.shapeA >= snapshot.m_bodies[manifold.bodyA]->m_collisionShapes.size() ||
+        manifold.shapeB >= snapshot.m_bodies[manifold.bodyB]->m_collisionShapes.size())
+    {
+      NCLERROR("Physics snapshot manifold %d is invalid", i);
+      return false;
     }
 
-    // Mark cached world transform and AABB as invalid
-    obj->m_wsTransformInvalidated = true;
-    obj->m_wsAabbInvalidated = true;
+    offset += manifold.numContacts * sizeof(ContactPoint);
   }
 
-  // Test for rest conditions
-  obj->DoAtRestTest();
+  offset += header.numContactPairs * sizeof(ContactEvent);
+
+  if (offset != snapshot.Size())
+  {
+    NCLERROR("Physics snapshot has unexpected size");
+    return false;
+  }
+
+  return true;
 }
 
 /**
- * @brief Handle narrowphase collision detection.
+ * @brief Starts stepping the simulation at a fixed rate on a dedicated thread.
+ *
+ * While running, Update() does nothing and the renderer should use the transforms published after each step (see
+ * Scene::BuildWorldMatrices()). Other threads must hold SimulationMutex() while accessing the simulation.
  */
-void PhysicsEngine::NarrowPhaseCollisions()
+void PhysicsEngine::StartPhysicsThread()
 {
-  if (m_BroadphaseCollisionPairs.size() > 0)
-  {
-    // Collision data to pass between detection and manifold generation stages.
-    CollisionData colData;
-
-    // Collision Detection Algorithm to use
-    CollisionDetectionSAT colDetect;
-
-    // Iterate over all possible collision pairs and perform accurate collision detection
-    for (size_t i = 0; i < m_BroadphaseCollisionPairs.size(); ++i)
-    {
-      CollisionPair &cp = m_BroadphaseCollisionPairs[i];
-
-      // Broadphase debug draw
-      if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_BROADPHASE_PAIRS)
-      {
-        NCLDebug::DrawThickLine(cp.pObjectA->GetPosition(), cp.pObjectB->GetPosition(), 0.02f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
-        NCLDebug::DrawPointNDT(cp.pObjectA->GetPosition(), 0.05f, Vector4(0.0f, 1.0f, 0.5f, 1.0f));
-        NCLDebug::DrawPointNDT(cp.pObjectB->GetPosition(), 0.05f, Vector4(0.0f, 1.0f, 0.5f, 1.0f));
-      }
-
-      for (auto aIt = cp.pObjectA->CollisionShapesBegin(); aIt != cp.pObjectA->CollisionShapesEnd(); ++aIt)
-      {
-        for (auto bIt = cp.pObjectB->CollisionShapesBegin(); bIt != cp.pObjectB->CollisionShapesEnd(); ++bIt)
-        {
-          ICollisionShape *shapeA = *aIt;
-          ICollisionShape *shapeB = *bIt;
+  if (m_physicsThreadRunFlag)
+    return;
 
-          colDetect.BeginNewPair(cp.pObjectA, cp.pObjectB, shapeA, shapeB);
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+    m_UpdateAccum = 0.0f;
+    PublishSnapshot(false);
+  }
 
-          // Detects if the objects are colliding - Seperating Axis Theorem
-          if (colDetect.AreColliding(&colData))
-          {
-            // Draw collision data to the window if requested
-            // - Have to do this here as colData is only temporary.
-            if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONNORMALS)
-            {
-              NCLDebug::DrawPointNDT(colData._pointOnPlane, 0.1f, Vector4(0.5f, 0.5f, 1.0f, 1.0f));
-              NCLDebug::DrawThickLineNDT(colData._pointOnPlane, colData._pointOnPlane - colData._normal * colData._penetration,
-                                         0.05f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
-            }
+  m_physicsThreadRunFlag = true;
+  m_physicsThread = std::thread(&PhysicsEngine::PhysicsThreadFunc, this);
+}
 
-            // Check to see if any of the objects have collision callbacks that dont
-            // want the objects to physically collide
-            bool okA = cp.pObjectA->FireOnCollisionEvent(cp.pObjectA, cp.pObjectB);
-            bool okB = cp.pObjectB->FireOnCollisionEvent(cp.pObjectB, cp.pObjectA);
+/**
+ * @brief Stops the physics thread, subsequent calls to Update() step the simulation on the calling thread.
+ */
+void PhysicsEngine::StopPhysicsThread()
+{
+  m_physicsThreadRunFlag = false;
+  if (m_physicsThread.joinable())
+    m_physicsThread.join();
+}
 
-            if (okA && okB)
-            {
-              // Build full collision manifold that will also handle the collision
-              // response between the two objects in the solver stage
-              Manifold *manifold = new Manifold();
-              manifold->Initiate(cp.pObjectA, cp.pObjectB);
+/**
+ * @brief Gets the interpolation factor between the last two published snapshots for the current time.
+ * @return Interpolation factor (0 to 1)
+ *
+ * The snapshot mutex must be held by the caller.
+ */
+float PhysicsEngine::GetSnapshotAlpha() const
+{
+  float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_snapshotTime).count();
+  float alpha = elapsed / m_UpdateTimestep;
+  return (alpha > 1.0f) ? 1.0f : alpha;
+}
 
-              // Construct contact points that form the perimeter of the collision manifold
-              colDetect.GenContactPoints(manifold);
+/**
+ * @brief Copies the transform of every object into the snapshot read by the renderer.
+ * @param keepPrevious If the latest snapshot should be kept for interpolation, otherwise both are replaced
+ *
+ * The simulation mutex must be held by the caller.
+ */
+void PhysicsEngine::PublishSnapshot(bool keepPrevious)
+{
+  std::lock_guard<std::mutex> lock(m_snapshotMutex);
 
-              // Fire callback
-              cp.pObjectA->FireOnCollisionManifoldCallback(cp.pObjectA, cp.pObjectB, manifold);
-              cp.pObjectB->FireOnCollisionManifoldCallback(cp.pObjectB, cp.pObjectA, manifold);
+  for (PhysicsObject *obj : m_PhysicsObjects)
+    obj->StoreSnapshot(keepPrevious);
 
-              // Add to list of manifolds that need solving
-              m_vpManifolds.push_back(manifold);
-            }
-          }
-        }
-      }
-    }
-  }
+  m_snapshotTime = std::chrono::steady_clock::now();
 }
 
 /**
- * @brief Draw visual debug information.
+ * @brief Physics thread entry point, steps the simulation in real time until the thread is stopped.
  */
-void PhysicsEngine::DebugRender()
+void PhysicsEngine::PhysicsThreadFunc()
 {
-  // Draw all collision manifolds
-  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_MANIFOLD)
-  {
-    for (Manifold *m : m_vpManifolds)
-      m->DebugDraw();
-  }
-
-  // Draw all constraints
-  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_CONSTRAINT)
-  {
-    for (IConstraint *c : m_vpConstraints)
-      c->DebugDraw();
-  }
+  std::chrono::steady_clock::time_point lastTime = std::chrono::steady_clock::now();
 
-  // Draw all objects and collision shapes
-  for (PhysicsObject *obj : m_PhysicsObjects)
+  while (m_physicsThreadRunFlag)
   {
-    obj->DebugDraw(m_DebugDrawFlags);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    float deltaTime = std::chrono::duration<float>(now - lastTime).count();
+    lastTime = now;
 
-    if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONVOLUMES)
+    float timeToNextStep;
     {
-      for (auto it = obj->CollisionShapesBegin(); it != obj->CollisionShapesEnd(); ++it)
-        (*it)->DebugDraw(obj);
+      std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+      AdvanceTime(deltaTime);
+      timeToNextStep = m_UpdateTimestep - m_UpdateAccum;
     }
+
+    // Sleep until the next step is due
+    if (timeToNextStep > 0.0f)
+      std::this_thread::sleep_for(std::chrono::duration<float>(timeToNextStep));
   }
 }
 
 /**
- * @brief Checks if all physics objects in the system have the at rest flags set.
- * @return True if all objects are flagged as at rest
- *
- * Mainly added for debugging.
+ * @brief Performs as many fixed physics steps as fit in the accumulated time.
+ * @param deltaTime Time passed in seconds
  */
-bool PhysicsEngine::SimulationIsAtRest() const
+void PhysicsEngine::AdvanceTime(float deltaTime)
 {
-  auto firstObjectNotAtRest =
-      std::find_if(m_PhysicsObjects.begin(), m_PhysicsObjects.end(), [](PhysicsObject *o) { return o->IsAwake(); });
-  return (firstObjectNotAtRest == m_PhysicsObjects.end());
-}
+  ApplyCommands();
 
-/**
- * @brief Finds a physics object based on the name of its associated (parent) game object.
- * @param name Name of the obeject to find
- * @return Pointer to physics object (nullptr if not found)
- */
-PhysicsObject *PhysicsEngine::FindObjectByName(const std::string &name)
+  m_broadphaseCollisionPairCount = 0;
+  m_solverIterationCount = 0;
+
+  PhysicsProfile updateProfile;
+  updateProfile.Reset();
+
+  if (!m_IsPaused)
+  {
+    m_UpdateAccum += deltaTime;
+
+    for (uint8_t i = 0; (m_UpdateAccum >= m_UpdateTimestep) && i < MAX_UPDATES_PER_FRAME; ++i)
+    {
+      m_UpdateAccum -= m_UpdateTimestep;
+
+      // Additional check here in case physics was paused mid-update and the contents of the physics need to be displayed
+      if (!m_IsPaused)
+        PerformStep(updateProfile);
+    }
+
+    if (m_UpdateAccum >= m_UpdateTimestep)
+    {
+      NCLERROR("Physics too slow to run in real time!");
+      // Drop Time in the hope that it can continue to run in real-time
+      m_UpdateAccum = 0.0f;
+    }
+  }
+
+  SetUpdateProfile(updateProfile);
+}
+
+/**
+ * @brief Performs a single physics step and records the work done.
+ * @param updateProfile Profile of the current update to add the step to
+ */
+void PhysicsEngine::PerformStep(PhysicsProfile &updateProfile)
+{
+  ApplyCommands();
+  UpdatePhysics();
+  DispatchContactEvents();
+  m_broadphaseCollisionPairCount += m_BroadphaseCollisionPairs.size();
+  m_solverIterationCount += m_lastStepSolverIterations;
+
+  if (m_profilingEnabled)
+    updateProfile.Accumulate(m_lastStepProfile);
+
+  if (m_physicsThreadRunFlag)
+    PublishSnapshot(true);
+}
+
+/**
+ * @brief Applies all commands queued with QueueCommand() that have been completely pushed.
+ */
+void PhysicsEngine::ApplyCommands()
+{
+  PhysicsCommand command;
+  while (m_commandQueue.Pop(command))
+    command(*this);
+}
+
+/**
+ * @brief Sets the profile returned by GetUpdateProfile().
+ * @param updateProfile Profile of the steps performed in the current update
+ *
+ * Updates in which no step was performed keep the profile of the last update that performed physics steps.
+ */
+void PhysicsEngine::SetUpdateProfile(const PhysicsProfile &updateProfile)
+{
+  if (updateProfile.numSteps > 0)
+  {
+    std::lock_guard<std::mutex> lock(m_updateProfileMutex);
+    m_updateProfile = updateProfile;
+  }
+}
+
+/**
+ * @brief Updates the physical objects in the simulation.
+ */
+void PhysicsEngine::UpdatePhysics()
+{
+  m_stepCount++;
+  m_vpManifolds.clear();
+  m_debugPairLines.clear();
+  m_debugNormalLines.clear();
+
+  // Stage timings are taken from a timer that is reset at the end of each stage
+  GameTimer stageTimer;
+  auto endStage = [this, &stageTimer](float &stageMs) {
+    if (m_profilingEnabled)
+      stageMs = stageTimer.GetTimedMS();
+  };
+
+  // Broadphase collision detection
+  m_BroadphaseCollisionPairs.clear();
+  m_broadphaseDetection->FindPotentialCollisionPairs(m_PhysicsObjects, m_BroadphaseCollisionPairs);
+
+  // Broadphases may reorder the object list, reindex objects for removal, island detection and constraint colouring
+  for (size_t i = 0; i < m_PhysicsObjects.size(); ++i)
+    m_PhysicsObjects[i]->m_stepIndex = i;
+
+  RemoveDuplicatePairs();
+  MarkRestingContactPairs();
+  endStage(m_lastStepProfile.broadphaseMs);
+
+  // Narrowphase collision detection
+  NarrowPhaseCollisions();
+  RemoveStaleManifolds();
+  GenerateContactEvents();
+  endStage(m_lastStepProfile.narrowphaseMs);
+
+  // Group objects into independent islands
+  bool islandsValid = false;
+  if (m_islandSolvingEnabled || m_islandSleepingEnabled)
+    islandsValid = BuildIslands();
+  else
+    m_numIslands = 0;
+
+  // Solve collision constraints
+  BuildSolverBodies();
+
+  if (m_solverType == SOLVER_GRAPH_COLOURED)
+    m_colouredSolver.Colour(m_PhysicsObjects, m_vpManifolds, m_vpConstraints);
+
+  endStage(m_lastStepProfile.preSolveMs);
+
+  if (m_solverType == SOLVER_GRAPH_COLOURED)
+  {
+    m_lastStepSolverIterations = m_colouredSolver.Solve(m_UpdateTimestep, m_minSolverIterations, m_maxSolverIterations,
+                                                        m_solverConvergenceThreshold);
+  }
+  else if (islandsValid && m_islandSolvingEnabled)
+  {
+    SolveIslands();
+  }
+  else
+  {
+    m_lastStepSolverIterations = SolveConstraints(m_vpManifolds, m_vpConstraints);
+  }
+
+  WriteBackSolverBodies();
+  endStage(m_lastStepProfile.solverMs);
+
+  // Update movement
+  if (m_nBodyGravityEnabled)
+    ComputeNBodyGravity();
+
+  BeginContinuousCollisions();
+
+  UpdateObjects();
+
+  // Stop fast objects passing through others
+  SolveContinuousCollisions();
+
+  // Sleep or wake islands as a whole
+  if (islandsValid && m_islandSleepingEnabled)
+    UpdateIslandSleeping();
+
+  endStage(m_lastStepProfile.integrationMs);
+
+  if (m_profilingEnabled)
+    ProfileCounts();
+}
+
+/**
+ * @brief Records the total time and the amount of work done in the last physics step.
+ */
+void PhysicsEngine::ProfileCounts()
+{
+  PhysicsProfile &profile = m_lastStepProfile;
+
+  profile.numSteps = 1;
+  profile.totalMs =
+      profile.broadphaseMs + profile.narrowphaseMs + profile.preSolveMs + profile.solverMs + profile.integrationMs;
+
+  profile.numBroadphasePairs = m_BroadphaseCollisionPairs.size();
+  profile.numManifolds = m_vpManifolds.size();
+  profile.numSolverIterations = m_lastStepSolverIterations;
+
+  profile.numContacts = 0;
+  for (Manifold *m : m_vpManifolds)
+    profile.numContacts += m->ContactPoints().size();
+
+  profile.numAwakeBodies = 0;
+  for (PhysicsObject *obj : m_PhysicsObjects)
+  {
+    if (!obj->IsStatic() && obj->IsAwake())
+      profile.numAwakeBodies++;
+  }
+}
+
+/**
+ * @brief Copies the state of each object used by the constraint solver into the solver body array.
+ *
+ * Solver bodies are indexed by the step index of their object.
+ */
+void PhysicsEngine::BuildSolverBodies()
+{
+  const size_t numObjects = m_PhysicsObjects.size();
+  m_solverBodies.resize(numObjects);
+
+  for (size_t i = 0; i < numObjects; ++i)
+  {
+    PhysicsObject *obj = m_PhysicsObjects[i];
+    SolverBody &body = m_solverBodies[i];
+
+    body.linearVelocity = obj->GetLinearVelocity();
+    body.angularVelocity = obj->GetAngularVelocity();
+    body.isStatic = obj->IsStatic();
+
+    if (body.isStatic)
+    {
+      // Kinematic objects may have mass set but never respond to impulses
+      body.inverseMass = 0.0f;
+      body.inverseInertia = Matrix3::ZeroMatrix;
+    }
+    else
+    {
+      body.inverseMass = obj->GetInverseMass();
+
+      // Objects store inverse inertia in their local frame
+      Matrix3 rotation = obj->GetOrientation().ToMatrix3();
+      body.inverseInertia = rotation * obj->GetInverseInertia() * Matrix3::Transpose(rotation);
+    }
+  }
+}
+
+/**
+ * @brief Copies the velocities computed by the constraint solver back to the objects.
+ */
+void PhysicsEngine::WriteBackSolverBodies()
+{
+  const size_t numObjects = m_PhysicsObjects.size();
+
+  for (size_t i = 0; i < numObjects; ++i)
+  {
+    const SolverBody &body = m_solverBodies[i];
+    if (body.isStatic)
+      continue;
+
+    PhysicsObject *obj = m_PhysicsObjects[i];
+    obj->SetLinearVelocity(body.linearVelocity);
+    obj->SetAngularVelocity(body.angularVelocity);
+  }
+}
+
+/**
+ * @brief Solves constraints between objects.
+ * @param manifolds Contact constraints to solve
+ * @param constraints Misc constraints to solve
+ * @return Number of solver iterations performed
+ *
+ * Iterates until the largest impulse applied in an iteration falls below the convergence threshold, within the configured
+ * iteration limits.
+ */
+size_t PhysicsEngine::SolveConstraints(std::vector<Manifold *> &manifolds, std::vector<IConstraint *> &constraints)
+{
+  // Optional step to allow constraints to precompute values based off current velocities before they are updated in the
+  // main loop below.
+  for (Manifold *m : manifolds)
+    m->PreSolverStep(m_UpdateTimestep);
+
+  for (IConstraint *c : constraints)
+    c->PreSolverStep(m_UpdateTimestep);
+
+  // Solve all Constraints and Collision Manifolds
+  size_t i = 0;
+  while (i < m_maxSolverIterations)
+  {
+    float maxImpulse = 0.0f;
+
+    for (Manifold *m : manifolds)
+    {
+      float impulse = m->ApplyImpulse();
+      if (impulse > maxImpulse)
+        maxImpulse = impulse;
+    }
+
+    for (IConstraint *c : constraints)
+    {
+      float impulse = c->ApplyImpulse();
+      if (impulse > maxImpulse)
+        maxImpulse = impulse;
+    }
+
+    ++i;
+    if (i >= m_minSolverIterations && maxImpulse < m_solverConvergenceThreshold)
+      break;
+  }
+
+  return i;
+}
+
+/**
+ * @brief Groups objects into islands that are connected through contacts or constraints.
+ * @return True if islands were built, false if a constraint prevents island detection
+ *
+ * Static objects never join islands, so separate piles resting on the same ground remain independent. Islands are
+ * ordered by their first object and keep the relative order of manifolds and constraints, hence solving the islands
+ * gives the same result as solving all constraints together.
+ */
+bool PhysicsEngine::BuildIslands()
+{
+  const size_t numObjects = m_PhysicsObjects.size();
+  m_numIslands = 0;
+
+  // Merge objects that interact
+  m_islandSet.Reset(numObjects);
+
+  for (Manifold *m : m_vpManifolds)
+    LinkIsland(m->NodeA(), m->NodeB());
+
+  for (IConstraint *c : m_vpConstraints)
+  {
+    if (!LinkIsland(c->NodeA(), c->NodeB()))
+      return false;
+  }
+
+  // Assign an island to each set of non static objects
+  m_islandRootIndices.assign(numObjects, SIZE_MAX);
+
+  for (size_t i = 0; i < numObjects; ++i)
+  {
+    PhysicsObject *obj = m_PhysicsObjects[i];
+    if (obj->IsStatic())
+      continue;
+
+    size_t &islandIdx = m_islandRootIndices[m_islandSet.Find(i)];
+    if (islandIdx == SIZE_MAX)
+    {
+      islandIdx = m_numIslands++;
+
+      if (m_islands.size() < m_numIslands)
+        m_islands.resize(m_numIslands);
+
+      SimulationIsland &island = m_islands[islandIdx];
+      island.bodies.clear();
+      island.manifolds.clear();
+      island.constraints.clear();
+    }
+
+    m_islands[islandIdx].bodies.push_back(obj);
+  }
+
+  // Assign manifolds and constraints to the island of their non static object, constraints between two static objects
+  // (e.g. a weld to a kinematic object) may still move them so are kept to be solved after the islands
+  m_staticConstraints.clear();
+
+  for (Manifold *m : m_vpManifolds)
+  {
+    PhysicsObject *owner = IslandOwner(m->NodeA(), m->NodeB());
+    if (owner != nullptr)
+      m_islands[m_islandRootIndices[m_islandSet.Find(owner->m_stepIndex)]].manifolds.push_back(m);
+  }
+
+  for (IConstraint *c : m_vpConstraints)
+  {
+    PhysicsObject *owner = IslandOwner(c->NodeA(), c->NodeB());
+    if (owner != nullptr)
+      m_islands[m_islandRootIndices[m_islandSet.Find(owner->m_stepIndex)]].constraints.push_back(c);
+    else
+      m_staticConstraints.push_back(c);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Merges the islands of two interacting objects.
+ * @param a First object
+ * @param b Second object
+ * @return False if either object is not part of the simulation
+ */
+bool PhysicsEngine::LinkIsland(PhysicsObject *a, PhysicsObject *b)
+{
+  const size_t numObjects = m_PhysicsObjects.size();
+
+  for (PhysicsObject *obj : {a, b})
+  {
+    if (obj == nullptr || obj->m_stepIndex >= numObjects || m_PhysicsObjects[obj->m_stepIndex] != obj)
+      return false;
+  }
+
+  if (!a->IsStatic() && !b->IsStatic())
+    m_islandSet.Union(a->m_stepIndex, b->m_stepIndex);
+
+  return true;
+}
+
+/**
+ * @brief Gets the object whose island a constraint between two objects belongs to.
+ * @param a First object
+ * @param b Second object
+ * @return Non static object, nullptr if both are static
+ *
+ * Constraints between two static objects are not assigned to any island.
+ */
+PhysicsObject *PhysicsEngine::IslandOwner(PhysicsObject *a, PhysicsObject *b) const
+{
+  if (!a->IsStatic())
+    return a;
+  else if (!b->IsStatic())
+    return b;
+  else
+    return nullptr;
+}
+
+/**
+ * @brief Solves the constraints in each island, distributing islands over OpenMP threads.
+ *
+ * Constraints between two static objects are solved serially once all islands are solved. They apply no impulses, but
+ * may set the position of a static object directly (as a WeldConstraint to a kinematic object does).
+ */
+void PhysicsEngine::SolveIslands()
+{
+  const int numIslands = (int)m_numIslands;
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int i = 0; i < numIslands; ++i)
+  {
+    SimulationIsland &island = m_islands[i];
+    island.solverIterations = SolveConstraints(island.manifolds, island.constraints);
+  }
+
+  m_lastStepSolverIterations = 0;
+  for (size_t i = 0; i < m_numIslands; ++i)
+  {
+    if (m_islands[i].solverIterations > m_lastStepSolverIterations)
+      m_lastStepSolverIterations = m_islands[i].solverIterations;
+  }
+
+  if (!m_staticConstraints.empty())
+  {
+    std::vector<Manifold *> noManifolds;
+    size_t iterations = SolveConstraints(noManifolds, m_staticConstraints);
+    if (iterations > m_lastStepSolverIterations)
+      m_lastStepSolverIterations = iterations;
+  }
+}
+
+/**
+ * @brief Puts islands to sleep only when every object in them is at rest, otherwise wakes the whole island.
+ *
+ * Must be called after the rest test has been performed on all objects.
+ */
+void PhysicsEngine::UpdateIslandSleeping()
+{
+  for (size_t i = 0; i < m_numIslands; ++i)
+  {
+    SimulationIsland &island = m_islands[i];
+
+    bool atRest = std::all_of(island.bodies.begin(), island.bodies.end(), [](PhysicsObject *o) { return o->IsAtRest(); });
+
+    if (!atRest)
+    {
+      for (PhysicsObject *obj : island.bodies)
+        obj->WakeUp();
+    }
+  }
+}
+
+/**
+ * @brief Updates the position and velocity of all objects based on their state and world gravity.
+ *
+ * The integration scheme is selected once here, each scheme has its own instantiation of the update loop.
+ */
+void PhysicsEngine::UpdateObjects()
+{
+  switch (m_integrationType)
+  {
+  case INTEGRATION_EXPLICIT_EULER:
+    UpdateObjects<INTEGRATION_EXPLICIT_EULER>();
+    break;
+  default:
+  case INTEGRATION_SEMI_IMPLICIT_EULER:
+    UpdateObjects<INTEGRATION_SEMI_IMPLICIT_EULER>();
+    break;
+  case INTEGRATION_RUNGE_KUTTA_2:
+    UpdateObjects<INTEGRATION_RUNGE_KUTTA_2>();
+    break;
+  case INTEGRATION_RUNGE_KUTTA_4:
+    UpdateObjects<INTEGRATION_RUNGE_KUTTA_4>();
+    break;
+  }
+}
+
+/**
+ * @brief Updates the position and velocity of all objects using a given integration scheme.
+ */
+template <IntegrationType Type> void PhysicsEngine::UpdateObjects()
+{
+  if (m_bodyStoreEnabled)
+  {
+    UpdateBodyStore<Type>();
+    return;
+  }
+
+  const float dt = m_UpdateTimestep;
+
+  for (PhysicsObject *obj : m_PhysicsObjects)
+  {
+    if (obj->m_kinematic)
+    {
+      MoveKinematicObject(obj, obj->PositionRef(), obj->OrientationRef(), obj->GetLinearVelocity(),
+                          obj->GetAngularVelocity());
+      continue;
+    }
+
+    if (obj->IsAwake())
+    {
+      ApplyGravity(obj, obj->LinearVelocityRef());
+
+      IntegrationHelpers::Integrate<Type>(dt, obj->m_dampingCoefficient, obj->PositionRef(), obj->LinearVelocityRef(),
+                                          obj->GetForce(), obj->GetInverseMass(), obj->OrientationRef(),
+                                          obj->AngularVelocityRef(), obj->GetTorque(), obj->GetInverseInertia());
+
+      // Mark cached world transform and AABB as invalid
+      obj->m_wsTransformInvalidated = true;
+      obj->m_wsAabbInvalidated = true;
+    }
+
+    // Test for rest conditions
+    obj->DoAtRestTest();
+  }
+}
+
+/**
+ * @brief Updates the position and velocity of all objects held in the body store using a given integration scheme.
+ *
+ * Equivalent to UpdateObjects(), but motion state is read directly from the contiguous arrays of the store. If batch
+ * integration is enabled all awake bodies are integrated together by the BatchIntegrator.
+ */
+template <IntegrationType Type> void PhysicsEngine::UpdateBodyStore()
+{
+  PhysicsBodyStore &store = m_bodyStore;
+
+  if (m_batchIntegrationEnabled)
+  {
+    // Apply gravity and collect awake bodies
+    m_awakeBodyIndices.clear();
+    for (size_t i = 0; i < store.Size(); ++i)
+    {
+      PhysicsObject *obj = store.m_bodies[i];
+
+      if (obj->m_kinematic)
+      {
+        MoveKinematicObject(obj, store.m_positions[i], store.m_orientations[i], store.m_linearVelocities[i],
+                            store.m_angularVelocities[i]);
+      }
+      else if (obj->IsAwake())
+      {
+        ApplyGravity(obj, store.m_linearVelocities[i]);
+        m_awakeBodyIndices.push_back(i);
+      }
+    }
+
+    // Integrate all awake bodies together
+    m_batchIntegrator.Integrate(store, m_awakeBodyIndices, Type, m_UpdateTimestep);
+
+    // Mark cached world transform and AABB as invalid
+    for (size_t i : m_awakeBodyIndices)
+    {
+      store.m_bodies[i]->m_wsTransformInvalidated = true;
+      store.m_bodies[i]->m_wsAabbInvalidated = true;
+    }
+
+    // Test for rest conditions
+    for (size_t i = 0; i < store.Size(); ++i)
+    {
+      if (!store.m_bodies[i]->m_kinematic)
+        store.m_bodies[i]->DoAtRestTest();
+    }
+  }
+  else
+  {
+    const float dt = m_UpdateTimestep;
+
+    for (size_t i = 0; i < store.Size(); ++i)
+    {
+      PhysicsObject *obj = store.m_bodies[i];
+
+      if (obj->m_kinematic)
+      {
+        MoveKinematicObject(obj, store.m_positions[i], store.m_orientations[i], store.m_linearVelocities[i],
+                            store.m_angularVelocities[i]);
+        continue;
+      }
+
+      if (obj->IsAwake())
+      {
+        ApplyGravity(obj, store.m_linearVelocities[i]);
+
+        IntegrationHelpers::Integrate<Type>(dt, obj->m_dampingCoefficient, store.m_positions[i], store.m_linearVelocities[i],
+                                            store.m_linearForces[i], store.m_inverseMasses[i], store.m_orientations[i],
+                                            store.m_angularVelocities[i], store.m_torques[i], store.m_inverseInertias[i]);
+
+        // Mark cached world transform and AABB as invalid
+        obj->m_wsTransformInvalidated = true;
+        obj->m_wsAabbInvalidated = true;
+      }
+
+      // Test for rest conditions
+      obj->DoAtRestTest();
+    }
+  }
+}
+
+/**
+ * @brief Advances a kinematic object by its velocity over one timestep.
+ * @param obj Object to update
+ * @param position Reference to the position of the object
+ * @param orientation Reference to the orientation of the object
+ * @param linearVelocity Linear velocity of the object
+ * @param angularVelocity Angular velocity of the object
+ *
+ * Kinematic objects are only at rest while they have no velocity.
+ */
+void PhysicsEngine::MoveKinematicObject(PhysicsObject *obj, Vector3 &position, Quaternion &orientation,
+                                        const Vector3 &linearVelocity, const Vector3 &angularVelocity)
+{
+  obj->m_atRest = (linearVelocity.LengthSquared() == 0.0f && angularVelocity.LengthSquared() == 0.0f);
+  if (obj->m_atRest)
+    return;
+
+  position += linearVelocity * m_UpdateTimestep;
+  IntegrationHelpers::IntegrateOrientation(orientation, angularVelocity, m_UpdateTimestep);
+
+  // Mark cached world transform and AABB as invalid
+  obj->m_wsTransformInvalidated = true;
+  obj->m_wsAabbInvalidated = true;
+}
+
+/**
+ * @brief Applies the effect of gravity to an object.
+ * @param obj Object to update
+ * @param linearVelocity Reference to the linear velocity of the object
+ */
+void PhysicsEngine::ApplyGravity(PhysicsObject *obj, Vector3 &linearVelocity)
+{
+  float inverseMass = obj->GetInverseMass();
+  if (inverseMass <= 0.0f)
+    return;
+
+  PhysicsObject *target = obj->m_gravitationTarget;
+
+  if (target == nullptr)
+  {
+    // Uniform directional gravity
+    linearVelocity += m_LinearGravity * m_UpdateTimestep;
+  }
+  else
+  {
+    Vector3 ab = target->GetPosition() - obj->GetPosition();
+    Vector3 abn = ab;
+    abn.Normalise();
+
+    if (target->GetInverseMass() > 0.0f)
+    {
+      // Handle gravity between points (target is pulled towards self)
+      float r2 = ab.LengthSquared();
+      float f = m_PointGravitation / (r2 * inverseMass * target->GetInverseMass());
+      obj->ApplyForce(abn * f);
+      target->ApplyForce(abn * -f);
+      target->WakeUp();
+    }
+    else
+    {
+      // Handle gravity between points (target is immovable)
+      linearVelocity += abn * -m_PointGravity * m_UpdateTimestep;
+    }
+  }
+
+  // Gravity between all movable objects
+  if (m_nBodyGravityEnabled)
+    linearVelocity += m_nBodyAccelerations[obj->m_stepIndex] * m_UpdateTimestep;
+}
+
+/**
+ * @brief Computes the N-body gravitational acceleration of every awake movable object.
+ *
+ * Builds a Barnes-Hut octree over all movable objects then evaluates the acceleration of each object in parallel, results
+ * are indexed by step index and applied in ApplyGravity().
+ */
+void PhysicsEngine::ComputeNBodyGravity()
+{
+  const size_t numObjects = m_PhysicsObjects.size();
+  m_nBodyPositions.resize(numObjects);
+  m_nBodyMasses.resize(numObjects);
+  m_nBodyAccelerations.resize(numObjects);
+
+  for (size_t i = 0; i < numObjects; ++i)
+  {
+    PhysicsObject *obj = m_PhysicsObjects[i];
+    float inverseMass = obj->GetInverseMass();
+
+    m_nBodyPositions[i] = obj->GetPosition();
+    m_nBodyMasses[i] = (inverseMass > 0.0f) ? (1.0f / inverseMass) : 0.0f;
+  }
+
+  m_gravityTree.Build(m_nBodyPositions, m_nBodyMasses);
+
+  const int numBodies = (int)numObjects;
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for (int i = 0; i < numBodies; ++i)
+  {
+    if (m_nBodyMasses[i] > 0.0f && m_PhysicsObjects[i]->IsAwake())
+      m_nBodyAccelerations[i] =
+          m_gravityTree.ComputeAcceleration((size_t)i, m_nBodyOpeningAngle, m_nBodySoftening) * m_PointGravitation;
+    else
+      m_nBodyAccelerations[i] = Vector3();
+  }
+}
+
+/**
+ * @brief Records the start position of every moving object that has continuous collision detection enabled.
+ */
+void PhysicsEngine::BeginContinuousCollisions()
+{
+  m_ccdBodies.clear();
+
+  for (PhysicsObject *obj : m_PhysicsObjects)
+  {
+    if (obj->m_continuousCollisionEnabled && obj->m_collisionEnabled && !obj->m_trigger && !obj->m_kinematic &&
+        obj->IsAwake())
+      m_ccdBodies.push_back({obj, obj->GetPosition()});
+  }
+}
+
+/**
+ * @brief Moves fast objects with continuous collision detection enabled back to their time of impact.
+ *
+ * Any object that moved further than its continuous collision radius in this step is advanced along its path in steps
+ * no longer than that radius (conservative advancement), so it cannot skip over the surface of any object found by the
+ * broadphase along its path. If it collides with an object it was not already touching at the start of the step, the
+ * time of impact is refined by bisection and the object is left there with its velocity intact. The contact is then
+ * found and resolved by the regular narrowphase and solver in the next step.
+ */
+void PhysicsEngine::SolveContinuousCollisions()
+{
+  m_lastStepProfile.numSweptBodies = 0;
+  m_lastStepProfile.numTimeOfImpacts = 0;
+
+  if (m_ccdBodies.empty())
+    return;
+
+  CollisionDetectionSAT colDetect;
+
+  for (ContinuousCollisionBody &body : m_ccdBodies)
+  {
+    PhysicsObject *obj = body.object;
+    const Vector3 endPosition = obj->GetPosition();
+    const Vector3 motion = endPosition - body.startPosition;
+    const float distance = motion.Length();
+    const float radius = obj->GetContinuousCollisionRadius();
+
+    // Slow objects are caught by the regular narrowphase
+    if (radius <= 0.0f || distance <= radius)
+      continue;
+
+    m_lastStepProfile.numSweptBodies++;
+
+    // Find objects overlapping the volume swept over the step
+    BoundingBox sweptBox = obj->GetWorldSpaceAABB();
+    sweptBox.ExpandToFit(BoundingBox(sweptBox.Lower() - motion, sweptBox.Upper() - motion));
+
+    m_ccdCandidates.clear();
+    m_broadphaseDetection->FindObjectsInBox(m_PhysicsObjects, sweptBox, m_ccdCandidates);
+
+    // Ignore objects already in contact at the start of the step, these were handled by the solver
+    MoveSweptObject(obj, body.startPosition);
+
+    m_ccdTargets.clear();
+    for (PhysicsObject *other : m_ccdCandidates)
+    {
+      if (other == obj || !other->m_collisionEnabled || other->m_trigger)
+        continue;
+
+      if (!ObjectsOverlap(colDetect, obj, other))
+        m_ccdTargets.push_back(other);
+    }
+
+    auto collidesWithTarget = [this, &colDetect, obj]() {
+      for (PhysicsObject *other : m_ccdTargets)
+      {
+        if (ObjectsOverlap(colDetect, obj, other))
+          return true;
+      }
+
+      return false;
+    };
+
+    // Advance along the path until the first collision
+    const size_t numSteps = (size_t)ceilf(distance / radius);
+    float clearFraction = 0.0f;
+    float hitFraction = -1.0f;
+
+    for (size_t i = 1; i <= numSteps && !m_ccdTargets.empty(); ++i)
+    {
+      float fraction = (float)i / (float)numSteps;
+      MoveSweptObject(obj, body.startPosition + motion * fraction);
+
+      if (collidesWithTarget())
+      {
+        hitFraction = fraction;
+        break;
+      }
+
+      clearFraction = fraction;
+    }
+
+    if (hitFraction < 0.0f)
+    {
+      MoveSweptObject(obj, endPosition);
+      continue;
+    }
+
+    // Refine time of impact, keeping the object in contact so the narrowphase will find it
+    for (size_t i = 0; i < CCD_REFINEMENT_ITERATIONS; ++i)
+    {
+      float fraction = 0.5f * (clearFraction + hitFraction);
+      MoveSweptObject(obj, body.startPosition + motion * fraction);
+
+      if (collidesWithTarget())
+        hitFraction = fraction;
+      else
+        clearFraction = fraction;
+    }
+
+    MoveSweptObject(obj, body.startPosition + motion * hitFraction);
+    m_lastStepProfile.numTimeOfImpacts++;
+  }
+}
+
+/**
+ * @brief Sets the position of an object being swept by continuous collision detection.
+ * @param obj Object to move
+ * @param position New position
+ */
+void PhysicsEngine::MoveSweptObject(PhysicsObject *obj, const Vector3 &position)
+{
+  obj->PositionRef() = position;
+  obj->m_wsTransformInvalidated = true;
+  obj->m_wsAabbInvalidated = true;
+}
+
+/**
+ * @brief Checks if any collision shape of an object overlaps any collision shape of another object.
+ * @param colDetect Collision detection to use
+ * @param obj First object
+ * @param other Second object
+ * @return True if the objects overlap
+ *
+ * Stops at the first overlapping pair of shapes and generates no contact data.
+ */
+bool PhysicsEngine::ObjectsOverlap(CollisionDetectionSAT &colDetect, PhysicsObject *obj, PhysicsObject *other)
+{
+  for (auto aIt = obj->CollisionShapesBegin(); aIt != obj->CollisionShapesEnd(); ++aIt)
+  {
+    for (auto bIt = other->CollisionShapesBegin(); bIt != other->CollisionShapesEnd(); ++bIt)
+    {
+      colDetect.BeginNewPair(obj, other, *aIt, *bIt);
+      if (colDetect.AreColliding())
+        return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Handle narrowphase collision detection.
+ *
+ * Broadphase pairs are split across OpenMP threads, each with its own SAT context and output buffer. The buffers are
+ * merged back into pair order and collision callbacks are fired serially by DispatchNarrowPhaseContacts().
+ */
+void PhysicsEngine::NarrowPhaseCollisions()
+{
+  m_narrowphaseContacts.clear();
+
+  if (m_BroadphaseCollisionPairs.size() > 0)
+  {
+    // Broadphase debug draw, recorded here and drawn by DebugRender() as this may run on the physics thread
+    if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_BROADPHASE_PAIRS)
+    {
+      for (CollisionPair &cp : m_BroadphaseCollisionPairs)
+      {
+        m_debugPairLines.push_back(cp.pObjectA->GetPosition());
+        m_debugPairLines.push_back(cp.pObjectB->GetPosition());
+      }
+    }
+
+    // Update cached world space transforms up front so the worker threads only ever read them
+    for (PhysicsObject *obj : m_PhysicsObjects)
+      obj->GetWorldSpaceTransform();
+
+    size_t numThreads = (size_t)omp_get_max_threads();
+    if (m_narrowphaseBuffers.size() < numThreads)
+      m_narrowphaseBuffers.resize(numThreads);
+
+    const int numPairs = (int)m_BroadphaseCollisionPairs.size();
+
+#pragma omp parallel
+    {
+      std::vector<NarrowphaseContact> &buffer = m_narrowphaseBuffers[omp_get_thread_num()];
+      buffer.clear();
+
+      // Collision data to pass between detection and manifold generation stages.
+      NarrowphaseContact contact;
+
+      // Collision Detection Algorithm to use
+      CollisionDetectionSAT colDetect;
+
+      // Iterate over all possible collision pairs and perform accurate collision detection
+#pragma omp for schedule(dynamic, 16)
+      for (int i = 0; i < numPairs; ++i)
+      {
+        CollisionPair &cp = m_BroadphaseCollisionPairs[i];
+        contact.pairIndex = (size_t)i;
+
+        // Trigger pairs only need to know if any shapes overlap
+        if (cp.pObjectA->m_trigger || cp.pObjectB->m_trigger)
+        {
+          if (ObjectsOverlap(colDetect, cp.pObjectA, cp.pObjectB))
+          {
+            contact.trigger = true;
+            contact.manifold = nullptr;
+            contact.cached = false;
+            buffer.push_back(contact);
+          }
+
+          continue;
+        }
+
+        contact.trigger = false;
+
+        // Detect in handle order so the manifold cache key, and the object order the cached manifold matches persistent
+        // contacts in, do not depend on the order the broadphase reported the pair in
+        bool swap = cp.pObjectA->m_handle > cp.pObjectB->m_handle;
+        PhysicsObject *objA = swap ? cp.pObjectB : cp.pObjectA;
+        PhysicsObject *objB = swap ? cp.pObjectA : cp.pObjectB;
+
+        for (auto aIt = objA->CollisionShapesBegin(); aIt != objA->CollisionShapesEnd(); ++aIt)
+        {
+          for (auto bIt = objB->CollisionShapesBegin(); bIt != objB->CollisionShapesEnd(); ++bIt)
+          {
+            ICollisionShape *shapeA = *aIt;
+            ICollisionShape *shapeB = *bIt;
+
+            colDetect.BeginNewPair(objA, objB, shapeA, shapeB);
+
+            // Detects if the objects are colliding - Seperating Axis Theorem
+            if (colDetect.AreColliding(&contact.colData))
+            {
+              // Reuse the manifold from the previous step if there is one (pairs are unique so no other thread can be
+              // using the same cache entry)
+              contact.key = {objA, objB, shapeA, shapeB};
+              auto cacheIt = m_manifoldCache.find(contact.key);
+              contact.cached = (cacheIt != m_manifoldCache.end());
+
+              if (contact.cached)
+              {
+                contact.manifold = cacheIt->second.manifold;
+                cacheIt->second.lastStep = m_stepCount;
+              }
+              else
+              {
+                contact.manifold = new Manifold();
+              }
+
+              // Build full collision manifold, this is discarded during dispatch if a collision callback rejects the
+              // collision
+              contact.manifold->Initiate(objA, objB);
+
+              // Construct contact points that form the perimeter of the collision manifold
+              colDetect.GenContactPoints(contact.manifold);
+
+              buffer.push_back(contact);
+            }
+          }
+        }
+      }
+    }
+
+    // Merge thread buffers, sorting restores pair order (contacts from the same pair are always in the same buffer and
+    // in order, hence the stable sort)
+    for (size_t i = 0; i < numThreads; ++i)
+      m_narrowphaseContacts.insert(m_narrowphaseContacts.end(), m_narrowphaseBuffers[i].begin(), m_narrowphaseBuffers[i].end());
+
+    std::stable_sort(m_narrowphaseContacts.begin(), m_narrowphaseContacts.end(),
+                     [](const NarrowphaseContact &a, const NarrowphaseContact &b) { return a.pairIndex < b.pairIndex; });
+
+    DispatchNarrowPhaseContacts();
+  }
+}
+
+/**
+ * @brief Fires collision callbacks for the merged narrowphase output and collects the manifolds to be solved.
+ *
+ * Performed serially and in broadphase pair order so callbacks see the same sequence of events regardless of how many
+ * threads performed detection.
+ */
+void PhysicsEngine::DispatchNarrowPhaseContacts()
+{
+  for (NarrowphaseContact &contact : m_narrowphaseContacts)
+  {
+    CollisionPair &cp = m_BroadphaseCollisionPairs[contact.pairIndex];
+
+    if (contact.trigger)
+    {
+      if (cp.pObjectA->m_contactEventsEnabled || cp.pObjectB->m_contactEventsEnabled)
+        RecordContactPair(cp, nullptr);
+      continue;
+    }
+
+    CollisionData &colData = contact.colData;
+
+    // Record collision data to be drawn to the window by DebugRender() if requested
+    if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONNORMALS)
+    {
+      m_debugNormalLines.push_back(colData._pointOnPlane);
+      m_debugNormalLines.push_back(colData._pointOnPlane - colData._normal * colData._penetration);
+    }
+
+    // Check to see if any of the objects have collision callbacks that dont
+    // want the objects to physically collide
+    bool okA = cp.pObjectA->FireOnCollisionEvent(cp.pObjectA, cp.pObjectB);
+    bool okB = cp.pObjectB->FireOnCollisionEvent(cp.pObjectB, cp.pObjectA);
+
+    if (okA && okB)
+    {
+      if (cp.pObjectA->m_contactEventsEnabled || cp.pObjectB->m_contactEventsEnabled)
+      {
+        // Collision data is relative to the first object of the manifold
+        CollisionPair manifoldPair = {contact.manifold->NodeA(), contact.manifold->NodeB()};
+        RecordContactPair(manifoldPair, &colData);
+      }
+
+      // Add to list of manifolds that need solving
+      m_vpManifolds.push_back(contact.manifold);
+
+      if (!contact.cached)
+        m_manifoldCache[contact.key] = {contact.manifold, m_stepCount};
+    }
+    else
+    {
+      if (contact.cached)
+        m_manifoldCache.erase(contact.key);
+
+      delete contact.manifold;
+    }
+  }
+
+  m_narrowphaseContacts.clear();
+}
+
+/**
+ * @brief Records that a pair of objects is touching in the current step for contact event generation.
+ * @param cp Colliding object pair
+ * @param colData Collision data for one of the colliding shape pairs, nullptr for an overlap with a trigger
+ *
+ * Contacts arrive in broadphase pair order, so all shape pairs of an object pair are recorded consecutively and merged
+ * into a single entry holding the deepest contact.
+ */
+void PhysicsEngine::RecordContactPair(const CollisionPair &cp, const CollisionData *colData)
+{
+  // Order objects by handle so a pair has the same key regardless of broadphase order
+  bool swap = cp.pObjectA->m_handle > cp.pObjectB->m_handle;
+
+  ContactEvent pair;
+  pair.type = CONTACT_EVENT_PERSIST;
+  pair.objectA = swap ? cp.pObjectB->m_handle : cp.pObjectA->m_handle;
+  pair.objectB = swap ? cp.pObjectA->m_handle : cp.pObjectB->m_handle;
+  pair.trigger = (colData == nullptr);
+
+  if (colData != nullptr)
+  {
+    pair.point = colData->_pointOnPlane;
+    pair.normal = swap ? -colData->_normal : colData->_normal;
+    pair.penetration = colData->_penetration;
+  }
+  else
+  {
+    pair.point = Vector3(0.0f, 0.0f, 0.0f);
+    pair.normal = Vector3(0.0f, 0.0f, 0.0f);
+    pair.penetration = 0.0f;
+  }
+
+  if (!m_stepContactPairs.empty())
+  {
+    ContactEvent &last = m_stepContactPairs.back();
+    if (last.objectA == pair.objectA && last.objectB == pair.objectB)
+    {
+      if (pair.penetration < last.penetration)
+        last = pair;
+      return;
+    }
+  }
+
+  m_stepContactPairs.push_back(pair);
+}
+
+/**
+ * @brief Marks which pairs touching in the previous step are still touching if the narrowphase does not report them.
+ *
+ * Pairs of resting objects may be skipped by the broadphase, these are still touching. Must be called before the
+ * narrowphase as collisions wake objects.
+ */
+void PhysicsEngine::MarkRestingContactPairs()
+{
+  for (ContactEvent &pair : m_contactPairs)
+  {
+    PhysicsObject *a = m_registry.Get(pair.objectA);
+    PhysicsObject *b = m_registry.Get(pair.objectB);
+    bool resting = (a != nullptr && b != nullptr && a->m_atRest && b->m_atRest);
+
+    pair.type = resting ? CONTACT_EVENT_PERSIST : CONTACT_EVENT_END;
+  }
+}
+
+/**
+ * @brief Builds the contact events of the current step by comparing touching pairs with those of the previous step.
+ */
+void PhysicsEngine::GenerateContactEvents()
+{
+  m_contactEvents.clear();
+
+  auto pairLess = [](const ContactEvent &a, const ContactEvent &b) {
+    return (a.objectA != b.objectA) ? (a.objectA < b.objectA) : (a.objectB < b.objectB);
+  };
+  std::sort(m_stepContactPairs.begin(), m_stepContactPairs.end(), pairLess);
+
+  // Merge the two sorted pair lists
+  auto prevIt = m_contactPairs.begin();
+  auto currIt = m_stepContactPairs.begin();
+
+  while (prevIt != m_contactPairs.end() || currIt != m_stepContactPairs.end())
+  {
+    if (currIt == m_stepContactPairs.end() || (prevIt != m_contactPairs.end() && pairLess(*prevIt, *currIt)))
+    {
+      // Previous pairs are marked as ending unless they were resting (see MarkRestingContactPairs())
+      m_contactEvents.push_back(*prevIt++);
+    }
+    else if (prevIt == m_contactPairs.end() || pairLess(*currIt, *prevIt))
+    {
+      m_contactEvents.push_back(*currIt++);
+      m_contactEvents.back().type = CONTACT_EVENT_BEGIN;
+    }
+    else
+    {
+      m_contactEvents.push_back(*currIt++);
+      m_contactEvents.back().type = CONTACT_EVENT_PERSIST;
+      ++prevIt;
+    }
+  }
+
+  // Pairs still touching are compared against in the next step
+  m_contactPairs.clear();
+  for (const ContactEvent &event : m_contactEvents)
+  {
+    if (event.type != CONTACT_EVENT_END)
+      m_contactPairs.push_back(event);
+  }
+
+  m_stepContactPairs.clear();
+}
+
+/**
+ * @brief Fires the contact event callbacks of objects for all events generated in the last step.
+ *
+ * Objects are looked up by handle for each event, so callbacks may safely remove objects from the simulation.
+ */
+void PhysicsEngine::DispatchContactEvents()
+{
+  for (const ContactEvent &event : m_contactEvents)
+  {
+    PhysicsObject *a = m_registry.Get(event.objectA);
+    if (a != nullptr)
+      a->FireContactEvent(m_registry.Get(event.objectB), event);
+
+    // Looked up after the callbacks of the first object as they may have removed either object
+    PhysicsObject *b = m_registry.Get(event.objectB);
+    if (b != nullptr)
+      b->FireContactEvent(m_registry.Get(event.objectA), event.Mirrored());
+  }
+}
+
+/**
+ * @brief Removes repeated broadphase pairs (in either object order), keeping the first occurrence of each.
+ *
+ * Some broadphases may report a pair more than once (e.g. once per region both objects share). Solving the same contact
+ * more than once is incorrect and the narrowphase relies on pairs being unique to share cached manifolds between threads.
+ * Pairs are keyed on the step indices of their objects in a hash set that keeps its storage between steps.
+ */
+void PhysicsEngine::RemoveDuplicatePairs()
+{
+  const size_t numPairs = m_BroadphaseCollisionPairs.size();
+  if (numPairs < 2)
+    return;
+
+  m_pairCache.clear();
+  m_pairCache.reserve(numPairs);
+
+  // Compact in place, preserving the original pair order
+  size_t n = 0;
+  for (size_t i = 0; i < numPairs; ++i)
+  {
+    const CollisionPair &cp = m_BroadphaseCollisionPairs[i];
+    uint64_t a = (uint64_t)cp.pObjectA->m_stepIndex;
+    uint64_t b = (uint64_t)cp.pObjectB->m_stepIndex;
+    uint64_t key = (a < b) ? ((a << 32) | b) : ((b << 32) | a);
+
+    if (!m_pairCache.insert(key).second)
+      continue;
+
+    if (n != i)
+      m_BroadphaseCollisionPairs[n] = cp;
+    ++n;
+  }
+
+  m_BroadphaseCollisionPairs.resize(n);
+}
+
+/**
+ * @brief Deletes cached manifolds for shapes that were not colliding in the current step.
+ */
+void PhysicsEngine::RemoveStaleManifolds()
+{
+  for (auto it = m_manifoldCache.begin(); it != m_manifoldCache.end();)
+  {
+    if (it->second.lastStep != m_stepCount)
+    {
+      delete it->second.manifold;
+      it = m_manifoldCache.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Deletes cached manifolds involving a given object.
+ * @param obj Object being removed from the simulation
+ */
+void PhysicsEngine::RemoveCachedManifolds(PhysicsObject *obj)
+{
+  for (auto it = m_manifoldCache.begin(); it != m_manifoldCache.end();)
+  {
+    if (it->first.objA == obj || it->first.objB == obj)
+    {
+      Manifold *m = it->second.manifold;
+      m_vpManifolds.erase(std::remove(m_vpManifolds.begin(), m_vpManifolds.end(), m), m_vpManifolds.end());
+
+      delete m;
+      it = m_manifoldCache.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Deletes all cached manifolds.
+ */
+void PhysicsEngine::ClearManifoldCache()
+{
+  for (auto &entry : m_manifoldCache)
+    delete entry.second.manifold;
+  m_manifoldCache.clear();
+}
+
+/**
+ * @brief Draw visual debug information.
+ *
+ * Debug data from the last physics step is only ever sent to NCLDebug from here (while holding the simulation lock), as
+ * steps may be performed on the physics thread.
+ */
+void PhysicsEngine::DebugRender()
 {
-  auto it = std::find_if(m_PhysicsObjects.begin(), m_PhysicsObjects.end(), [name](PhysicsObject *o) {
-    Object *po = o->GetAssociatedObject();
-    return (po != nullptr && po->GetName() == name);
-  });
+  std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
+
+  // Draw broadphase state
+  if (m_broadphaseDetection != nullptr && (m_DebugDrawFlags & DEBUGDRAW_FLAGS_BROADPHASE))
+    m_broadphaseDetection->DebugDraw();
+
+  // Draw broadphase pairs
+  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_BROADPHASE_PAIRS)
+  {
+    for (size_t i = 0; i + 1 < m_debugPairLines.size(); i += 2)
+    {
+      NCLDebug::DrawThickLine(m_debugPairLines[i], m_debugPairLines[i + 1], 0.02f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+      NCLDebug::DrawPointNDT(m_debugPairLines[i], 0.05f, Vector4(0.0f, 1.0f, 0.5f, 1.0f));
+      NCLDebug::DrawPointNDT(m_debugPairLines[i + 1], 0.05f, Vector4(0.0f, 1.0f, 0.5f, 1.0f));
+    }
+  }
+
+  // Draw collision normals
+  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONNORMALS)
+  {
+    for (size_t i = 0; i + 1 < m_debugNormalLines.size(); i += 2)
+    {
+      NCLDebug::DrawPointNDT(m_debugNormalLines[i], 0.1f, Vector4(0.5f, 0.5f, 1.0f, 1.0f));
+      NCLDebug::DrawThickLineNDT(m_debugNormalLines[i], m_debugNormalLines[i + 1], 0.05f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+    }
+  }
+
+  // Draw all collision manifolds
+  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_MANIFOLD)
+  {
+    for (Manifold *m : m_vpManifolds)
+      m->DebugDraw();
+  }
+
+  // Draw all constraints
+  if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_CONSTRAINT)
+  {
+    for (IConstraint *c : m_vpConstraints)
+      c->DebugDraw();
+  }
+
+  // Draw all objects and collision shapes
+  for (PhysicsObject *obj : m_PhysicsObjects)
+  {
+    obj->DebugDraw(m_DebugDrawFlags);
+
+    if (m_DebugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONVOLUMES)
+    {
+      for (auto it = obj->CollisionShapesBegin(); it != obj->CollisionShapesEnd(); ++it)
+        (*it)->DebugDraw(obj);
+    }
+  }
+}
 
-  return (it == m_PhysicsObjects.end()) ? nullptr : *it;
+/**
+ * @brief Checks if all physics objects in the system have the at rest flags set.
+ * @return True if all objects are flagged as at rest
+ *
+ * Mainly added for debugging.
+ */
+bool PhysicsEngine::SimulationIsAtRest() const
+{
+  auto firstObjectNotAtRest =
+      std::find_if(m_PhysicsObjects.begin(), m_PhysicsObjects.end(), [](PhysicsObject *o) { return o->IsAwake(); });
+  return (firstObjectNotAtRest == m_PhysicsObjects.end());
 }
@@ -43,16 +43,58 @@ The general runtime consists of:
 
 #pragma once
 
+#include "BarnesHutTree.h"
+#include "BatchIntegrator.h"
+#include "CollisionDetectionSAT.h"
+#include "DisjointSet.h"
+#include "GraphColouredSolver.h"
 #include "IBroadphase.h"
 #include "IConstraint.h"
+#include "IntegrationHelpers.h"
 #include "Manifold.h"
+#include "PhysicsCommandQueue.h"
 #include "PhysicsObject.h"
+#include "PhysicsProfile.h"
+#include "PhysicsWorldSnapshot.h"
+#include "SolverBody.h"
 #include "TSingleton.h"
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+/**
+ * @brief Default maximum number of constraint solver iterations per physics step.
+ */
 #define SOLVER_ITERATIONS 50
 
+/**
+ * @brief Default minimum number of constraint solver iterations per physics step.
+ */
+#define SOLVER_MIN_ITERATIONS 4
+
+/**
+ * @brief Default largest impulse magnitude in a solver iteration at which the solver is considered converged.
+ */
+#define SOLVER_CONVERGENCE_THRESHOLD 1e-6f
+
+/**
+ * @brief Fraction of the previous step's contact impulse reapplied to a persistent contact when warm starting.
+ *
+ * Applies to all solvers. Reapplying the full impulse overshoots when objects have moved since the previous step or the
+ * constraints are solved in a different order (e.g. graph coloured batches), which keeps stacks and pyramids from
+ * settling.
+ */
+constexpr float WARM_START_FACTOR = 0.7f;
+
+/**
+ * @brief Number of bisection iterations used to refine the time of impact found by continuous collision detection.
+ */
+#define CCD_REFINEMENT_ITERATIONS 4
+
 #ifndef FALSE
 #define FALSE 0
 #define TRUE 1
@@ -69,19 +111,76 @@ The general runtime consists of:
 #define DEBUGDRAW_FLAGS_BROADPHASE_PAIRS 256
 
 /**
- * @brief Represents different integration schemes.
+ * @brief Represents different constraint solver modes.
+ */
+enum SolverType
+{
+  SOLVER_SEQUENTIAL,    //!< Sequential Gauss-Seidel (per island when island solving is enabled)
+  SOLVER_GRAPH_COLOURED //!< Gauss-Seidel over colour batches of independent constraints, each batch solved in parallel
+};
+
+/**
+ * @brief Result of narrowphase detection for a single pair of collision shapes.
  */
-enum IntegrationType
+struct NarrowphaseContact
 {
-  INTEGRATION_EXPLICIT_EULER,
-  INTEGRATION_SEMI_IMPLICIT_EULER,
-  INTEGRATION_RUNGE_KUTTA_2,
-  INTEGRATION_RUNGE_KUTTA_4
+  size_t pairIndex;      //!< Index of the broadphase pair the shapes belong to
+  CollisionData colData; //!< Collision data from detection
+  ManifoldKey key;       //!< Key of the manifold in the manifold cache
+  Manifold *manifold;    //!< Generated manifold
+  bool cached;           //!< Flag indicating if the manifold was reused from the manifold cache
+  bool trigger;          //!< Flag indicating the shapes overlap a trigger, only pairIndex is valid
+};
+
+/**
+ * @brief Object with continuous collision detection enabled that is moving in the current step.
+ */
+struct ContinuousCollisionBody
+{
+  PhysicsObject *object; //!< Object
+  Vector3 startPosition; //!< Position of the object at the start of integration
+};
+
+/**
+ * @brief Group of objects connected through contacts or constraints, solved independently of all other islands.
+ */
+struct SimulationIsland
+{
+  std::vector<PhysicsObject *> bodies;    //!< Non static objects in the island
+  std::vector<Manifold *> manifolds;      //!< Contact constraints in the island
+  std::vector<IConstraint *> constraints; //!< Misc constraints in the island
+  size_t solverIterations;                //!< Number of solver iterations performed on the island in the current step
+};
+
+/**
+ * @brief Entry in the persistent manifold cache.
+ */
+struct CachedManifold
+{
+  Manifold *manifold; //!< Persistent manifold
+  uint64_t lastStep;  //!< Last physics step in which the shapes were colliding
+};
+
+/**
+ * @brief Work done and time taken by a world over a batch of physics steps (see PhysicsEngine::Step()).
+ */
+struct WorldStepStats
+{
+  size_t numSteps;            //!< Number of physics steps performed
+  float wallMs;               //!< Wall clock time taken to perform all steps
+  size_t numBroadphasePairs;  //!< Number of broadphase pairs summed over all steps
+  size_t numSolverIterations; //!< Number of solver iterations summed over all steps
+  bool atRest;                //!< Flag indicating if every object was at rest after the last step
+  PhysicsProfile profile;     //!< Stage timings and counts summed over all steps (only if profiling is enabled)
 };
 
 /**
  * @class PhysicsEngine
- * @brief Manages simulation of a physical system.
+ * @brief Manages simulation of a physical system (world).
+ *
+ * Instance() gives the default world used by scenes, further independent worlds can be created and destroyed directly.
+ * Worlds share no state, so different worlds may be updated from different threads at the same time (see
+ * UpdateWorlds()). Objects created through Object::CreatePhysicsNode() join the default world unless told otherwise.
  */
 class PhysicsEngine : public TSingleton<PhysicsEngine>
 {
@@ -93,7 +192,13 @@ public:
    */
   const uint8_t MAX_UPDATES_PER_FRAME = 5;
 
+  static void UpdateWorlds(const std::vector<PhysicsEngine *> &worlds, float deltaTime);
+  static std::vector<WorldStepStats> StepWorlds(const std::vector<PhysicsEngine *> &worlds, size_t numSteps);
+
 public:
+  PhysicsEngine();
+  ~PhysicsEngine();
+
   void SetDefaults();
 
   void AddPhysicsObject(PhysicsObject *obj);
@@ -106,10 +211,83 @@ public:
    */
   void AddConstraint(IConstraint *c)
   {
+    std::lock_guard<std::recursive_mutex> lock(m_simulationMutex);
     m_vpConstraints.push_back(c);
   }
 
+  /**
+   * @brief Gets all physical objects in the simulation.
+   * @return Physics objects
+   */
+  inline const std::vector<PhysicsObject *> &GetPhysicsObjects() const
+  {
+    return m_PhysicsObjects;
+  }
+
+  /**
+   * @brief Gets the number of misc constraints in the simulation.
+   * @return Number of constraints
+   */
+  inline size_t NumConstraints() const
+  {
+    return m_vpConstraints.size();
+  }
+
   void Update(float deltaTime);
+  WorldStepStats Step(size_t numSteps);
+
+  /**
+   * @brief Queues a mutation of the world to be applied by the thread stepping the simulation.
+   * @param command Command to queue, invoked with this world
+   *
+   * May be called from any thread without locking. Commands are applied in the order they were queued, at the start of
+   * the next update or physics step (including while paused), so they never run while a step is in progress.
+   */
+  inline void QueueCommand(PhysicsCommand command)
+  {
+    m_commandQueue.Push(std::move(command));
+  }
+
+  void SaveSnapshot(PhysicsWorldSnapshot &snapshot);
+  bool RestoreSnapshot(const PhysicsWorldSnapshot &snapshot);
+
+  void StartPhysicsThread();
+  void StopPhysicsThread();
+
+  /**
+   * @brief Checks if the simulation is stepped on a dedicated physics thread.
+   * @return True if the physics thread is running
+   */
+  inline bool IsPhysicsThreadRunning() const
+  {
+    return m_physicsThreadRunFlag;
+  }
+
+  /**
+   * @brief Gets the mutex held by the physics thread while it steps the simulation.
+   * @return Simulation mutex
+   *
+   * Must be held by any other thread accessing objects or constraints in the simulation while the physics thread is
+   * running. The engine locks it itself when objects or constraints are added or removed. Threads that only need to
+   * modify the simulation can use QueueCommand() instead.
+   */
+  inline std::recursive_mutex &SimulationMutex()
+  {
+    return m_simulationMutex;
+  }
+
+  /**
+   * @brief Gets the mutex guarding the transform snapshot published by the physics thread.
+   * @return Snapshot mutex
+   *
+   * Must be held while calling GetSnapshotAlpha() and PhysicsObject::GetSnapshotWorldSpaceTransform().
+   */
+  inline std::mutex &SnapshotMutex()
+  {
+    return m_snapshotMutex;
+  }
+
+  float GetSnapshotAlpha() const;
 
   void DebugRender();
 
@@ -196,6 +374,67 @@ public:
     return m_broadphaseCollisionPairCount;
   }
 
+  /**
+   * @brief Gets the number of constraint solver iterations performed in this update (over all possible frames).
+   * @return Number of solver iterations
+   */
+  inline size_t NumSolverIterations() const
+  {
+    return m_solverIterationCount;
+  }
+
+  /**
+   * @brief Gets the number of constraint solver iterations performed in the last physics step.
+   * @return Number of solver iterations
+   *
+   * When islands are solved separately this is the largest number of iterations taken by any island.
+   */
+  inline size_t NumLastStepSolverIterations() const
+  {
+    return m_lastStepSolverIterations;
+  }
+
+  /**
+   * @brief Checks if the time spent in each stage of a physics step is measured.
+   * @return True if profiling is enabled
+   */
+  inline bool IsProfilingEnabled() const
+  {
+    return m_profilingEnabled;
+  }
+
+  /**
+   * @brief Sets if the time spent in each stage of a physics step is measured.
+   * @param enabled True to enable profiling
+   */
+  void SetProfilingEnabled(bool enabled)
+  {
+    m_profilingEnabled = enabled;
+  }
+
+  /**
+   * @brief Gets the stage timings and counts of the last physics step.
+   * @return Last step profile
+   *
+   * Only valid on the thread updating the physics engine, use GetUpdateProfile() from other threads.
+   */
+  inline const PhysicsProfile &GetLastStepProfile() const
+  {
+    return m_lastStepProfile;
+  }
+
+  /**
+   * @brief Gets the stage timings and counts summed over all physics steps in the last update that performed any.
+   * @return Update profile
+   *
+   * Safe to call from any thread.
+   */
+  PhysicsProfile GetUpdateProfile() const
+  {
+    std::lock_guard<std::mutex> lock(m_updateProfileMutex);
+    return m_updateProfile;
+  }
+
   /**
    * @brief Gets the current integration scheme.
    * @return Integration scheme
@@ -234,6 +473,83 @@ public:
     m_LinearGravity = g;
   }
 
+  /**
+   * @brief Checks if all movable objects attract each other through N-body gravitation.
+   * @return True if N-body gravitation is enabled
+   */
+  inline bool IsNBodyGravityEnabled() const
+  {
+    return m_nBodyGravityEnabled;
+  }
+
+  /**
+   * @brief Sets if all movable objects attract each other through N-body gravitation.
+   * @param enabled True to enable N-body gravitation
+   *
+   * Forces are approximated with a Barnes-Hut octree rebuilt every step and scaled by the gravitation constant. Applied in
+   * addition to linear gravity and gravitation targets, immovable objects neither attract nor are attracted.
+   */
+  void SetNBodyGravityEnabled(bool enabled)
+  {
+    m_nBodyGravityEnabled = enabled;
+  }
+
+  /**
+   * @brief Gets the Barnes-Hut opening angle used for N-body gravitation.
+   * @return Opening angle
+   */
+  inline float GetNBodyOpeningAngle() const
+  {
+    return m_nBodyOpeningAngle;
+  }
+
+  /**
+   * @brief Sets the Barnes-Hut opening angle used for N-body gravitation.
+   * @param angle Largest ratio of octree node width to distance at which a node is treated as a single mass
+   *
+   * Zero gives exact (O(n^2)) forces, larger values are faster but less accurate. Typical values are 0.3 to 1.0.
+   */
+  void SetNBodyOpeningAngle(float angle)
+  {
+    m_nBodyOpeningAngle = angle;
+  }
+
+  /**
+   * @brief Gets the softening length used for N-body gravitation.
+   * @return Softening length
+   */
+  inline float GetNBodySoftening() const
+  {
+    return m_nBodySoftening;
+  }
+
+  /**
+   * @brief Sets the softening length used for N-body gravitation.
+   * @param softening Distance below which the attraction between two objects is limited
+   */
+  void SetNBodySoftening(float softening)
+  {
+    m_nBodySoftening = softening;
+  }
+
+  /**
+   * @brief Gets the gravitation constant used for gravity between movable objects.
+   * @return Gravitation constant
+   */
+  inline float GetGravitationConstant() const
+  {
+    return m_PointGravitation;
+  }
+
+  /**
+   * @brief Sets the gravitation constant used for gravity between movable objects.
+   * @param g Gravitation constant
+   */
+  void SetGravitationConstant(float g)
+  {
+    m_PointGravitation = g;
+  }
+
   /**
    * @brief Gets the target update time step in seconds.
    * @return Target update timestep
@@ -243,26 +559,294 @@ public:
     return m_UpdateTimestep;
   }
 
+  /**
+   * @brief Checks if accumulated contact impulses are carried over between physics steps.
+   * @return True if warm starting is enabled
+   */
+  inline bool IsWarmStartingEnabled() const
+  {
+    return m_warmStartingEnabled;
+  }
+
+  /**
+   * @brief Sets if accumulated contact impulses are carried over between physics steps.
+   * @param enabled True to enable warm starting
+   *
+   * Manifolds are always persistent, when warm starting is disabled the accumulated impulses are reset each step. When
+   * enabled WARM_START_FACTOR of the previous impulse is reapplied.
+   */
+  void SetWarmStartingEnabled(bool enabled)
+  {
+    m_warmStartingEnabled = enabled;
+  }
+
+  /**
+   * @brief Gets the number of manifolds held in the persistent manifold cache.
+   * @return Number of cached manifolds
+   */
+  inline size_t NumCachedManifolds() const
+  {
+    return m_manifoldCache.size();
+  }
+
+  /**
+   * @brief Gets the contact events generated in the last physics step.
+   * @return Contact events, ordered by object handles
+   *
+   * Only pairs in which at least one object has contact events enabled are reported (see
+   * PhysicsObject::SetContactEventsEnabled()). The same events are dispatched to object callbacks after each step.
+   */
+  inline const std::vector<ContactEvent> &GetContactEvents() const
+  {
+    return m_contactEvents;
+  }
+
+  /**
+   * @brief Gets the constraint solver mode.
+   * @return Solver mode
+   */
+  inline SolverType GetSolverType() const
+  {
+    return m_solverType;
+  }
+
+  /**
+   * @brief Sets the constraint solver mode.
+   * @param type Solver mode
+   *
+   * The graph coloured solver solves all constraints together, island solving is only used with the sequential solver.
+   */
+  void SetSolverType(SolverType type)
+  {
+    m_solverType = type;
+  }
+
+  /**
+   * @brief Gets the number of constraint solver iterations that are always performed per step.
+   * @return Minimum solver iterations
+   */
+  inline size_t GetMinSolverIterations() const
+  {
+    return m_minSolverIterations;
+  }
+
+  /**
+   * @brief Gets the largest number of constraint solver iterations performed per step.
+   * @return Maximum solver iterations
+   */
+  inline size_t GetMaxSolverIterations() const
+  {
+    return m_maxSolverIterations;
+  }
+
+  void SetSolverIterationLimits(size_t minIterations, size_t maxIterations);
+
+  /**
+   * @brief Gets the impulse magnitude below which the constraint solver is considered converged.
+   * @return Convergence threshold
+   */
+  inline float GetSolverConvergenceThreshold() const
+  {
+    return m_solverConvergenceThreshold;
+  }
+
+  /**
+   * @brief Sets the impulse magnitude below which the constraint solver is considered converged.
+   * @param threshold Convergence threshold
+   *
+   * Once the minimum number of iterations have been performed the solver stops after the first iteration in which no
+   * constraint applied an impulse larger than this. A threshold of zero always performs the maximum number of iterations.
+   */
+  void SetSolverConvergenceThreshold(float threshold)
+  {
+    m_solverConvergenceThreshold = threshold;
+  }
+
+  /**
+   * @brief Gets the solver state of an object in the simulation for the current physics step.
+   * @param obj Object to get solver body of
+   * @return Pointer to solver body, NULL if the object is not in the simulation
+   *
+   * Only valid while constraints are being solved, constraints must read and modify velocities through the solver body
+   * as they are only written back to the objects once the solver has finished.
+   */
+  inline SolverBody *GetSolverBody(const PhysicsObject *obj)
+  {
+    if (obj == NULL || obj->m_stepIndex >= m_solverBodies.size() || m_PhysicsObjects[obj->m_stepIndex] != obj)
+      return NULL;
+
+    return &m_solverBodies[obj->m_stepIndex];
+  }
+
+  /**
+   * @brief Gets the graph coloured solver.
+   * @return Reference to graph coloured solver
+   */
+  inline const GraphColouredSolver &GetColouredSolver() const
+  {
+    return m_colouredSolver;
+  }
+
+  /**
+   * @brief Checks if independent simulation islands are solved in parallel.
+   * @return True if island solving is enabled
+   */
+  inline bool IsIslandSolvingEnabled() const
+  {
+    return m_islandSolvingEnabled;
+  }
+
+  /**
+   * @brief Sets if independent simulation islands are solved in parallel.
+   * @param enabled True to enable island solving
+   *
+   * Islands are only used if every constraint reports the objects it affects, otherwise all constraints are solved
+   * together.
+   */
+  void SetIslandSolvingEnabled(bool enabled)
+  {
+    m_islandSolvingEnabled = enabled;
+  }
+
+  /**
+   * @brief Checks if the objects in an island are put to sleep and woken together.
+   * @return True if island sleeping is enabled
+   */
+  inline bool IsIslandSleepingEnabled() const
+  {
+    return m_islandSleepingEnabled;
+  }
+
+  /**
+   * @brief Sets if the objects in an island are put to sleep and woken together.
+   * @param enabled True to enable island sleeping
+   *
+   * When disabled each object sleeps based only on its own velocity.
+   */
+  void SetIslandSleepingEnabled(bool enabled)
+  {
+    m_islandSleepingEnabled = enabled;
+  }
+
+  /**
+   * @brief Gets the number of simulation islands found in the last physics step.
+   * @return Number of islands (zero if islands were not built)
+   */
+  inline size_t NumIslands() const
+  {
+    return m_numIslands;
+  }
+
   bool SimulationIsAtRest() const;
 
-  PhysicsObject *FindObjectByName(const std::string &name);
+  /**
+   * @brief Finds a physics object based on the name of its associated (parent) game object.
+   * @param name Name of the obeject to find
+   * @return Pointer to physics object (nullptr if not found)
+   */
+  inline PhysicsObject *FindObjectByName(const std::string &name) const
+  {
+    return m_registry.FindByName(name);
+  }
 
-protected:
-  PhysicsEngine();
-  ~PhysicsEngine();
+  /**
+   * @brief Finds a physics object by its handle.
+   * @param handle Object handle (see PhysicsObject::GetHandle())
+   * @return Pointer to physics object (nullptr if the object is no longer in the simulation)
+   */
+  inline PhysicsObject *FindObjectByHandle(PhysicsObjectHandle handle) const
+  {
+    return m_registry.Get(handle);
+  }
+
+  /**
+   * @brief Checks if object motion state is held in the contiguous body store.
+   * @return True if the body store is in use
+   */
+  inline bool IsBodyStoreEnabled() const
+  {
+    return m_bodyStoreEnabled;
+  }
+
+  void SetBodyStoreEnabled(bool enabled);
+
+  /**
+   * @brief Checks if awake bodies are integrated together using SIMD lanes.
+   * @return True if batch integration is in use
+   */
+  inline bool IsBatchIntegrationEnabled() const
+  {
+    return m_batchIntegrationEnabled && m_bodyStoreEnabled;
+  }
+
+  void SetBatchIntegrationEnabled(bool enabled);
+
+  /**
+   * @brief Gets the batch integrator.
+   * @return Reference to batch integrator
+   */
+  inline BatchIntegrator &GetBatchIntegrator()
+  {
+    return m_batchIntegrator;
+  }
 
+protected:
   void UpdatePhysics();
+  void AdvanceTime(float deltaTime);
+  void PerformStep(PhysicsProfile &updateProfile);
+  void ApplyCommands();
+  void SetUpdateProfile(const PhysicsProfile &updateProfile);
+  void PublishSnapshot(bool keepPrevious);
+  void PhysicsThreadFunc();
+  bool ValidateSnapshot(const PhysicsWorldSnapshot &snapshot) const;
+  void RemoveDuplicatePairs();
   void NarrowPhaseCollisions();
-  void UpdatePhysicsObject(PhysicsObject *obj);
-  void SolveConstraints();
+  void DispatchNarrowPhaseContacts();
+  void RemoveStaleManifolds();
+  void RemoveCachedManifolds(PhysicsObject *obj);
+  void RecordContactPair(const CollisionPair &cp, const CollisionData *colData);
+  void MarkRestingContactPairs();
+  void GenerateContactEvents();
+  void DispatchContactEvents();
+  void ClearManifoldCache();
+  void UpdateObjects();
+  template <IntegrationType Type> void UpdateObjects();
+  template <IntegrationType Type> void UpdateBodyStore();
+  void MoveKinematicObject(PhysicsObject *obj, Vector3 &position, Quaternion &orientation, const Vector3 &linearVelocity,
+                           const Vector3 &angularVelocity);
+  void ApplyGravity(PhysicsObject *obj, Vector3 &linearVelocity);
+  void ComputeNBodyGravity();
+  void BeginContinuousCollisions();
+  void SolveContinuousCollisions();
+  void MoveSweptObject(PhysicsObject *obj, const Vector3 &position);
+  bool ObjectsOverlap(CollisionDetectionSAT &colDetect, PhysicsObject *obj, PhysicsObject *other);
+  bool BuildIslands();
+  bool LinkIsland(PhysicsObject *a, PhysicsObject *b);
+  PhysicsObject *IslandOwner(PhysicsObject *a, PhysicsObject *b) const;
+  void BuildSolverBodies();
+  void WriteBackSolverBodies();
+  void SolveIslands();
+  void UpdateIslandSleeping();
+  void ProfileCounts();
+  size_t SolveConstraints(std::vector<Manifold *> &manifolds, std::vector<IConstraint *> &constraints);
 
 protected:
   bool m_IsPaused; //!< Flag indicating phsyics updates are paused
 
   float m_UpdateTimestep; //!< Target update timestep in seconds
   float m_UpdateAccum;    //!< Accumulated time over the frame
+  uint64_t m_stepCount;   //!< Number of physics steps performed
 
-  uint64_t m_DebugDrawFlags; //!< Debug draw state flags
+  std::thread m_physicsThread;                          //!< Thread stepping the simulation when running threaded
+  std::atomic_bool m_physicsThreadRunFlag;              //!< Flag indicating the physics thread should run
+  std::recursive_mutex m_simulationMutex;               //!< Mutex held while the simulation is stepped or modified
+  std::mutex m_snapshotMutex;                           //!< Mutex guarding the published transform snapshot
+  std::chrono::steady_clock::time_point m_snapshotTime; //!< Time the latest snapshot was published
+  PhysicsCommandQueue m_commandQueue;                   //!< Mutations queued from other threads
+
+  uint64_t m_DebugDrawFlags;               //!< Debug draw state flags
+  std::vector<Vector3> m_debugPairLines;   //!< Start and end of a line between each broadphase pair in the last step
+  std::vector<Vector3> m_debugNormalLines; //!< Start and end of each collision normal found in the last step
 
   IntegrationType m_integrationType; //!< Type of integration performed in object updates
 
@@ -270,12 +854,67 @@ protected:
   float m_PointGravity;     //!< Acceleration due to point gravity (one object is stationary)
   float m_PointGravitation; //!< Gravitation constant for point gravity (both objects are movable)
 
+  bool m_nBodyGravityEnabled;                //!< Flag indicating if all movable objects attract each other
+  float m_nBodyOpeningAngle;                 //!< Barnes-Hut opening angle for N-body gravitation
+  float m_nBodySoftening;                    //!< Softening length for N-body gravitation
+  BarnesHutTree m_gravityTree;               //!< Mass octree used to approximate N-body gravitation
+  std::vector<Vector3> m_nBodyPositions;     //!< Position of each object at the start of the step
+  std::vector<float> m_nBodyMasses;          //!< Mass of each object (zero if immovable)
+  std::vector<Vector3> m_nBodyAccelerations; //!< N-body gravitational acceleration of each object
+
   IBroadphase *m_broadphaseDetection;                    //!< Handler used to find broadphase collision pairs
   std::vector<CollisionPair> m_BroadphaseCollisionPairs; //!< Set of collision paris found in broadphase
   size_t m_broadphaseCollisionPairCount;                 //!< Cached count of braoadphase collision pairs
+  std::unordered_set<uint64_t> m_pairCache;              //!< Keys of pairs already seen when removing duplicate pairs
+
+  std::vector<std::vector<NarrowphaseContact>> m_narrowphaseBuffers; //!< Per thread narrowphase output
+  std::vector<NarrowphaseContact> m_narrowphaseContacts;             //!< Merged narrowphase output in pair order
 
   std::vector<PhysicsObject *> m_PhysicsObjects; //!< All physical objects in the simulation
+  PhysicsObjectRegistry m_registry;              //!< Handle and name lookup of objects in the simulation
+
+  bool m_bodyStoreEnabled;      //!< Flag indicating if object motion state is held in m_bodyStore
+  PhysicsBodyStore m_bodyStore; //!< Contiguous storage for object motion state
+
+  bool m_batchIntegrationEnabled;         //!< Flag indicating if awake bodies are integrated using m_batchIntegrator
+  BatchIntegrator m_batchIntegrator;      //!< Integrator operating on groups of bodies in m_bodyStore
+  std::vector<size_t> m_awakeBodyIndices; //!< Store indices of awake bodies in the current step
+
+  std::vector<ContinuousCollisionBody> m_ccdBodies; //!< Moving objects with continuous collision detection enabled
+  std::vector<PhysicsObject *> m_ccdCandidates;     //!< Objects found along the path of a swept object
+  std::vector<PhysicsObject *> m_ccdTargets;        //!< Objects a swept object is tested against
 
   std::vector<IConstraint *> m_vpConstraints; //!< Misc constraints applying to one or more physics objects
   std::vector<Manifold *> m_vpManifolds;      //!< Contact constraints between pairs of objects
+  std::vector<SolverBody> m_solverBodies;     //!< Solver state of each object in the current step
+
+  bool m_warmStartingEnabled;                            //!< Flag indicating if contact impulses are carried between steps
+  std::map<ManifoldKey, CachedManifold> m_manifoldCache; //!< Persistent manifolds between pairs of collision shapes
+
+  std::vector<ContactEvent> m_contactPairs;     //!< Touching pairs with contact events in the previous step, by handle
+  std::vector<ContactEvent> m_stepContactPairs; //!< Touching pairs with contact events in the current step
+  std::vector<ContactEvent> m_contactEvents;    //!< Contact events generated in the last step
+
+  SolverType m_solverType;              //!< Constraint solver mode
+  GraphColouredSolver m_colouredSolver; //!< Solver used in SOLVER_GRAPH_COLOURED mode
+
+  size_t m_minSolverIterations;       //!< Number of solver iterations always performed per step
+  size_t m_maxSolverIterations;       //!< Largest number of solver iterations performed per step
+  float m_solverConvergenceThreshold; //!< Largest impulse in an iteration at which the solver has converged
+  size_t m_lastStepSolverIterations;  //!< Number of solver iterations performed in the last step
+  size_t m_solverIterationCount;      //!< Cached count of solver iterations
+
+  bool m_profilingEnabled;                 //!< Flag indicating if stage timings are measured
+  PhysicsProfile m_lastStepProfile;        //!< Stage timings and counts of the last physics step
+  PhysicsProfile m_updateProfile;          //!< Stage timings and counts over all physics steps in the last update
+  mutable std::mutex m_updateProfileMutex; //!< Mutex guarding access to m_updateProfile
+
+  bool m_islandSolvingEnabled;             //!< Flag indicating if islands are solved in parallel
+  bool m_islandSleepingEnabled;            //!< Flag indicating if islands sleep and wake as a whole
+  DisjointSet m_islandSet;                 //!< Union-find set over object indices used to detect islands
+  std::vector<size_t> m_islandRootIndices; //!< Island index for each root in m_islandSet
+  std::vector<SimulationIsland> m_islands; //!< Island storage (only the first m_numIslands are valid)
+  size_t m_numIslands;                     //!< Number of islands found in the current step
+
+  std::vector<IConstraint *> m_staticConstraints; //!< Constraints between two static objects, solved after the islands
 };
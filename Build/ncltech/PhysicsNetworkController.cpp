@@ -13,9 +13,16 @@ const std::string PhysicsNetworkController::ORIENTATION_NAME = "orientation";
 const std::string PhysicsNetworkController::ANGULAR_VEL_NAME = "ang_vel";
 const std::string PhysicsNetworkController::TORQUE_NAME = "torque";
 
-PhysicsNetworkController::PhysicsNetworkController(PubSubBroker *broker)
+/**
+ * @brief Creates a new physics network controller.
+ * @param broker Broker to subscribe to
+ * @param world World to control, nullptr for the default world
+ */
+PhysicsNetworkController::PhysicsNetworkController(PubSubBroker *broker, PhysicsEngine *world)
     : IPubSubClient(broker)
+    , m_world((world != nullptr) ? world : PhysicsEngine::Instance())
     , m_collisionUpdateThreadRunFlag(true)
+    , m_profilePublishEnabled(false)
 {
   // Subscribe to topics
   if (broker != nullptr)
@@ -24,6 +31,7 @@ PhysicsNetworkController::PhysicsNetworkController(PubSubBroker *broker)
     broker->Subscribe(this, "physics/get");
     broker->Subscribe(this, "physics/set");
     broker->Subscribe(this, "physics/collsub");
+    broker->Subscribe(this, "physics/profilesub");
   }
 }
 
@@ -40,82 +48,89 @@ bool PhysicsNetworkController::HandleSubscription(const std::string &topic, cons
   // Handle pause/resume
   if (topic == "physics/pause")
   {
-    PhysicsEngine::Instance()->SetPaused(((char *)msg)[0] == 'P');
+    bool paused = (((char *)msg)[0] == 'P');
+    m_world->QueueCommand([paused](PhysicsEngine &world) { world.SetPaused(paused); });
   }
   // Get physical property
   else if (topic == "physics/get")
   {
     std::vector<std::string> tokens = Utility::Split(std::string(msg), '.');
+    std::string name = tokens[0];
     std::string valueName = tokens[1];
 
-    // Find object
-    PhysicsObject *obj = PhysicsEngine::Instance()->FindObjectByName(tokens[0]);
-    if (obj == nullptr)
-      return false;
-
-    // Message
-    uint16_t len = 0;
-    char *data = nullptr;
+    std::function<std::string(PhysicsObject *)> getter;
 
     if (valueName == INV_MASS_NAME)
     {
-      len = sizeof(float);
-      data = new char[len];
-      float value = obj->GetInverseMass();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        float value = obj->GetInverseMass();
+        return std::string((const char *)&value, sizeof(float));
+      };
     }
     else if (valueName == POSITION_NAME)
     {
-      len = sizeof(Vector3);
-      data = new char[len];
-      Vector3 value = obj->GetPosition();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        Vector3 value = obj->GetPosition();
+        return std::string((const char *)&value, sizeof(Vector3));
+      };
     }
     else if (valueName == LINEAR_VELOCITY_NAME)
     {
-      len = sizeof(Vector3);
-      data = new char[len];
-      Vector3 value = obj->GetLinearVelocity();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        Vector3 value = obj->GetLinearVelocity();
+        return std::string((const char *)&value, sizeof(Vector3));
+      };
     }
     else if (valueName == FORCE_NAME)
     {
-      len = sizeof(Vector3);
-      data = new char[len];
-      Vector3 value = obj->GetForce();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        Vector3 value = obj->GetForce();
+        return std::string((const char *)&value, sizeof(Vector3));
+      };
     }
     else if (valueName == ORIENTATION_NAME)
     {
-      len = sizeof(Quaternion);
-      data = new char[len];
-      Quaternion value = obj->GetOrientation();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        Quaternion value = obj->GetOrientation();
+        return std::string((const char *)&value, sizeof(Quaternion));
+      };
     }
     else if (valueName == ANGULAR_VEL_NAME)
     {
-      len = sizeof(Vector3);
-      data = new char[len];
-      Vector3 value = obj->GetAngularVelocity();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        Vector3 value = obj->GetAngularVelocity();
+        return std::string((const char *)&value, sizeof(Vector3));
+      };
     }
     else if (valueName == TORQUE_NAME)
     {
-      len = sizeof(Vector3);
-      data = new char[len];
-      Vector3 value = obj->GetTorque();
-      memcpy(data, &value, len);
+      getter = [](PhysicsObject *obj) {
+        Vector3 value = obj->GetTorque();
+        return std::string((const char *)&value, sizeof(Vector3));
+      };
     }
     else
     {
-      delete data;
       return false;
     }
 
-    // Send message
-    std::string topic = "physics/objects/" + tokens[0] + '/' + valueName;
-    m_broker->BroadcastMessage(this, topic, data, len);
-    delete data;
+    // Object is read and the value sent when the command is applied, as the world may be mid step now
+    m_world->QueueCommand([this, name, valueName, getter](PhysicsEngine &world) {
+      PhysicsObject *obj = world.FindObjectByName(name);
+      if (obj == nullptr)
+        return;
+
+      std::string data = getter(obj);
+
+      // Lock the broker for the duration of the broadcast
+      std::unique_lock<std::mutex> brokerLock;
+      PubSubBrokerNetNode *netBroker = dynamic_cast<PubSubBrokerNetNode *>(m_broker);
+      if (netBroker != nullptr)
+        brokerLock = std::unique_lock<std::mutex>(netBroker->Mutex());
+
+      std::string topic = "physics/objects/" + name + '/' + valueName;
+      m_broker->BroadcastMessage(this, topic, data.c_str(), (uint16_t)data.size());
+    });
   }
   // Set physical property
   else if (topic == "physics/set")
@@ -129,87 +144,102 @@ bool PhysicsNetworkController::HandleSubscription(const std::string &topic, cons
 
     const char *data = msg + idx + 1;
     std::vector<std::string> tokens = Utility::Split(std::string(msg, msg + idx), '.');
+    std::string name = tokens[0];
     std::string valueName = tokens[1];
 
-    // Find object
-    PhysicsObject *obj = PhysicsEngine::Instance()->FindObjectByName(tokens[0]);
-    if (obj == nullptr)
-      return false;
+    std::function<void(PhysicsObject *)> setter;
 
     if (valueName == INV_MASS_NAME)
     {
       float value;
       memcpy(&value, data, sizeof(value));
-      obj->SetInverseMass(value);
+      setter = [value](PhysicsObject *obj) { obj->SetInverseMass(value); };
     }
     else if (valueName == POSITION_NAME)
     {
       Vector3 value;
       memcpy(&value, data, sizeof(Vector3));
-      obj->SetPosition(value);
+      setter = [value](PhysicsObject *obj) { obj->SetPosition(value); };
     }
     else if (valueName == LINEAR_VELOCITY_NAME)
     {
       Vector3 value;
       memcpy(&value, data, sizeof(Vector3));
-      obj->SetLinearVelocity(value);
+      setter = [value](PhysicsObject *obj) { obj->SetLinearVelocity(value); };
     }
     else if (valueName == FORCE_NAME)
     {
       Vector3 value;
       memcpy(&value, data, sizeof(Vector3));
-      obj->SetForce(value);
+      setter = [value](PhysicsObject *obj) { obj->SetForce(value); };
     }
     else if (valueName == ORIENTATION_NAME)
     {
       Quaternion value;
       memcpy(&value, data, sizeof(Quaternion));
-      obj->SetOrientation(value);
+      setter = [value](PhysicsObject *obj) { obj->SetOrientation(value); };
     }
     else if (valueName == ANGULAR_VEL_NAME)
     {
       Vector3 value;
       memcpy(&value, data, sizeof(Vector3));
-      obj->SetAngularVelocity(value);
+      setter = [value](PhysicsObject *obj) { obj->SetAngularVelocity(value); };
     }
     else if (valueName == TORQUE_NAME)
     {
       Vector3 value;
       memcpy(&value, data, sizeof(Vector3));
-      obj->SetTorque(value);
+      setter = [value](PhysicsObject *obj) { obj->SetTorque(value); };
     }
     else
     {
-      delete data;
       return false;
     }
+
+    // Object is found when the command is applied as it may be removed before then
+    m_world->QueueCommand([name, setter](PhysicsEngine &world) {
+      PhysicsObject *obj = world.FindObjectByName(name);
+      if (obj != nullptr)
+        setter(obj);
+    });
   }
   // Subscribe to collision detection
   else if (topic == "physics/collsub")
   {
-    // Find object
-    PhysicsObject *obj = PhysicsEngine::Instance()->FindObjectByName(std::string(msg));
-    if (obj == nullptr)
-      return false;
+    std::string name(msg);
 
     // Add collision handler to flag update
-    obj->AddOnCollisionManifoldCallback([this](PhysicsObject *a, PhysicsObject *b, Manifold *) {
-      Object *oa = a->GetAssociatedObject();
-      Object *ob = b->GetAssociatedObject();
+    m_world->QueueCommand([this, name](PhysicsEngine &world) {
+      PhysicsObject *obj = world.FindObjectByName(name);
+      if (obj == nullptr)
+        return;
+
+      obj->AddContactEventCallback([this](PhysicsObject *a, PhysicsObject *b, const ContactEvent &e) {
+        if (e.type == CONTACT_EVENT_END || b == nullptr)
+          return;
 
-      if (oa != nullptr && ob != nullptr)
-      {
-        auto cp = std::make_pair(oa->GetName(), ob->GetName());
+        Object *oa = a->GetAssociatedObject();
+        Object *ob = b->GetAssociatedObject();
 
+        if (oa != nullptr && ob != nullptr)
         {
-          std::lock_guard<std::mutex> listLock(m_collisionListMutex);
-          m_collisionList.insert(cp);
+          auto cp = std::make_pair(oa->GetName(), ob->GetName());
+
+          {
+            std::lock_guard<std::mutex> listLock(m_collisionListMutex);
+            m_collisionList.insert(cp);
+          }
         }
-      }
+      });
     });
 
     return true;
   }
+  // Enable/disable publishing of the physics profile
+  else if (topic == "physics/profilesub")
+  {
+    m_profilePublishEnabled = (((char *)msg)[0] == 'Y');
+  }
   else
   {
     return false;
@@ -252,6 +282,22 @@ void PhysicsNetworkController::PublishCollisionLists()
   m_collisionList.clear();
 }
 
+/**
+ * @brief Publishes the stage timings and counts of the last physics update to the "physics/profile" topic.
+ */
+void PhysicsNetworkController::PublishProfile()
+{
+  PhysicsProfile profile = m_world->GetUpdateProfile();
+
+  // Lock the broker for the duration of the broadcast
+  std::unique_lock<std::mutex> brokerLock;
+  PubSubBrokerNetNode *netBroker = dynamic_cast<PubSubBrokerNetNode *>(m_broker);
+  if (netBroker != nullptr)
+    brokerLock = std::unique_lock<std::mutex>(netBroker->Mutex());
+
+  m_broker->BroadcastMessage(this, "physics/profile", (const char *)&profile, (uint16_t)sizeof(PhysicsProfile));
+}
+
 void PhysicsNetworkController::UpdateThreadFunc(float updateTime)
 {
   DWORD sleepTimeMs = ((DWORD)updateTime) / 1000;
@@ -259,6 +305,10 @@ void PhysicsNetworkController::UpdateThreadFunc(float updateTime)
   while (m_collisionUpdateThreadRunFlag)
   {
     PublishCollisionLists();
+
+    if (m_profilePublishEnabled)
+      PublishProfile();
+
     Sleep(1000);
   }
 }
@@ -7,6 +7,8 @@
 #include <set>
 #include <thread>
 
+class PhysicsEngine;
+
 class PhysicsNetworkController : public IPubSubClient
 {
 public:
@@ -19,7 +21,7 @@ public:
   static const std::string TORQUE_NAME;
 
 public:
-  PhysicsNetworkController(PubSubBroker *broker);
+  PhysicsNetworkController(PubSubBroker *broker, PhysicsEngine *world = nullptr);
   virtual ~PhysicsNetworkController();
 
   virtual bool HandleSubscription(const std::string &topic, const char *msg, uint16_t len) override;
@@ -28,14 +30,19 @@ public:
   void StopUpdateThread();
 
   void PublishCollisionLists();
+  void PublishProfile();
 
 protected:
   void UpdateThreadFunc(float updateTime);
 
 protected:
+  PhysicsEngine *m_world; //!< World controlled over the network
+
   std::thread m_collisionUpdateThread;             //!< Thread publishes collision list to broker
   std::atomic_bool m_collisionUpdateThreadRunFlag; //!< FLag indicating the update thread should run
 
   std::set<std::pair<std::string, std::string>> m_collisionList; //!< Cached list of collisions
   std::mutex m_collisionListMutex;                               //!< Mutex for guarding access to collision list
+
+  std::atomic<bool> m_profilePublishEnabled; //!< Flag indicating the update thread should publish the physics profile
 };
\ No newline at end of file
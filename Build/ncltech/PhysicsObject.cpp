@@ -4,6 +4,10 @@
 #include "Object.h"
 #include "PhysicsEngine.h"
 
+#include <algorithm>
+
+using std::min;
+
 /**
  * @brief Creates a new physics object with default settings.
  */
@@ -12,12 +16,22 @@ PhysicsObject::PhysicsObject()
     , m_wsTransformInvalidated(true)
     , m_wsAabbInvalidated(true)
     , m_collisionEnabled(true)
+    , m_trigger(false)
+    , m_kinematic(false)
+    , m_continuousCollisionEnabled(false)
+    , m_contactEventsEnabled(false)
+    , m_continuousCollisionRadius(0.0f)
     , m_atRest(false)
     , m_restVelocityThresholdSquared(0.001f)
     , m_averageSummedVelocity(0.0f)
     , m_dampingCoefficient(0.999f)
     , m_gravitationTarget(nullptr)
     , m_localBoundingBox()
+    , m_bodyStore(nullptr)
+    , m_bodyHandle(INVALID_BODY_HANDLE)
+    , m_world(nullptr)
+    , m_handle(INVALID_OBJECT_HANDLE)
+    , m_stepIndex(0)
     , m_position(0.0f, 0.0f, 0.0f)
     , m_linearVelocity(0.0f, 0.0f, 0.0f)
     , m_linearForce(0.0f, 0.0f, 0.0f)
@@ -35,6 +49,10 @@ PhysicsObject::PhysicsObject()
 
 PhysicsObject::~PhysicsObject()
 {
+  // Release motion state storage
+  if (m_bodyStore != nullptr)
+    m_bodyStore->Remove(m_bodyHandle);
+
   // Delete collision shapes
   for (auto it = m_collisionShapes.begin(); it != m_collisionShapes.end(); ++it)
     delete *it;
@@ -57,6 +75,46 @@ BoundingBox PhysicsObject::GetWorldSpaceAABB() const
   return m_wsAabb;
 }
 
+/**
+ * @brief Gets the radius of the sphere swept along the path of the object in continuous collision detection.
+ * @return Swept sphere radius
+ *
+ * If no radius has been set this is the radius of the largest sphere that fits inside the local bounding box.
+ */
+float PhysicsObject::GetContinuousCollisionRadius() const
+{
+  if (m_continuousCollisionRadius > 0.0f)
+    return m_continuousCollisionRadius;
+
+  Vector3 dims = m_localBoundingBox.Upper() - m_localBoundingBox.Lower();
+  return 0.5f * min(dims.x, min(dims.y, dims.z));
+}
+
+/**
+ * @brief Checks if this object is unaffected by impulses (i.e. is kinematic or has zero inverse mass and inverse
+ *        inertia).
+ * @return True if the object is static
+ *
+ * Static objects do not join simulation islands, so many islands may share the same static object.
+ */
+bool PhysicsObject::IsStatic() const
+{
+  if (m_kinematic)
+    return true;
+
+  if (GetInverseMass() != 0.0f)
+    return false;
+
+  const Matrix3 &inverseInertia = GetInverseInertia();
+  for (size_t i = 0; i < 9; ++i)
+  {
+    if (inverseInertia.mat_array[i] != 0.0f)
+      return false;
+  }
+
+  return true;
+}
+
 /**
  * @brief Gets the world space transformation matrix of this object.
  * @return World space transformation
@@ -65,8 +123,8 @@ const Matrix4 &PhysicsObject::GetWorldSpaceTransform() const
 {
   if (m_wsTransformInvalidated)
   {
-    m_wsTransform = m_orientation.ToMatrix4();
-    m_wsTransform.SetPositionVector(m_position);
+    m_wsTransform = GetOrientation().ToMatrix4();
+    m_wsTransform.SetPositionVector(GetPosition());
 
     m_wsTransformInvalidated = false;
   }
@@ -74,6 +132,44 @@ const Matrix4 &PhysicsObject::GetWorldSpaceTransform() const
   return m_wsTransform;
 }
 
+/**
+ * @brief Gets the world space transformation matrix of this object interpolated between the last two published steps.
+ * @param alpha Interpolation factor (0 gives the previous step, 1 the latest step)
+ * @return Interpolated world space transformation
+ *
+ * Only valid while the physics engine runs on its own thread, the snapshot mutex must be held by the caller.
+ */
+Matrix4 PhysicsObject::GetSnapshotWorldSpaceTransform(float alpha) const
+{
+  Quaternion orientation = Quaternion::Interpolate(m_snapshotOrientations[0], m_snapshotOrientations[1], alpha);
+
+  Matrix4 transform = orientation.ToMatrix4();
+  transform.SetPositionVector(m_snapshotPositions[0] * (1.0f - alpha) + m_snapshotPositions[1] * alpha);
+
+  return transform;
+}
+
+/**
+ * @brief Copies the current position and orientation into the latest snapshot slot.
+ * @param keepPrevious If the latest snapshot should move to the previous slot, otherwise both slots are set
+ */
+void PhysicsObject::StoreSnapshot(bool keepPrevious)
+{
+  if (keepPrevious)
+  {
+    m_snapshotPositions[0] = m_snapshotPositions[1];
+    m_snapshotOrientations[0] = m_snapshotOrientations[1];
+  }
+  else
+  {
+    m_snapshotPositions[0] = GetPosition();
+    m_snapshotOrientations[0] = GetOrientation();
+  }
+
+  m_snapshotPositions[1] = GetPosition();
+  m_snapshotOrientations[1] = GetOrientation();
+}
+
 /**
  * @brief Automatically resizes the local bounding box to the minimum volume that contains all collision shapes.
  *
@@ -132,7 +228,7 @@ void PhysicsObject::DoAtRestTest()
   static const float ALPHA = 0.7f;
 
   // Calculate exponential moving average
-  float v = m_linearVelocity.LengthSquared() + m_angularVelocity.LengthSquared();
+  float v = GetLinearVelocity().LengthSquared() + GetAngularVelocity().LengthSquared();
   m_averageSummedVelocity += ALPHA * (v - m_averageSummedVelocity);
 
   // Do test
@@ -164,10 +260,10 @@ void PhysicsObject::DebugDraw(uint64_t flags) const
   }
 
   if (flags & DEBUGDRAW_FLAGS_LINEARVELOCITY)
-    NCLDebug::DrawThickLineNDT(m_wsTransform.GetPositionVector(), m_wsTransform * m_linearVelocity, 0.02f,
+    NCLDebug::DrawThickLineNDT(m_wsTransform.GetPositionVector(), m_wsTransform * GetLinearVelocity(), 0.02f,
                                Vector4(0.0f, 1.0f, 0.0f, 1.0f));
 
   if (flags & DEBUGDRAW_FLAGS_LINEARFORCE)
-    NCLDebug::DrawThickLineNDT(m_wsTransform.GetPositionVector(), m_wsTransform * m_linearForce, 0.02f,
+    NCLDebug::DrawThickLineNDT(m_wsTransform.GetPositionVector(), m_wsTransform * GetForce(), 0.02f,
                                Vector4(0.0f, 0.0f, 1.0f, 1.0f));
 }
@@ -18,14 +18,16 @@ as velocity, position, mass etc..
 #pragma once
 
 #include "BoundingBox.h"
+#include "ContactEvent.h"
 #include "ICollisionShape.h"
+#include "PhysicsBodyStore.h"
+#include "PhysicsObjectRegistry.h"
 #include <functional>
 #include <nclgl\Matrix3.h>
 #include <nclgl\Quaternion.h>
 
 class PhysicsEngine;
 class Object;
-class Manifold;
 
 /**
  * @class PhysicsObject
@@ -34,6 +36,8 @@ class Manifold;
 class PhysicsObject
 {
   friend class PhysicsEngine;
+  friend class PhysicsBodyStore;
+  friend class GraphColouredSolver;
 
 public:
   /**
@@ -45,11 +49,12 @@ public:
   typedef std::function<bool(PhysicsObject *, PhysicsObject *)> PhysicsCollisionCallback;
 
   /**
-   * @brief Callback function called whenever a manifold is generted for a collision.
+   * @brief Callback function called for each contact event involving an object, after the physics step.
    *
-   * First object is "this" object, second is the object collided with.
+   * First object is "this" object, second is the object in contact (nullptr if it has since been removed from the
+   * simulation). The event is mirrored so its first object is always "this" object.
    */
-  typedef std::function<void(PhysicsObject *, PhysicsObject *, Manifold *)> OnCollisionManifoldCallback;
+  typedef std::function<void(PhysicsObject *, PhysicsObject *, const ContactEvent &)> ContactEventCallback;
 
 public:
   PhysicsObject();
@@ -82,6 +87,44 @@ public:
     return m_collisionEnabled;
   }
 
+  /**
+   * @brief Checks if this object is a trigger volume.
+   * @return True if this object is a trigger
+   */
+  inline bool IsTrigger() const
+  {
+    return m_trigger;
+  }
+
+  /**
+   * @brief Checks if this object is kinematic.
+   * @return True if this object is kinematic
+   */
+  inline bool IsKinematic() const
+  {
+    return m_kinematic;
+  }
+
+  /**
+   * @brief Checks if continuous collision detection is enabled for this object.
+   * @return True if continuous collision detection is enabled
+   */
+  inline bool IsContinuousCollisionEnabled() const
+  {
+    return m_continuousCollisionEnabled;
+  }
+
+  float GetContinuousCollisionRadius() const;
+
+  /**
+   * @brief Checks if contact events are generated for this object.
+   * @return True if contact events are enabled
+   */
+  inline bool IsContactEventsEnabled() const
+  {
+    return m_contactEventsEnabled;
+  }
+
   /**
    * @brief Gets the square of the rest velocity threshold.
    * @return Squared rest velocity
@@ -111,6 +154,8 @@ public:
 
   BoundingBox GetWorldSpaceAABB() const;
 
+  bool IsStatic() const;
+
   /**
    * @brief Gets the collision elasticity.
    * @return Elasticity
@@ -135,7 +180,7 @@ public:
    */
   inline const Vector3 &GetPosition() const
   {
-    return m_position;
+    return (m_bodyStore == nullptr) ? m_position : m_bodyStore->m_positions[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -144,7 +189,7 @@ public:
    */
   inline const Vector3 &GetLinearVelocity() const
   {
-    return m_linearVelocity;
+    return (m_bodyStore == nullptr) ? m_linearVelocity : m_bodyStore->m_linearVelocities[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -153,7 +198,7 @@ public:
    */
   inline const Vector3 &GetForce() const
   {
-    return m_linearForce;
+    return (m_bodyStore == nullptr) ? m_linearForce : m_bodyStore->m_linearForces[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -162,7 +207,7 @@ public:
    */
   inline float GetInverseMass() const
   {
-    return m_inverseMass;
+    return (m_bodyStore == nullptr) ? m_inverseMass : m_bodyStore->m_inverseMasses[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -171,7 +216,7 @@ public:
    */
   inline const Quaternion &GetOrientation() const
   {
-    return m_orientation;
+    return (m_bodyStore == nullptr) ? m_orientation : m_bodyStore->m_orientations[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -180,7 +225,7 @@ public:
    */
   inline const Vector3 &GetAngularVelocity() const
   {
-    return m_angularVelocity;
+    return (m_bodyStore == nullptr) ? m_angularVelocity : m_bodyStore->m_angularVelocities[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -189,7 +234,7 @@ public:
    */
   inline const Vector3 &GetTorque() const
   {
-    return m_torque;
+    return (m_bodyStore == nullptr) ? m_torque : m_bodyStore->m_torques[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -198,7 +243,7 @@ public:
    */
   inline const Matrix3 &GetInverseInertia() const
   {
-    return m_inverseInertia;
+    return (m_bodyStore == nullptr) ? m_inverseInertia : m_bodyStore->m_inverseInertias[m_bodyStore->Index(m_bodyHandle)];
   }
 
   /**
@@ -237,7 +282,26 @@ public:
     return m_parent;
   }
 
+  /**
+   * @brief Gets the world this object is simulated in.
+   * @return World, nullptr if the object is not in a simulation
+   */
+  inline PhysicsEngine *GetWorld() const
+  {
+    return m_world;
+  }
+
+  /**
+   * @brief Gets the handle of this object in the physics engine registry.
+   * @return Handle, INVALID_OBJECT_HANDLE if the object is not in the simulation
+   */
+  inline PhysicsObjectHandle GetHandle() const
+  {
+    return m_handle;
+  }
+
   const Matrix4 &GetWorldSpaceTransform() const;
+  Matrix4 GetSnapshotWorldSpaceTransform(float alpha) const;
 
   /**
    * @brief Sets if collision detection is enabled for this object.
@@ -248,6 +312,67 @@ public:
     m_collisionEnabled = enable;
   }
 
+  /**
+   * @brief Sets if this object is a trigger volume.
+   * @param trigger True to make this object a trigger
+   *
+   * Pairs involving a trigger are only tested for overlap: no contact points or manifolds are generated, the collision
+   * callback is not fired and the pair is not solved. Overlaps are reported as contact events (with
+   * ContactEvent::trigger set) if either object has contact events enabled.
+   */
+  inline void SetTrigger(bool trigger)
+  {
+    m_trigger = trigger;
+  }
+
+  /**
+   * @brief Sets if this object is kinematic.
+   * @param kinematic True to make this object kinematic
+   *
+   * Kinematic objects move with the velocity they are given (see SetLinearVelocity() and SetAngularVelocity()) and are
+   * unaffected by forces, gravity, damping and collisions, i.e. they are treated as static with infinite mass by the
+   * solver. They are never integrated or rest tested, only advanced by their velocity, and only sleep while stationary.
+   */
+  inline void SetKinematic(bool kinematic)
+  {
+    m_kinematic = kinematic;
+  }
+
+  /**
+   * @brief Sets if continuous collision detection is enabled for this object.
+   * @param enable If continuous collision detection is enabled
+   *
+   * Prevents fast moving objects passing through others between physics steps. Only objects that move further than
+   * their continuous collision radius in a single step incur any additional cost.
+   */
+  inline void SetContinuousCollisionEnabled(bool enable)
+  {
+    m_continuousCollisionEnabled = enable;
+  }
+
+  /**
+   * @brief Sets if contact events are generated for this object.
+   * @param enable True to enable contact events
+   *
+   * Events are generated for a pair of objects if either has contact events enabled, see
+   * PhysicsEngine::GetContactEvents(). Enabled automatically when a contact event callback is added.
+   */
+  inline void SetContactEventsEnabled(bool enable)
+  {
+    m_contactEventsEnabled = enable;
+  }
+
+  /**
+   * @brief Sets the radius of the sphere swept along the path of the object in continuous collision detection.
+   * @param radius Swept sphere radius, zero or less to fit it inside the local bounding box
+   *
+   * Should be no larger than the radius of a sphere that fits inside the collision shapes of the object.
+   */
+  inline void SetContinuousCollisionRadius(float radius)
+  {
+    m_continuousCollisionRadius = radius;
+  }
+
   /**
    * @brief Sets the at rest velocity sum threshold.
    * @param vel At rest velocity
@@ -314,7 +439,7 @@ public:
    */
   inline void SetPosition(const Vector3 &v)
   {
-    m_position = v;
+    PositionRef() = v;
     m_wsTransformInvalidated = true;
     m_wsAabbInvalidated = true;
     m_atRest = false;
@@ -326,7 +451,7 @@ public:
    */
   inline void SetLinearVelocity(const Vector3 &v)
   {
-    m_linearVelocity = v;
+    LinearVelocityRef() = v;
   }
 
   /**
@@ -335,7 +460,7 @@ public:
    */
   inline void ApplyForce(const Vector3 &force)
   {
-    m_linearForce += force;
+    LinearForceRef() += force;
   }
 
   /**
@@ -343,7 +468,7 @@ public:
    */
   inline void ClearForces()
   {
-    m_linearForce.ToZero();
+    LinearForceRef().ToZero();
   }
 
   /**
@@ -352,7 +477,7 @@ public:
    */
   inline void SetForce(const Vector3 &v)
   {
-    m_linearForce = v;
+    LinearForceRef() = v;
   }
 
   /**
@@ -361,7 +486,7 @@ public:
    */
   inline void SetInverseMass(const float &v)
   {
-    m_inverseMass = v;
+    InverseMassRef() = v;
   }
 
   /**
@@ -370,7 +495,7 @@ public:
    */
   inline void SetOrientation(const Quaternion &v)
   {
-    m_orientation = v;
+    OrientationRef() = v;
     m_wsTransformInvalidated = true;
     m_atRest = false;
   }
@@ -381,7 +506,7 @@ public:
    */
   inline void SetAngularVelocity(const Vector3 &v)
   {
-    m_angularVelocity = v;
+    AngularVelocityRef() = v;
   }
 
   /**
@@ -390,7 +515,7 @@ public:
    */
   inline void SetTorque(const Vector3 &v)
   {
-    m_torque = v;
+    TorqueRef() = v;
   }
 
   /**
@@ -399,7 +524,7 @@ public:
    */
   inline void SetInverseInertia(const Matrix3 &v)
   {
-    m_inverseInertia = v;
+    InverseInertiaRef() = v;
   }
 
   /**
@@ -433,14 +558,15 @@ public:
   }
 
   /**
-   * @brief Adds a collision callback that is fired after tha manifold is generated.
+   * @brief Adds a callback that is fired for each contact event involving this object and enables contact events.
    * @param callback Callback function
    *
-   * Useful if the contact points are needed in the callback.
+   * Callbacks are fired once the physics step is complete, so may modify the simulation.
    */
-  inline void AddOnCollisionManifoldCallback(OnCollisionManifoldCallback callback)
+  inline void AddContactEventCallback(ContactEventCallback callback)
   {
-    m_onCollisionManifoldCallbacks.push_back(callback);
+    m_contactEventCallbacks.push_back(callback);
+    m_contactEventsEnabled = true;
   }
 
   /**
@@ -461,15 +587,14 @@ public:
   }
 
   /**
-   * @brief Fires collision callbacks after manifold generation.
-   * @param obj_a First (this) object
-   * @param obj_b Second (other) object
-   * @param manifold Collision manifold between objects
+   * @brief Fires contact event callbacks.
+   * @param other Other object in contact (nullptr if no longer in the simulation)
+   * @param event Contact event, with this object first
    */
-  inline void FireOnCollisionManifoldCallback(PhysicsObject *a, PhysicsObject *b, Manifold *manifold)
+  inline void FireContactEvent(PhysicsObject *other, const ContactEvent &event)
   {
-    for (auto it = m_onCollisionManifoldCallbacks.begin(); it != m_onCollisionManifoldCallbacks.end(); ++it)
-      it->operator()(a, b, manifold);
+    for (auto it = m_contactEventCallbacks.begin(); it != m_contactEventCallbacks.end(); ++it)
+      it->operator()(this, other, event);
   }
 
   void DoAtRestTest();
@@ -484,10 +609,68 @@ public:
 
   virtual void DebugDraw(uint64_t flags) const;
 
+  /**
+   * @brief Checks if the motion state of this object is held in a PhysicsBodyStore.
+   * @return True if state is held in a body store
+   */
+  inline bool InBodyStore() const
+  {
+    return m_bodyStore != nullptr;
+  }
+
+protected:
+  void StoreSnapshot(bool keepPrevious);
+
+  // Mutable references to motion state, wherever it is currently stored
+  inline Vector3 &PositionRef()
+  {
+    return const_cast<Vector3 &>(GetPosition());
+  }
+
+  inline Vector3 &LinearVelocityRef()
+  {
+    return const_cast<Vector3 &>(GetLinearVelocity());
+  }
+
+  inline Vector3 &LinearForceRef()
+  {
+    return const_cast<Vector3 &>(GetForce());
+  }
+
+  inline float &InverseMassRef()
+  {
+    return (m_bodyStore == nullptr) ? m_inverseMass : m_bodyStore->m_inverseMasses[m_bodyStore->Index(m_bodyHandle)];
+  }
+
+  inline Quaternion &OrientationRef()
+  {
+    return const_cast<Quaternion &>(GetOrientation());
+  }
+
+  inline Vector3 &AngularVelocityRef()
+  {
+    return const_cast<Vector3 &>(GetAngularVelocity());
+  }
+
+  inline Vector3 &TorqueRef()
+  {
+    return const_cast<Vector3 &>(GetTorque());
+  }
+
+  inline Matrix3 &InverseInertiaRef()
+  {
+    return const_cast<Matrix3 &>(GetInverseInertia());
+  }
+
 protected:
   Object *m_parent; //!< Attached GameObject or NULL if none set
 
   bool m_collisionEnabled;              //!< Flag indication if collision detection is enabled for this object
+  bool m_trigger;                       //!< Flag indicating this object only detects overlaps and is never solved
+  bool m_kinematic;                     //!< Flag indicating this object moves with a scripted velocity only
+  bool m_continuousCollisionEnabled;    //!< Flag indicating if continuous collision detection is enabled for this object
+  bool m_contactEventsEnabled;          //!< Flag indicating if contact events are generated for this object
+  float m_continuousCollisionRadius;    //!< Radius of the sphere swept in continuous collision detection (zero for automatic)
   bool m_atRest;                        //!< Flag indicating if this object is at rest
   float m_restVelocityThresholdSquared; //!< Squared velocity vector magnitude at which the object is deemed to be stationary
   float m_averageSummedVelocity;        //!< Exponential moving average of sum of magnitudes of linear and angular velocity
@@ -506,6 +689,18 @@ protected:
   float m_elasticity; //!< Value from 0-1 definiing how much the object bounces off other objects
   float m_friction;   //!< Value from 0-1 defining how much the object can slide off other objects
 
+  PhysicsBodyStore *m_bodyStore; //!< Store holding the motion state of this object (nullptr if held locally)
+  BodyHandle m_bodyHandle;       //!< Handle of this object in m_bodyStore
+
+  PhysicsEngine *m_world;       //!< World this object is simulated in (nullptr if none)
+  PhysicsObjectHandle m_handle; //!< Handle of this object in the physics engine registry
+  size_t m_stepIndex;           //!< Index of this object in the simulation object list
+
+  // Transforms published by a threaded physics engine, guarded by PhysicsEngine::SnapshotMutex()
+  Vector3 m_snapshotPositions[2];       //!< Position at the previous [0] and latest [1] published step
+  Quaternion m_snapshotOrientations[2]; //!< Orientation at the previous [0] and latest [1] published step
+
+  // Motion state, only valid when m_bodyStore is nullptr
   Vector3 m_position;       //!< Object position
   Vector3 m_linearVelocity; //!< Linear velcoity
   Vector3 m_linearForce;    //!< Linear force
@@ -516,7 +711,7 @@ protected:
   Vector3 m_torque;          //!< Axis torque
   Matrix3 m_inverseInertia;  //!< Inverse intertia matrix
 
-  std::vector<ICollisionShape *> m_collisionShapes;                        //!< Collection of collision shapes in this object
-  PhysicsCollisionCallback m_onCollisionCallback;                          //!< Collision callback
-  std::vector<OnCollisionManifoldCallback> m_onCollisionManifoldCallbacks; //!< Collision callbacks post manifold generation
+  std::vector<ICollisionShape *> m_collisionShapes;          //!< Collection of collision shapes in this object
+  PhysicsCollisionCallback m_onCollisionCallback;            //!< Collision callback
+  std::vector<ContactEventCallback> m_contactEventCallbacks; //!< Callbacks fired for contact events after each step
 };
@@ -0,0 +1,140 @@
+#include "PhysicsObjectRegistry.h"
+
+/**
+ * @brief Creates a new empty registry.
+ */
+PhysicsObjectRegistry::PhysicsObjectRegistry()
+    : m_size(0)
+{
+}
+
+PhysicsObjectRegistry::~PhysicsObjectRegistry()
+{
+}
+
+/**
+ * @brief Adds an object to the registry.
+ * @param obj Object to add
+ * @param name Name to index the object under, empty to not index the object by name
+ * @return Handle to the object
+ */
+PhysicsObjectHandle PhysicsObjectRegistry::Add(PhysicsObject *obj, const std::string &name)
+{
+  // Allocate a slot, reusing a freed one if possible
+  uint32_t slotIdx;
+  if (m_freeSlots.empty())
+  {
+    slotIdx = (uint32_t)m_slots.size();
+    m_slots.push_back({nullptr, 1, std::string()});
+  }
+  else
+  {
+    slotIdx = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  }
+
+  Slot &slot = m_slots[slotIdx];
+  slot.object = obj;
+  slot.name = name;
+  m_size++;
+
+  PhysicsObjectHandle handle = ((PhysicsObjectHandle)slot.generation << 32) | slotIdx;
+
+  if (!name.empty())
+    m_nameIndex.emplace(name, handle);
+
+  return handle;
+}
+
+/**
+ * @brief Removes an object from the registry.
+ * @param handle Handle of the object to remove
+ * @return True if the object was removed, false if the handle was not valid
+ */
+bool PhysicsObjectRegistry::Remove(PhysicsObjectHandle handle)
+{
+  if (Get(handle) == nullptr)
+    return false;
+
+  uint32_t slotIdx = SlotIndex(handle);
+  Slot &slot = m_slots[slotIdx];
+
+  // Remove the name index entry for this object (other objects may share the name)
+  if (!slot.name.empty())
+  {
+    auto range = m_nameIndex.equal_range(slot.name);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second == handle)
+      {
+        m_nameIndex.erase(it);
+        break;
+      }
+    }
+  }
+
+  slot.object = nullptr;
+  slot.name.clear();
+
+  // Skip generation zero so a handle is never equal to INVALID_OBJECT_HANDLE
+  if (++slot.generation == 0)
+    slot.generation = 1;
+
+  m_freeSlots.push_back(slotIdx);
+  m_size--;
+
+  return true;
+}
+
+/**
+ * @brief Removes all objects from the registry.
+ *
+ * Slots are kept (with incremented generations) so handles issued before the registry was cleared remain invalid.
+ */
+void PhysicsObjectRegistry::Clear()
+{
+  m_freeSlots.clear();
+
+  for (uint32_t i = 0; i < (uint32_t)m_slots.size(); ++i)
+  {
+    Slot &slot = m_slots[i];
+    if (slot.object != nullptr)
+    {
+      slot.object = nullptr;
+      slot.name.clear();
+      if (++slot.generation == 0)
+        slot.generation = 1;
+    }
+
+    m_freeSlots.push_back(i);
+  }
+
+  m_nameIndex.clear();
+  m_size = 0;
+}
+
+/**
+ * @brief Gets the object referred to by a handle.
+ * @param handle Object handle
+ * @return Object, nullptr if the handle is invalid or the object has been removed
+ */
+PhysicsObject *PhysicsObjectRegistry::Get(PhysicsObjectHandle handle) const
+{
+  uint32_t slotIdx = SlotIndex(handle);
+  if (slotIdx >= m_slots.size())
+    return nullptr;
+
+  const Slot &slot = m_slots[slotIdx];
+  return (slot.generation == Generation(handle)) ? slot.object : nullptr;
+}
+
+/**
+ * @brief Finds an object by name.
+ * @param name Name of the object
+ * @return Object, nullptr if no object has the name (if several objects share the name any one of them is returned)
+ */
+PhysicsObject *PhysicsObjectRegistry::FindByName(const std::string &name) const
+{
+  auto it = m_nameIndex.find(name);
+  return (it == m_nameIndex.end()) ? nullptr : Get(it->second);
+}
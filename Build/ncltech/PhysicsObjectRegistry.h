@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class PhysicsObject;
+
+/**
+ * @brief Generational handle to an object in a PhysicsObjectRegistry.
+ *
+ * The lower 32 bits hold the slot index and the upper 32 bits the generation of the slot when the handle was issued, so
+ * handles to removed objects are never confused with objects later registered in the same slot.
+ */
+typedef uint64_t PhysicsObjectHandle;
+
+/**
+ * @brief Value of a PhysicsObjectHandle that does not refer to any object.
+ */
+static const PhysicsObjectHandle INVALID_OBJECT_HANDLE = 0;
+
+/**
+ * @class PhysicsObjectRegistry
+ * @author Dan Nixon
+ * @brief Slot map from generational handles to physics objects, with an index of objects by name.
+ *
+ * Adding, removing and looking up objects by handle or name are all constant time. Freed slots are reused, with the slot
+ * generation incremented on removal so stale handles resolve to nullptr.
+ */
+class PhysicsObjectRegistry
+{
+public:
+  PhysicsObjectRegistry();
+  virtual ~PhysicsObjectRegistry();
+
+  PhysicsObjectHandle Add(PhysicsObject *obj, const std::string &name);
+  bool Remove(PhysicsObjectHandle handle);
+  void Clear();
+
+  PhysicsObject *Get(PhysicsObjectHandle handle) const;
+  PhysicsObject *FindByName(const std::string &name) const;
+
+  /**
+   * @brief Gets the number of objects in the registry.
+   * @return Object count
+   */
+  inline size_t Size() const
+  {
+    return m_size;
+  }
+
+protected:
+  /**
+   * @brief Storage for a single registered object.
+   */
+  struct Slot
+  {
+    PhysicsObject *object; //!< Registered object, nullptr if the slot is free
+    uint32_t generation;   //!< Generation of the slot, incremented each time its object is removed
+    std::string name;      //!< Name the object is indexed under (empty if not indexed)
+  };
+
+  /**
+   * @brief Gets the slot index of a handle.
+   * @param handle Handle
+   * @return Slot index
+   */
+  static inline uint32_t SlotIndex(PhysicsObjectHandle handle)
+  {
+    return (uint32_t)(handle & 0xFFFFFFFF);
+  }
+
+  /**
+   * @brief Gets the generation of a handle.
+   * @param handle Handle
+   * @return Generation
+   */
+  static inline uint32_t Generation(PhysicsObjectHandle handle)
+  {
+    return (uint32_t)(handle >> 32);
+  }
+
+protected:
+  std::vector<Slot> m_slots;         //!< Object slots, indexed by the slot index of a handle
+  std::vector<uint32_t> m_freeSlots; //!< Indices of free slots available for reuse
+  size_t m_size;                     //!< Number of registered objects
+
+  std::unordered_multimap<std::string, PhysicsObjectHandle> m_nameIndex; //!< Handles of objects indexed by name
+};
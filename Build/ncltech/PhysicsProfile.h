@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Time spent in each stage of the physics pipeline and the amount of work each stage processed.
+ *
+ * Stage times are in milliseconds. Per constraint pre-solver work runs inside the (possibly parallel) solvers and is
+ * therefore counted in the solver time, the pre-solve time covers island detection, solver body setup and constraint
+ * colouring.
+ */
+struct PhysicsProfile
+{
+  size_t numSteps; //!< Number of physics steps covered by this profile
+
+  float broadphaseMs;  //!< Time spent finding and de-duplicating broadphase pairs
+  float narrowphaseMs; //!< Time spent generating and caching contact manifolds
+  float preSolveMs;    //!< Time spent building islands, solver bodies and constraint colouring
+  float solverMs;      //!< Time spent solving constraints and writing back velocities
+  float integrationMs; //!< Time spent integrating bodies, continuous collision detection and updating island sleep state
+  float totalMs;       //!< Time spent in all stages
+
+  size_t numBroadphasePairs;  //!< Number of unique broadphase pairs
+  size_t numManifolds;        //!< Number of colliding manifolds
+  size_t numContacts;         //!< Number of contact points over all manifolds
+  size_t numAwakeBodies;      //!< Number of non static bodies that were awake after integration
+  size_t numSweptBodies;      //!< Number of fast bodies swept by continuous collision detection
+  size_t numTimeOfImpacts;    //!< Number of swept bodies moved back to their time of impact
+  size_t numSolverIterations; //!< Number of solver iterations performed
+
+  /**
+   * @brief Sets all times and counts to zero.
+   */
+  void Reset()
+  {
+    numSteps = 0;
+    broadphaseMs = 0.0f;
+    narrowphaseMs = 0.0f;
+    preSolveMs = 0.0f;
+    solverMs = 0.0f;
+    integrationMs = 0.0f;
+    totalMs = 0.0f;
+    numBroadphasePairs = 0;
+    numManifolds = 0;
+    numContacts = 0;
+    numAwakeBodies = 0;
+    numSweptBodies = 0;
+    numTimeOfImpacts = 0;
+    numSolverIterations = 0;
+  }
+
+  /**
+   * @brief Adds the times and counts of another profile to this one.
+   * @param other Profile to add
+   */
+  void Accumulate(const PhysicsProfile &other)
+  {
+    numSteps += other.numSteps;
+    broadphaseMs += other.broadphaseMs;
+    narrowphaseMs += other.narrowphaseMs;
+    preSolveMs += other.preSolveMs;
+    solverMs += other.solverMs;
+    integrationMs += other.integrationMs;
+    totalMs += other.totalMs;
+    numBroadphasePairs += other.numBroadphasePairs;
+    numManifolds += other.numManifolds;
+    numContacts += other.numContacts;
+    numAwakeBodies += other.numAwakeBodies;
+    numSweptBodies += other.numSweptBodies;
+    numTimeOfImpacts += other.numTimeOfImpacts;
+    numSolverIterations += other.numSolverIterations;
+  }
+};
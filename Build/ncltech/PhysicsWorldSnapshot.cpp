@@ -0,0 +1,19 @@
+#include "PhysicsWorldSnapshot.h"
+
+PhysicsWorldSnapshot::PhysicsWorldSnapshot()
+{
+}
+
+PhysicsWorldSnapshot::~PhysicsWorldSnapshot()
+{
+}
+
+/**
+ * @brief Removes the captured world, keeping allocated storage for reuse.
+ */
+void PhysicsWorldSnapshot::Clear()
+{
+  m_data.clear();
+  m_bodies.clear();
+  m_constraints.clear();
+}
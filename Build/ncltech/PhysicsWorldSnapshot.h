@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <nclgl\Matrix3.h>
+#include <nclgl\Quaternion.h>
+#include <nclgl\Vector3.h>
+#include <vector>
+
+class IConstraint;
+class PhysicsObject;
+
+/**
+ * @brief Header at the start of a world snapshot buffer.
+ */
+struct SnapshotHeader
+{
+  uint32_t magic;           //!< Identifies the buffer as a world snapshot (PHYSICS_SNAPSHOT_MAGIC)
+  uint32_t version;         //!< Buffer layout version (PHYSICS_SNAPSHOT_VERSION)
+  uint32_t numBodies;       //!< Number of body records
+  uint32_t numConstraints;  //!< Number of constraint records
+  uint32_t numManifolds;    //!< Number of manifold records
+  uint32_t numContactPairs; //!< Number of ContactEvent records of pairs touching in the last step
+  float timestep;           //!< Physics timestep in seconds
+  float updateAccum;        //!< Time accumulated towards the next physics step
+  uint64_t stepCount;       //!< Number of physics steps performed
+};
+
+/**
+ * @brief State of a single object in a world snapshot.
+ */
+struct SnapshotBodyRecord
+{
+  Vector3 position;       //!< Position
+  Vector3 linearVelocity; //!< Linear velocity
+  Vector3 linearForce;    //!< Linear force
+  float inverseMass;      //!< Inverse mass
+
+  Quaternion orientation;  //!< Orientation
+  Vector3 angularVelocity; //!< Angular velocity
+  Vector3 torque;          //!< Torque
+  Matrix3 inverseInertia;  //!< Inverse inertia
+
+  Vector3 boundsLower; //!< Lower corner of the model space bounding box of all collision shapes
+  Vector3 boundsUpper; //!< Upper corner of the model space bounding box of all collision shapes
+
+  float elasticity;                   //!< Collision elasticity
+  float friction;                     //!< Collision friction
+  float dampingCoefficient;           //!< Velocity damping coefficient
+  float restVelocityThresholdSquared; //!< Squared velocity below which the object may come to rest
+  float averageSummedVelocity;        //!< Moving average of velocity magnitude used for rest detection
+  int32_t gravitationTarget;          //!< Body index of the point gravity target, -1 if none
+  uint32_t numShapes;                 //!< Number of collision shapes
+  uint8_t atRest;                     //!< Flag indicating the object is at rest
+  uint8_t collisionEnabled;           //!< Flag indicating collision detection is enabled
+  uint8_t trigger;                    //!< Flag indicating the object is a trigger volume
+  uint8_t kinematic;                  //!< Flag indicating the object is kinematic
+  uint8_t contactEventsEnabled;       //!< Flag indicating contact events are generated for the object
+};
+
+/**
+ * @brief Objects affected by a constraint in a world snapshot, used to validate the constraint set on restore.
+ */
+struct SnapshotConstraintRecord
+{
+  int32_t bodyA; //!< Body index of the first object, -1 if not known
+  int32_t bodyB; //!< Body index of the second object, -1 if not known
+};
+
+/**
+ * @brief Persistent contact manifold in a world snapshot, followed by numContacts ContactPoint records.
+ */
+struct SnapshotManifoldRecord
+{
+  uint32_t bodyA;       //!< Body index of the first object
+  uint32_t bodyB;       //!< Body index of the second object
+  uint32_t shapeA;      //!< Index of the collision shape on the first object
+  uint32_t shapeB;      //!< Index of the collision shape on the second object
+  uint64_t lastStep;    //!< Last physics step in which the shapes were colliding
+  uint32_t numContacts; //!< Number of contact points
+};
+
+/**
+ * @brief Identifies a buffer as a world snapshot ("NPWS").
+ */
+#define PHYSICS_SNAPSHOT_MAGIC 0x5357504E
+
+/**
+ * @brief Version of the world snapshot buffer layout.
+ */
+#define PHYSICS_SNAPSHOT_VERSION 2
+
+/**
+ * @class PhysicsWorldSnapshot
+ * @author Dan Nixon
+ * @brief Checkpoint of the state of every object, constraint and persistent manifold in a PhysicsEngine world.
+ *
+ * Created with PhysicsEngine::SaveSnapshot() and applied with PhysicsEngine::RestoreSnapshot(). State is held in a
+ * compact, pointer free binary buffer (see Data()) made up of a SnapshotHeader followed by body, constraint, manifold and
+ * contact pair records (the pairs touching at the end of the captured step, so contact events carry on after a restore).
+ * Objects and constraints are referred to by index into the tables of the world they were captured from (contact pairs
+ * by object handle), so a snapshot can only be restored into that same world (i.e. no objects or constraints added or
+ * removed in between).
+ *
+ * Collision shapes are treated as immutable, only their number and the bounds they give each object are recorded.
+ * Reusing a snapshot for repeated saves does not allocate once its buffer has grown to the size of the world.
+ */
+class PhysicsWorldSnapshot
+{
+  friend class PhysicsEngine;
+
+public:
+  PhysicsWorldSnapshot();
+  virtual ~PhysicsWorldSnapshot();
+
+  void Clear();
+
+  /**
+   * @brief Checks if the snapshot holds a captured world.
+   * @return True if the snapshot is empty
+   */
+  inline bool IsEmpty() const
+  {
+    return m_data.empty();
+  }
+
+  /**
+   * @brief Gets the binary snapshot buffer.
+   * @return Snapshot buffer
+   */
+  inline const std::vector<uint8_t> &Data() const
+  {
+    return m_data;
+  }
+
+  /**
+   * @brief Gets the size of the binary snapshot buffer.
+   * @return Size in bytes
+   */
+  inline size_t Size() const
+  {
+    return m_data.size();
+  }
+
+  /**
+   * @brief Gets the snapshot header.
+   * @return Header, only valid if the snapshot is not empty
+   */
+  inline const SnapshotHeader &Header() const
+  {
+    return *reinterpret_cast<const SnapshotHeader *>(m_data.data());
+  }
+
+protected:
+  /**
+   * @brief Appends a record to the end of the buffer.
+   * @param record Record to append
+   */
+  template <typename T> void Write(const T &record)
+  {
+    Write(&record, sizeof(T));
+  }
+
+  /**
+   * @brief Appends raw data to the end of the buffer.
+   * @param data Data to append
+   * @param size Size of data in bytes
+   */
+  inline void Write(const void *data, size_t size)
+  {
+    size_t offset = m_data.size();
+    m_data.resize(offset + size);
+    memcpy(m_data.data() + offset, data, size);
+  }
+
+  /**
+   * @brief Reads a record from the buffer.
+   * @param offset Offset to read from, advanced past the record
+   * @param record Record to read into
+   * @return False if the buffer is too short to contain the record
+   */
+  template <typename T> bool Read(size_t &offset, T &record) const
+  {
+    return Read(offset, &record, sizeof(T));
+  }
+
+  /**
+   * @brief Reads raw data from the buffer.
+   * @param offset Offset to read from, advanced past the data
+   * @param data Destination for data
+   * @param size Size of data in bytes
+   * @return False if the buffer is too short to contain the data
+   */
+  inline bool Read(size_t &offset, void *data, size_t size) const
+  {
+    if (offset + size > m_data.size())
+      return false;
+
+    memcpy(data, m_data.data() + offset, size);
+    offset += size;
+    return true;
+  }
+
+protected:
+  std::vector<uint8_t> m_data;              //!< Binary snapshot buffer
+  std::vector<PhysicsObject *> m_bodies;    //!< Objects in the captured world, indexed by body records
+  std::vector<IConstraint *> m_constraints; //!< Constraints in the captured world, indexed by constraint records
+};
@@ -2,6 +2,7 @@
 
 #include "NCLDebug.h"
 #include "PhysicsObject.h"
+#include <cfloat>
 
 /**
  * @brief Create a new plane collision shape.
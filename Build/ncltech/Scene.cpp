@@ -38,8 +38,8 @@ void Scene::RemoveGameObject(Object *gameObject)
   auto it = std::find(gameObject->m_parent->m_vpChildren.begin(), gameObject->m_parent->m_vpChildren.end(), gameObject);
   if (it != gameObject->m_parent->m_vpChildren.end())
   {
-    if (gameObject->HasPhysics())
-      PhysicsEngine::Instance()->RemovePhysicsObject(gameObject->Physics());
+    if (gameObject->HasPhysics() && gameObject->Physics()->GetWorld() != nullptr)
+      gameObject->Physics()->GetWorld()->RemovePhysicsObject(gameObject->Physics());
 
     gameObject->m_parent->m_vpChildren.erase(it);
 
@@ -70,18 +70,35 @@ void Scene::OnUpdateScene(float dt)
 
 void Scene::BuildWorldMatrices()
 {
-  UpdateWorldMatrices(m_pRootGameObject, Matrix4());
+  PhysicsEngine *physics = PhysicsEngine::Instance();
+
+  if (physics->IsPhysicsThreadRunning())
+  {
+    // Render from the published snapshots rather than the state currently being simulated
+    std::lock_guard<std::mutex> lock(physics->SnapshotMutex());
+    UpdateWorldMatrices(m_pRootGameObject, Matrix4(), true, physics->GetSnapshotAlpha());
+  }
+  else
+  {
+    UpdateWorldMatrices(m_pRootGameObject, Matrix4(), false, 1.0f);
+  }
 }
 
-void Scene::UpdateWorldMatrices(Object *cNode, const Matrix4 &parentWM)
+void Scene::UpdateWorldMatrices(Object *cNode, const Matrix4 &parentWM, bool useSnapshot, float alpha)
 {
   if (cNode->HasPhysics())
-    cNode->m_WorldTransform = parentWM * cNode->Physics()->GetWorldSpaceTransform() * cNode->m_LocalTransform;
+  {
+    Matrix4 physicsWM = useSnapshot ? cNode->Physics()->GetSnapshotWorldSpaceTransform(alpha)
+                                    : cNode->Physics()->GetWorldSpaceTransform();
+    cNode->m_WorldTransform = parentWM * physicsWM * cNode->m_LocalTransform;
+  }
   else
+  {
     cNode->m_WorldTransform = parentWM * cNode->m_LocalTransform;
+  }
 
   for (auto child : cNode->GetChildren())
-    UpdateWorldMatrices(child, cNode->m_WorldTransform);
+    UpdateWorldMatrices(child, cNode->m_WorldTransform, useSnapshot, alpha);
 }
 
 void Scene::InsertToRenderList(RenderList *list, const Frustum &frustum)
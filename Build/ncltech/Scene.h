@@ -109,8 +109,8 @@ public:
   void BuildWorldMatrices();
 
 protected:
-  // Recursive function called via 'BuildWorldMatrices'
-  void UpdateWorldMatrices(Object *node, const Matrix4 &parentWM);
+  // Recursive function called via 'BuildWorldMatrices', uses the interpolated physics snapshot if useSnapshot is set
+  void UpdateWorldMatrices(Object *node, const Matrix4 &parentWM, bool useSnapshot, float alpha);
 
   // Recusive function called via 'InsertToRenderList'
   void InsertToRenderList(Object *node, RenderList *list, const Frustum &frustum);
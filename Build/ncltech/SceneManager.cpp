@@ -53,6 +53,9 @@ void SceneManager::JumpToScene(int idx)
     return;
   }
 
+  // Hold the simulation for the whole change so a running physics thread never sees a partially built scene
+  std::lock_guard<std::recursive_mutex> lock(PhysicsEngine::Instance()->SimulationMutex());
+
   // Clear up old scene
   if (m_pScene)
   {
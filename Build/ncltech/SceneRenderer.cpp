@@ -259,6 +259,9 @@ void SceneRenderer::UpdateScene(float dt)
 {
   if (m_pScene != NULL)
   {
+    // Object picking and scene logic modify physics objects
+    std::lock_guard<std::recursive_mutex> lock(PhysicsEngine::Instance()->SimulationMutex());
+
     if (!ScreenPicker::Instance()->HandleMouseClicks(dt))
       m_pCamera->HandleMouse(dt);
 
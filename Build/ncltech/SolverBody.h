@@ -0,0 +1,19 @@
+#pragma once
+
+#include <nclgl\Matrix3.h>
+#include <nclgl\Vector3.h>
+
+/**
+ * @brief Motion state of an object as seen by the constraint solver during a single physics step.
+ *
+ * Solver bodies are built from the objects in the simulation before any constraints are solved and their velocities are
+ * written back to the objects once all solver iterations are complete, so the solver only touches this compact state.
+ */
+struct SolverBody
+{
+  Vector3 linearVelocity;  //!< Linear velocity
+  Vector3 angularVelocity; //!< Angular velocity
+  float inverseMass;       //!< Inverse mass
+  Matrix3 inverseInertia;  //!< Inverse inertia in world space
+  bool isStatic;           //!< Flag indicating the body is never modified by the solver
+};
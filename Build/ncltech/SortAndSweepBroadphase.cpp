@@ -34,11 +34,6 @@ void SortAndSweepBroadphase::SetAxis(const Vector3 &axis)
     m_axisIndex = 1;
   else if (abs(m_axis.z) > 0.9f)
     m_axisIndex = 2;
-
-  // Generate comparator
-  m_sortComparator = [this](PhysicsObject *a, PhysicsObject *b) {
-    return a->GetWorldSpaceAABB().Lower()[this->m_axisIndex] < b->GetWorldSpaceAABB().Lower()[this->m_axisIndex];
-  };
 }
 
 /**
@@ -47,30 +42,43 @@ void SortAndSweepBroadphase::SetAxis(const Vector3 &axis)
 void SortAndSweepBroadphase::FindPotentialCollisionPairs(std::vector<PhysicsObject *> &objects,
                                                          std::vector<CollisionPair> &collisionPairs)
 {
+  // Cache extents along axis so each AABB is only fetched once
+  m_extents.resize(objects.size());
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    const BoundingBox aabb = objects[i]->GetWorldSpaceAABB();
+    m_extents[i].lower = aabb.Lower()[m_axisIndex];
+    m_extents[i].upper = aabb.Upper()[m_axisIndex];
+    m_extents[i].object = objects[i];
+  }
+
   // Sort entities along axis
-  std::sort(objects.begin(), objects.end(), m_sortComparator);
+  std::sort(m_extents.begin(), m_extents.end(),
+            [](const AxisExtent &a, const AxisExtent &b) { return a.lower < b.lower; });
 
-  for (auto it = objects.begin(); it != objects.end(); ++it)
+  for (size_t i = 0; i < m_extents.size(); ++i)
+    objects[i] = m_extents[i].object;
+
+  for (auto it = m_extents.begin(); it != m_extents.end(); ++it)
   {
-    float thisBoxRight = (*it)->GetWorldSpaceAABB().Upper()[m_axisIndex];
+    const float thisBoxRight = it->upper;
+    const bool thisAtRest = it->object->IsAtRest();
 
-    for (auto iit = it + 1; iit != objects.end(); ++iit)
+    for (auto iit = it + 1; iit != m_extents.end(); ++iit)
     {
+      // Extents are sorted, no later object can overlap once one starts beyond this box
+      if (iit->lower >= thisBoxRight)
+        break;
+
       // Skip pairs of two at rest objects
-      if ((*it)->IsAtRest() && (*iit)->IsAtRest())
+      if (thisAtRest && iit->object->IsAtRest())
         continue;
 
-      float testBoxLeft = (*iit)->GetWorldSpaceAABB().Lower()[m_axisIndex];
-
-      // Test for overlap between the axis values of the bounding boxes
-      if (testBoxLeft < thisBoxRight)
-      {
-        CollisionPair cp;
-        cp.pObjectA = *it;
-        cp.pObjectB = *iit;
+      CollisionPair cp;
+      cp.pObjectA = it->object;
+      cp.pObjectB = iit->object;
 
-        collisionPairs.push_back(cp);
-      }
+      collisionPairs.push_back(cp);
     }
   }
 }
@@ -2,7 +2,6 @@
 
 #include "IBroadphase.h"
 
-#include <functional>
 #include <nclgl/Vector3.h>
 
 /**
@@ -31,8 +30,18 @@ public:
   virtual void DebugDraw();
 
 protected:
+  /**
+   * @brief Extent of an object along the axis, cached for sorting and sweeping.
+   */
+  struct AxisExtent
+  {
+    float lower;           //!< Lower bound of the object AABB along the axis
+    float upper;           //!< Upper bound of the object AABB along the axis
+    PhysicsObject *object; //!< Object
+  };
+
   Vector3 m_axis;  //!< Axis along which testing is performed
   int m_axisIndex; //!< Index of axis along which testing is performed
 
-  std::function<bool(PhysicsObject *, PhysicsObject *)> m_sortComparator; //!< Comparator used for sorting along axis
+  std::vector<AxisExtent> m_extents; //!< Object extents, sorted by lower bound
 };
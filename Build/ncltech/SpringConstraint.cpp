@@ -13,6 +13,8 @@ SpringConstraint::SpringConstraint(PhysicsObject *obj1, PhysicsObject *obj2, con
                                    float springConstant, float dampingFactor)
     : m_pObj1(obj1)
     , m_pObj2(obj2)
+    , m_pBody1(NULL)
+    , m_pBody2(NULL)
     , m_springConstant(springConstant)
     , m_dampingFactor(dampingFactor)
 {
@@ -25,13 +27,31 @@ SpringConstraint::SpringConstraint(PhysicsObject *obj1, PhysicsObject *obj2, con
   m_LocalOnB = Matrix3::Transpose(m_pObj2->GetOrientation().ToMatrix3()) * r2;
 }
 
+/**
+ * @copydoc IConstraint::PreSolverStep
+ */
+void SpringConstraint::PreSolverStep(float dt)
+{
+  PhysicsEngine *engine = m_pObj1->GetWorld();
+  m_pBody1 = engine->GetSolverBody(m_pObj1);
+  m_pBody2 = engine->GetSolverBody(m_pObj2);
+}
+
 /**
  * @copydoc IConstraint::ApplyImpulse
+ *
+ * Both objects must be in the simulation, otherwise no impulse is applied.
  */
-void SpringConstraint::ApplyImpulse()
+float SpringConstraint::ApplyImpulse()
 {
-  if (m_pObj1->GetInverseMass() + m_pObj2->GetInverseMass() == 0.0f)
-    return;
+  if (m_pBody1 == NULL || m_pBody2 == NULL)
+    return 0.0f;
+
+  SolverBody &body1 = *m_pBody1;
+  SolverBody &body2 = *m_pBody2;
+
+  if (body1.inverseMass + body2.inverseMass == 0.0f)
+    return 0.0f;
 
   Vector3 r1 = m_pObj1->GetOrientation().ToMatrix3() * m_LocalOnA;
   Vector3 r2 = m_pObj2->GetOrientation().ToMatrix3() * m_LocalOnB;
@@ -43,27 +63,36 @@ void SpringConstraint::ApplyImpulse()
   Vector3 abn = ab;
   abn.Normalise();
 
-  Vector3 v0 = m_pObj1->GetLinearVelocity() + Vector3::Cross(m_pObj1->GetAngularVelocity(), r1);
-  Vector3 v1 = m_pObj2->GetLinearVelocity() + Vector3::Cross(m_pObj2->GetAngularVelocity(), r2);
-  float constraintMass = (m_pObj1->GetInverseMass() + m_pObj2->GetInverseMass()) +
-                         Vector3::Dot(abn, Vector3::Cross(m_pObj1->GetInverseInertia() * Vector3::Cross(r1, abn), r1) +
-                                               Vector3::Cross(m_pObj2->GetInverseInertia() * Vector3::Cross(r2, abn), r2));
+  Vector3 v0 = body1.linearVelocity + Vector3::Cross(body1.angularVelocity, r1);
+  Vector3 v1 = body2.linearVelocity + Vector3::Cross(body2.angularVelocity, r2);
+  float constraintMass = (body1.inverseMass + body2.inverseMass) +
+                         Vector3::Dot(abn, Vector3::Cross(body1.inverseInertia * Vector3::Cross(r1, abn), r1) +
+                                               Vector3::Cross(body2.inverseInertia * Vector3::Cross(r2, abn), r2));
 
   float b = 0.0f;
   {
     float distanceOffset = ab.Length() - m_restDistance;
     float baumgarteScalar = 0.1f;
-    b = -(baumgarteScalar / PhysicsEngine::Instance()->GetDeltaTime()) * distanceOffset;
+    b = -(baumgarteScalar / m_pObj1->GetWorld()->GetDeltaTime()) * distanceOffset;
   }
 
   float jn = (-(Vector3::Dot(v0 - v1, abn) + b) * m_springConstant) - (m_dampingFactor * (v0 - v1).Length());
   jn /= constraintMass;
 
-  m_pObj1->SetLinearVelocity(m_pObj1->GetLinearVelocity() + abn * (jn * m_pObj1->GetInverseMass()));
-  m_pObj2->SetLinearVelocity(m_pObj2->GetLinearVelocity() - abn * (jn * m_pObj2->GetInverseMass()));
+  // Static objects are never written to as they may be shared between islands solved in parallel
+  if (!body1.isStatic)
+  {
+    body1.linearVelocity += abn * (jn * body1.inverseMass);
+    body1.angularVelocity += body1.inverseInertia * Vector3::Cross(r1, abn * jn);
+  }
+
+  if (!body2.isStatic)
+  {
+    body2.linearVelocity -= abn * (jn * body2.inverseMass);
+    body2.angularVelocity -= body2.inverseInertia * Vector3::Cross(r2, abn * jn);
+  }
 
-  m_pObj1->SetAngularVelocity(m_pObj1->GetAngularVelocity() + m_pObj1->GetInverseInertia() * Vector3::Cross(r1, abn * jn));
-  m_pObj2->SetAngularVelocity(m_pObj2->GetAngularVelocity() - m_pObj2->GetInverseInertia() * Vector3::Cross(r2, abn * jn));
+  return fabsf(jn);
 }
 
 /**
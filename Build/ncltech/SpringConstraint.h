@@ -15,12 +15,32 @@ public:
   SpringConstraint(PhysicsObject *obj1, PhysicsObject *obj2, const Vector3 &globalOnA, const Vector3 &globalOnB,
                    float springConstant, float dampingFactor);
 
-  virtual void ApplyImpulse() override;
+  virtual float ApplyImpulse() override;
+  virtual void PreSolverStep(float dt) override;
+
+  /**
+   * @copydoc IConstraint::NodeA
+   */
+  virtual PhysicsObject *NodeA() const override
+  {
+    return m_pObj1;
+  }
+
+  /**
+   * @copydoc IConstraint::NodeB
+   */
+  virtual PhysicsObject *NodeB() const override
+  {
+    return m_pObj2;
+  }
+
   virtual void DebugDraw() const;
 
 protected:
   PhysicsObject *m_pObj1; //!< First object
   PhysicsObject *m_pObj2; //!< Second object
+  SolverBody *m_pBody1;   //!< Solver state of first object in the current step
+  SolverBody *m_pBody2;   //!< Solver state of second object in the current step
 
   float m_restDistance; //!< Distance between objects when spring is at rest
 
@@ -16,7 +16,7 @@ WeldConstraint::WeldConstraint(PhysicsObject *obj1, PhysicsObject *obj2)
 /**
  * @copydoc IConstraint::ApplyImpulse
  */
-void WeldConstraint::ApplyImpulse()
+float WeldConstraint::ApplyImpulse()
 {
   // Position
   Vector3 pos(m_positionOffset);
@@ -26,6 +26,9 @@ void WeldConstraint::ApplyImpulse()
 
   // Orientation
   m_pObj2->SetOrientation(m_pObj1->GetOrientation() * m_orientation);
+
+  // Constraint is enforced directly on position, no impulse is applied
+  return 0.0f;
 }
 
 /**
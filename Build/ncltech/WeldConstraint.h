@@ -14,7 +14,24 @@ class WeldConstraint : public IConstraint
 public:
   WeldConstraint(PhysicsObject *obj1, PhysicsObject *obj2);
 
-  virtual void ApplyImpulse() override;
+  virtual float ApplyImpulse() override;
+
+  /**
+   * @copydoc IConstraint::NodeA
+   */
+  virtual PhysicsObject *NodeA() const override
+  {
+    return m_pObj1;
+  }
+
+  /**
+   * @copydoc IConstraint::NodeB
+   */
+  virtual PhysicsObject *NodeB() const override
+  {
+    return m_pObj2;
+  }
+
   virtual void DebugDraw() const;
 
 protected:
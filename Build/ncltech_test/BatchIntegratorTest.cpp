@@ -0,0 +1,150 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/BatchIntegrator.h>
+#include <ncltech/PhysicsObject.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+/**
+ * @brief Motion state of a single body, integrated with the scalar integrator.
+ */
+struct BodyState
+{
+  Vector3 position;
+  Vector3 linearVelocity;
+  Quaternion orientation;
+  Vector3 angularVelocity;
+};
+
+/**
+ * @brief Creates bodies with varied motion state, enough to fill the widest SIMD lanes and leave a remainder.
+ */
+std::vector<PhysicsObject *> CreateBodies()
+{
+  std::vector<PhysicsObject *> objects;
+  for (int i = 0; i < 13; ++i)
+  {
+    float f = (float)i;
+
+    PhysicsObject *obj = new PhysicsObject();
+    obj->SetPosition(Vector3(f, 2.0f - f * 0.5f, f * 0.25f));
+    obj->SetLinearVelocity(Vector3(1.0f - f * 0.1f, f * 0.3f, -2.0f));
+    obj->SetForce(Vector3(0.5f, -9.81f, f * 0.2f));
+    obj->SetInverseMass(1.0f / (1.0f + f));
+    obj->SetOrientation(Quaternion::AxisAngleToQuaterion(Vector3(0.0f, 1.0f, 0.0f), f * 10.0f));
+    obj->SetAngularVelocity(Vector3(f * 0.1f, 1.0f, -f * 0.05f));
+    obj->SetTorque(Vector3(0.1f, 0.0f, f * 0.01f));
+    obj->SetInverseInertia(Matrix3(0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 2.0f));
+    obj->SetDampingCoefficient(0.999f - f * 0.001f);
+    objects.push_back(obj);
+  }
+  return objects;
+}
+
+/**
+ * @brief Integrates the state of each object over one timestep using IntegrationHelpers::Integrate().
+ */
+template <IntegrationType Type> std::vector<BodyState> IntegrateScalar(const std::vector<PhysicsObject *> &objects, float dt)
+{
+  std::vector<BodyState> states;
+  for (PhysicsObject *obj : objects)
+  {
+    BodyState s;
+    s.position = obj->GetPosition();
+    s.linearVelocity = obj->GetLinearVelocity();
+    s.orientation = obj->GetOrientation();
+    s.angularVelocity = obj->GetAngularVelocity();
+
+    IntegrationHelpers::Integrate<Type>(dt, obj->GetDampingCoefficient(), s.position, s.linearVelocity, obj->GetForce(),
+                                        obj->GetInverseMass(), s.orientation, s.angularVelocity, obj->GetTorque(),
+                                        obj->GetInverseInertia());
+    states.push_back(s);
+  }
+  return states;
+}
+
+/**
+ * @brief Asserts that a value is within BatchIntegrator::TOLERANCE relative error of the expected value.
+ */
+void AssertWithinTolerance(float expected, float actual)
+{
+  Assert::AreEqual(expected, actual, BatchIntegrator::TOLERANCE * std::fmax(1.0f, std::fabs(expected)));
+}
+
+void AssertWithinTolerance(const Vector3 &expected, const Vector3 &actual)
+{
+  AssertWithinTolerance(expected.x, actual.x);
+  AssertWithinTolerance(expected.y, actual.y);
+  AssertWithinTolerance(expected.z, actual.z);
+}
+
+/**
+ * @brief Integrates the same bodies with the batch and scalar integrators and compares the results.
+ */
+template <IntegrationType Type> void TestMatchesScalar(bool simd)
+{
+  const float dt = 1.0f / 60.0f;
+
+  std::vector<PhysicsObject *> objects = CreateBodies();
+  std::vector<BodyState> expected = IntegrateScalar<Type>(objects, dt);
+
+  PhysicsBodyStore store;
+  std::vector<size_t> indices;
+  for (PhysicsObject *obj : objects)
+    indices.push_back(store.Index(store.Add(obj)));
+
+  BatchIntegrator integrator;
+  integrator.SetSimdEnabled(simd);
+  integrator.Integrate(store, indices, Type, dt);
+
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    AssertWithinTolerance(expected[i].position, objects[i]->GetPosition());
+    AssertWithinTolerance(expected[i].linearVelocity, objects[i]->GetLinearVelocity());
+    AssertWithinTolerance(expected[i].angularVelocity, objects[i]->GetAngularVelocity());
+
+    const Quaternion &q = objects[i]->GetOrientation();
+    AssertWithinTolerance(expected[i].orientation.x, q.x);
+    AssertWithinTolerance(expected[i].orientation.y, q.y);
+    AssertWithinTolerance(expected[i].orientation.z, q.z);
+    AssertWithinTolerance(expected[i].orientation.w, q.w);
+  }
+
+  for (auto it = objects.begin(); it != objects.end(); ++it)
+    delete *it;
+}
+}
+
+// clang-format off
+TEST_CLASS(BatchIntegratorTest)
+{
+public:
+  TEST_METHOD(BatchIntegrator_ExplicitEuler)
+  {
+    TestMatchesScalar<INTEGRATION_EXPLICIT_EULER>(true);
+    TestMatchesScalar<INTEGRATION_EXPLICIT_EULER>(false);
+  }
+
+  TEST_METHOD(BatchIntegrator_SemiImplicitEuler)
+  {
+    TestMatchesScalar<INTEGRATION_SEMI_IMPLICIT_EULER>(true);
+    TestMatchesScalar<INTEGRATION_SEMI_IMPLICIT_EULER>(false);
+  }
+
+  TEST_METHOD(BatchIntegrator_RungeKutta2)
+  {
+    TestMatchesScalar<INTEGRATION_RUNGE_KUTTA_2>(true);
+    TestMatchesScalar<INTEGRATION_RUNGE_KUTTA_2>(false);
+  }
+
+  TEST_METHOD(BatchIntegrator_RungeKutta4)
+  {
+    TestMatchesScalar<INTEGRATION_RUNGE_KUTTA_4>(true);
+    TestMatchesScalar<INTEGRATION_RUNGE_KUTTA_4>(false);
+  }
+};
@@ -72,6 +72,17 @@ public:
     Assert::IsTrue(b1.Intersects(b2));
     Assert::IsTrue(b1.Intersects(b3));
     Assert::IsFalse(b2.Intersects(b3));
+
+    // Containment (no corners of the larger box inside the smaller box)
+    BoundingBox b4(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f));
+    Assert::IsTrue(b4.Intersects(b1));
+    Assert::IsTrue(b1.Intersects(b4));
+
+    // Crossing boxes (no corners of either box inside the other)
+    BoundingBox b5(Vector3(-5.0f, 0.0f, 0.0f), Vector3(5.0f, 1.0f, 1.0f));
+    BoundingBox b6(Vector3(0.0f, -5.0f, 0.0f), Vector3(1.0f, 5.0f, 1.0f));
+    Assert::IsTrue(b5.Intersects(b6));
+    Assert::IsTrue(b6.Intersects(b5));
   }
 
   TEST_METHOD(BoundingBox_BoundingSphereRadius)
@@ -0,0 +1,48 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/DisjointSet.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(DisjointSetTest)
+{
+public:
+  TEST_METHOD(DisjointSet_Init)
+  {
+    DisjointSet s(5);
+
+    Assert::AreEqual((size_t)5, s.Size());
+
+    for (size_t i = 0; i < 5; ++i)
+      Assert::AreEqual(i, s.Find(i));
+  }
+
+  TEST_METHOD(DisjointSet_Union)
+  {
+    DisjointSet s(6);
+
+    Assert::IsTrue(s.Union(0, 1));
+    Assert::IsTrue(s.Union(2, 3));
+    Assert::IsTrue(s.Union(1, 3));
+    Assert::IsFalse(s.Union(0, 2));
+
+    Assert::AreEqual(s.Find(0), s.Find(3));
+    Assert::AreEqual(s.Find(1), s.Find(2));
+    Assert::AreNotEqual(s.Find(0), s.Find(4));
+    Assert::AreNotEqual(s.Find(4), s.Find(5));
+  }
+
+  TEST_METHOD(DisjointSet_Reset)
+  {
+    DisjointSet s(3);
+    s.Union(0, 1);
+    s.Union(1, 2);
+
+    s.Reset(4);
+
+    Assert::AreEqual((size_t)4, s.Size());
+    for (size_t i = 0; i < 4; ++i)
+      Assert::AreEqual(i, s.Find(i));
+  }
+};
@@ -0,0 +1,144 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/DynamicTreeBroadphase.h>
+#include <ncltech/SphereCollisionShape.h>
+
+#include <algorithm>
+
+#include "TestDataGenerator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(DynamicTreeBroadphaseTest)
+{
+public:
+  TEST_METHOD(DynamicTreeBroadphase_MatchesBruteForce)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(8, 0.9f);
+
+    DynamicTreeBroadphase tree;
+    std::vector<CollisionPair> pairs;
+    tree.FindPotentialCollisionPairs(objects, pairs);
+
+    Assert::AreEqual((size_t)64, tree.NumObjects());
+    Assert::AreEqual(OverlappingPairs(objects).size(), pairs.size());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    // Balanced tree of 64 leaves
+    Assert::IsTrue(tree.Height() <= 12);
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(DynamicTreeBroadphase_PairOrderMatchesBruteForce)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(6, 0.9f);
+
+    // Brute force only pairs objects that have collision shapes
+    for (PhysicsObject *obj : objects)
+      obj->AddCollisionShape(new SphereCollisionShape(0.5f));
+
+    DynamicTreeBroadphase tree;
+
+    for (int i = 0; i < 2; ++i)
+    {
+      // Reordering the object list (without moving any objects) must reorder the pairs
+      if (i == 1)
+        std::reverse(objects.begin(), objects.end());
+
+      std::vector<CollisionPair> pairs;
+      tree.FindPotentialCollisionPairs(objects, pairs);
+
+      Assert::IsTrue(SamePairOrder(BruteForceOverlappingPairs(objects), pairs));
+    }
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(DynamicTreeBroadphase_Reinsertion)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(4, 2.0f);
+
+    DynamicTreeBroadphase tree(0.1f);
+    std::vector<CollisionPair> pairs;
+    tree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, pairs.size());
+
+    // Small movement stays inside the fattened box
+    objects[0]->SetPosition(objects[0]->GetPosition() + Vector3(0.05f, 0.0f, 0.0f));
+    pairs.clear();
+    tree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, tree.NumReinsertions());
+
+    // Move onto a neighbour
+    objects[0]->SetPosition(objects[1]->GetPosition());
+    pairs.clear();
+    tree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)1, tree.NumReinsertions());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+    Assert::AreEqual((size_t)1, pairs.size());
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(DynamicTreeBroadphase_Removal)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(4, 0.9f);
+
+    DynamicTreeBroadphase tree;
+    std::vector<CollisionPair> pairs;
+    tree.FindPotentialCollisionPairs(objects, pairs);
+
+    PhysicsObject *removed = objects.back();
+    objects.pop_back();
+
+    pairs.clear();
+    tree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)15, tree.NumObjects());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    delete removed;
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(DynamicTreeBroadphase_BoxAndRayQueries)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(5, 2.0f);
+
+    DynamicTreeBroadphase tree;
+
+    std::vector<PhysicsObject *> results;
+    tree.FindObjectsInBox(objects, BoundingBox(Vector3(-0.1f, -1.0f, -0.1f), Vector3(2.1f, 1.0f, 0.1f)), results);
+    Assert::AreEqual((size_t)2, results.size());
+
+    BruteForceBroadphase bruteForce;
+    std::vector<PhysicsObject *> expected;
+    bruteForce.FindObjectsInBox(objects, BoundingBox(Vector3(-0.1f, -1.0f, -0.1f), Vector3(2.1f, 1.0f, 0.1f)), expected);
+    std::sort(results.begin(), results.end());
+    std::sort(expected.begin(), expected.end());
+    Assert::IsTrue(expected == results);
+
+    // Ray along the first row of objects (x = 0)
+    results.clear();
+    tree.FindObjectsOnRay(objects, Vector3(0.0f, 0.5f, -5.0f), Vector3(0.0f, 0.0f, 1.0f), 100.0f, results);
+    Assert::AreEqual((size_t)5, results.size());
+
+    // Limited distance
+    results.clear();
+    tree.FindObjectsOnRay(objects, Vector3(0.0f, 0.5f, -5.0f), Vector3(0.0f, 0.0f, 2.0f), 5.0f, results);
+    Assert::AreEqual((size_t)1, results.size());
+
+    // Ray missing all objects
+    results.clear();
+    tree.FindObjectsOnRay(objects, Vector3(1.0f, 0.5f, -5.0f), Vector3(0.0f, 0.0f, 1.0f), 100.0f, results);
+    Assert::AreEqual((size_t)0, results.size());
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+};
@@ -0,0 +1,131 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/IncrementalSortAndSweepBroadphase.h>
+#include <ncltech/SphereCollisionShape.h>
+
+#include <algorithm>
+
+#include "TestDataGenerator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(IncrementalSortAndSweepBroadphaseTest)
+{
+public:
+  TEST_METHOD(IncrementalSortAndSweepBroadphase_MatchesBruteForce)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(8, 0.9f);
+
+    IncrementalSortAndSweepBroadphase sap(0.0f);
+    std::vector<CollisionPair> pairs;
+    sap.FindPotentialCollisionPairs(objects, pairs);
+
+    Assert::AreEqual((size_t)64, sap.NumObjects());
+    Assert::AreEqual(OverlappingPairs(objects).size(), pairs.size());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(IncrementalSortAndSweepBroadphase_PairOrderMatchesBruteForce)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(6, 0.9f);
+
+    // Brute force only pairs objects that have collision shapes
+    for (PhysicsObject *obj : objects)
+      obj->AddCollisionShape(new SphereCollisionShape(0.5f));
+
+    IncrementalSortAndSweepBroadphase sap(0.0f);
+
+    for (int i = 0; i < 2; ++i)
+    {
+      // Reordering the object list (without moving any objects) must reorder the pairs
+      if (i == 1)
+        std::reverse(objects.begin(), objects.end());
+
+      std::vector<CollisionPair> pairs;
+      sap.FindPotentialCollisionPairs(objects, pairs);
+
+      Assert::IsTrue(SamePairOrder(BruteForceOverlappingPairs(objects), pairs));
+    }
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(IncrementalSortAndSweepBroadphase_Movement)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(4, 2.0f);
+
+    IncrementalSortAndSweepBroadphase sap(0.0f);
+    std::vector<CollisionPair> pairs;
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, pairs.size());
+
+    // No movement, no endpoints need to move
+    pairs.clear();
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, sap.NumSwaps());
+    Assert::AreEqual((size_t)0, pairs.size());
+
+    // Move onto a neighbour
+    objects[0]->SetPosition(objects[1]->GetPosition() + Vector3(0.1f, 0.1f, 0.1f));
+    pairs.clear();
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)1, pairs.size());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    // Move back
+    objects[0]->SetPosition(Vector3(0.0f, 0.0f, 0.0f));
+    pairs.clear();
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, pairs.size());
+    Assert::AreEqual((size_t)0, sap.NumOverlappingPairs());
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(IncrementalSortAndSweepBroadphase_Removal)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(4, 0.9f);
+
+    IncrementalSortAndSweepBroadphase sap(0.0f);
+    std::vector<CollisionPair> pairs;
+    sap.FindPotentialCollisionPairs(objects, pairs);
+
+    PhysicsObject *removed = objects[5];
+    objects.erase(objects.begin() + 5);
+
+    pairs.clear();
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)15, sap.NumObjects());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    // Removed proxy is reused
+    objects.push_back(removed);
+    pairs.clear();
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)16, sap.NumObjects());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(IncrementalSortAndSweepBroadphase_Margin)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(2, 1.05f);
+
+    // Gap of 0.05 between neighbouring boxes is closed by the margin, all boxes pair with each other
+    IncrementalSortAndSweepBroadphase sap(0.05f);
+    std::vector<CollisionPair> pairs;
+    sap.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)6, pairs.size());
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+};
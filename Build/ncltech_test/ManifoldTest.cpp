@@ -0,0 +1,38 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/Manifold.h>
+#include <ncltech/PhysicsObject.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(ManifoldTest)
+{
+public:
+  TEST_METHOD(Manifold_SolvedWithoutSolverBodies)
+  {
+    // Objects are not in a world so have no solver bodies, the manifold must solve their velocities directly
+    PhysicsObject objA;
+    objA.SetInverseMass(1.0f);
+    objA.SetLinearVelocity(Vector3(1.0f, 0.0f, 0.0f));
+
+    PhysicsObject objB;
+    objB.SetInverseMass(1.0f);
+    objB.SetPosition(Vector3(1.9f, 0.0f, 0.0f));
+    objB.SetLinearVelocity(Vector3(-1.0f, 0.0f, 0.0f));
+
+    Manifold manifold;
+    manifold.Initiate(&objA, &objB);
+    manifold.AddContact(Vector3(1.0f, 0.0f, 0.0f), Vector3(0.9f, 0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), -0.1f);
+
+    manifold.PreSolverStep(1.0f / 60.0f);
+    for (int i = 0; i < 10; ++i)
+      manifold.ApplyImpulse();
+
+    // Objects no longer approach each other
+    Assert::IsTrue(objA.GetLinearVelocity().x <= objB.GetLinearVelocity().x);
+
+    // Equal and opposite impulses applied to each object
+    Assert::AreEqual(0.0f, objA.GetLinearVelocity().x + objB.GetLinearVelocity().x, 0.0001f);
+  }
+};
@@ -0,0 +1,136 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/OctreeBroadphase.h>
+#include <ncltech/SphereCollisionShape.h>
+
+#include <algorithm>
+
+#include "TestDataGenerator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(OctreeBroadphaseTest)
+{
+public:
+  TEST_METHOD(OctreeBroadphase_MatchesBruteForce)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(10, 0.9f);
+
+    OctreeBroadphase octree(4, 5);
+    std::vector<CollisionPair> pairs;
+    octree.FindPotentialCollisionPairs(objects, pairs);
+
+    Assert::AreEqual((size_t)100, octree.NumObjects());
+    Assert::IsTrue(octree.NumDivisions() > 1);
+
+    // Each pair is reported exactly once
+    Assert::AreEqual(OverlappingPairs(objects).size(), pairs.size());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(OctreeBroadphase_PairOrderMatchesBruteForce)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(6, 0.9f);
+
+    // Brute force only pairs objects that have collision shapes
+    for (PhysicsObject *obj : objects)
+      obj->AddCollisionShape(new SphereCollisionShape(0.5f));
+
+    OctreeBroadphase octree(4, 5);
+
+    for (int i = 0; i < 2; ++i)
+    {
+      // Reordering the object list (without moving any objects) must reorder the pairs
+      if (i == 1)
+        std::reverse(objects.begin(), objects.end());
+
+      std::vector<CollisionPair> pairs;
+      octree.FindPotentialCollisionPairs(objects, pairs);
+
+      Assert::IsTrue(SamePairOrder(BruteForceOverlappingPairs(objects), pairs));
+    }
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(OctreeBroadphase_Relocation)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(6, 2.0f);
+
+    OctreeBroadphase octree(2, 5);
+    std::vector<CollisionPair> pairs;
+    octree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, pairs.size());
+
+    // No movement, nothing is relocated
+    pairs.clear();
+    octree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, octree.NumRelocations());
+
+    // Move across the scene onto another object
+    objects[0]->SetPosition(objects[35]->GetPosition() + Vector3(0.1f, 0.1f, 0.1f));
+    pairs.clear();
+    octree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)1, octree.NumRelocations());
+    Assert::AreEqual((size_t)1, pairs.size());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    // Move outside of the root cell
+    objects[0]->SetPosition(Vector3(-100.0f, 0.0f, 0.0f));
+    pairs.clear();
+    octree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)0, pairs.size());
+    Assert::AreEqual((size_t)36, octree.NumObjects());
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(OctreeBroadphase_Removal)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(6, 0.9f);
+
+    OctreeBroadphase octree(4, 5);
+    std::vector<CollisionPair> pairs;
+    octree.FindPotentialCollisionPairs(objects, pairs);
+    const size_t numDivisions = octree.NumDivisions();
+
+    // Removing all objects frees all subdivisions
+    std::vector<PhysicsObject *> none;
+    pairs.clear();
+    octree.FindPotentialCollisionPairs(none, pairs);
+    Assert::AreEqual((size_t)0, octree.NumObjects());
+    Assert::AreEqual((size_t)1, octree.NumDivisions());
+
+    // Objects are reinserted into the same number of subdivisions
+    pairs.clear();
+    octree.FindPotentialCollisionPairs(objects, pairs);
+    Assert::AreEqual((size_t)36, octree.NumObjects());
+    Assert::AreEqual(numDivisions, octree.NumDivisions());
+    Assert::IsTrue(OverlappingPairs(objects) == ToPairSet(pairs));
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+
+  TEST_METHOD(OctreeBroadphase_FindObjectsInBox)
+  {
+    std::vector<PhysicsObject *> objects = GenerateBoxGrid(6, 2.0f);
+
+    OctreeBroadphase octree(2, 5);
+    std::vector<PhysicsObject *> results;
+    octree.FindObjectsInBox(objects, BoundingBox(Vector3(-0.5f, -0.5f, -0.5f), Vector3(2.5f, 0.5f, 0.5f)), results);
+
+    Assert::AreEqual((size_t)2, results.size());
+    Assert::IsTrue(std::find(results.begin(), results.end(), objects[0]) != results.end());
+    Assert::IsTrue(std::find(results.begin(), results.end(), objects[6]) != results.end());
+
+    for (auto it = objects.begin(); it != objects.end(); ++it)
+      delete *it;
+  }
+};
@@ -0,0 +1,83 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/PhysicsCommandQueue.h>
+#include <ncltech/PhysicsEngine.h>
+
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(PhysicsCommandQueueTest)
+{
+public:
+  TEST_METHOD(PhysicsCommandQueue_Empty)
+  {
+    PhysicsCommandQueue q;
+    PhysicsCommand command;
+
+    Assert::IsTrue(q.IsEmpty());
+    Assert::IsFalse(q.Pop(command));
+  }
+
+  TEST_METHOD(PhysicsCommandQueue_Order)
+  {
+    PhysicsEngine world;
+
+    PhysicsCommandQueue q;
+    std::vector<int> applied;
+
+    for (int i = 0; i < 5; ++i)
+      q.Push([&applied, i](PhysicsEngine &) { applied.push_back(i); });
+
+    Assert::IsFalse(q.IsEmpty());
+
+    PhysicsCommand command;
+    while (q.Pop(command))
+      command(world);
+
+    Assert::IsTrue(q.IsEmpty());
+    Assert::AreEqual((size_t)5, applied.size());
+    for (int i = 0; i < 5; ++i)
+      Assert::AreEqual(i, applied[i]);
+  }
+
+  TEST_METHOD(PhysicsCommandQueue_MultipleProducers)
+  {
+    PhysicsEngine world;
+
+    const int numProducers = 4;
+    const int numCommands = 10000;
+
+    PhysicsCommandQueue q;
+    std::vector<int> last(numProducers, -1);
+    bool inOrder = true;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p)
+    {
+      producers.push_back(std::thread([&, p]() {
+        for (int i = 0; i < numCommands; ++i)
+          q.Push([&, p, i](PhysicsEngine &) {
+            inOrder &= (last[p] == i - 1);
+            last[p] = i;
+          });
+      }));
+    }
+
+    for (auto &t : producers)
+      t.join();
+
+    PhysicsCommand command;
+    int numPopped = 0;
+    while (q.Pop(command))
+    {
+      command(world);
+      numPopped++;
+    }
+
+    Assert::AreEqual(numProducers * numCommands, numPopped);
+    Assert::IsTrue(inOrder);
+  }
+};
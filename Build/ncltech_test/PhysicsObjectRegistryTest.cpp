@@ -0,0 +1,96 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/PhysicsObjectRegistry.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// clang-format off
+TEST_CLASS(PhysicsObjectRegistryTest)
+{
+public:
+  TEST_METHOD(PhysicsObjectRegistry_AddGet)
+  {
+    int a, b;
+    PhysicsObject *objA = reinterpret_cast<PhysicsObject *>(&a);
+    PhysicsObject *objB = reinterpret_cast<PhysicsObject *>(&b);
+
+    PhysicsObjectRegistry r;
+    PhysicsObjectHandle hA = r.Add(objA, "a");
+    PhysicsObjectHandle hB = r.Add(objB, "b");
+
+    Assert::AreEqual((size_t)2, r.Size());
+    Assert::IsTrue(hA != INVALID_OBJECT_HANDLE);
+    Assert::IsTrue(hB != INVALID_OBJECT_HANDLE);
+    Assert::IsTrue(hA != hB);
+
+    Assert::IsTrue(objA == r.Get(hA));
+    Assert::IsTrue(objB == r.Get(hB));
+    Assert::IsNull(r.Get(INVALID_OBJECT_HANDLE));
+  }
+
+  TEST_METHOD(PhysicsObjectRegistry_RemoveStaleHandle)
+  {
+    int a, b;
+    PhysicsObject *objA = reinterpret_cast<PhysicsObject *>(&a);
+    PhysicsObject *objB = reinterpret_cast<PhysicsObject *>(&b);
+
+    PhysicsObjectRegistry r;
+    PhysicsObjectHandle hA = r.Add(objA, "a");
+
+    Assert::IsTrue(r.Remove(hA));
+    Assert::IsFalse(r.Remove(hA));
+    Assert::AreEqual((size_t)0, r.Size());
+    Assert::IsNull(r.Get(hA));
+
+    // Slot is reused, old handle must not resolve to the new object
+    PhysicsObjectHandle hB = r.Add(objB, "b");
+    Assert::IsTrue(hA != hB);
+    Assert::IsNull(r.Get(hA));
+    Assert::IsTrue(objB == r.Get(hB));
+  }
+
+  TEST_METHOD(PhysicsObjectRegistry_FindByName)
+  {
+    int a, b, c;
+    PhysicsObject *objA = reinterpret_cast<PhysicsObject *>(&a);
+    PhysicsObject *objB = reinterpret_cast<PhysicsObject *>(&b);
+    PhysicsObject *objC = reinterpret_cast<PhysicsObject *>(&c);
+
+    PhysicsObjectRegistry r;
+    PhysicsObjectHandle hA = r.Add(objA, "a");
+    r.Add(objB, "shared");
+    PhysicsObjectHandle hC = r.Add(objC, "shared");
+    r.Add(objC, "");
+
+    Assert::IsTrue(objA == r.FindByName("a"));
+    Assert::IsNull(r.FindByName("missing"));
+    Assert::IsNull(r.FindByName(""));
+
+    PhysicsObject *shared = r.FindByName("shared");
+    Assert::IsTrue(shared == objB || shared == objC);
+
+    r.Remove(hA);
+    r.Remove(hC);
+    Assert::IsNull(r.FindByName("a"));
+    Assert::IsTrue(objB == r.FindByName("shared"));
+  }
+
+  TEST_METHOD(PhysicsObjectRegistry_Clear)
+  {
+    int a;
+    PhysicsObject *objA = reinterpret_cast<PhysicsObject *>(&a);
+
+    PhysicsObjectRegistry r;
+    PhysicsObjectHandle hA = r.Add(objA, "a");
+
+    r.Clear();
+
+    Assert::AreEqual((size_t)0, r.Size());
+    Assert::IsNull(r.Get(hA));
+    Assert::IsNull(r.FindByName("a"));
+
+    PhysicsObjectHandle hA2 = r.Add(objA, "a");
+    Assert::IsTrue(hA != hA2);
+    Assert::IsTrue(objA == r.FindByName("a"));
+  }
+};
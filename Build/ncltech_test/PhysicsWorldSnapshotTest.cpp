@@ -0,0 +1,196 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/BruteForceBroadphase.h>
+#include <ncltech/CuboidCollisionShape.h>
+#include <ncltech/DynamicTreeBroadphase.h>
+#include <ncltech/IncrementalSortAndSweepBroadphase.h>
+#include <ncltech/OctreeBroadphase.h>
+#include <ncltech/PhysicsEngine.h>
+#include <ncltech/PhysicsWorldSnapshot.h>
+#include <ncltech/SortAndSweepBroadphase.h>
+#include <ncltech/SphereCollisionShape.h>
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+/**
+ * @brief Motion state of a single object.
+ */
+struct BodyState
+{
+  Vector3 position;
+  Vector3 linearVelocity;
+  Quaternion orientation;
+  Vector3 angularVelocity;
+};
+
+/**
+ * @brief Adds an object with a single collision shape to a world.
+ */
+PhysicsObject *AddObject(PhysicsEngine &world, ICollisionShape *shape, const Vector3 &position, float inverseMass)
+{
+  PhysicsObject *obj = new PhysicsObject();
+  obj->SetPosition(position);
+  obj->SetInverseMass(inverseMass);
+  obj->AddCollisionShape(shape);
+  obj->SetInverseInertia(shape->BuildInverseInertia(inverseMass));
+  obj->AutoResizeBoundingBox();
+  world.AddPhysicsObject(obj);
+  return obj;
+}
+
+/**
+ * @brief Builds a stack of spheres falling onto a ground box, with a trigger volume around the lower layer.
+ *
+ * Contact events are enabled on the trigger and on every sphere, so touching pairs are carried between steps.
+ */
+void BuildScene(PhysicsEngine &world)
+{
+  AddObject(world, new CuboidCollisionShape(Vector3(10.0f, 1.0f, 10.0f)), Vector3(0.0f, -1.0f, 0.0f), 0.0f);
+
+  for (int x = 0; x < 4; ++x)
+  {
+    for (int y = 0; y < 4; ++y)
+    {
+      for (int z = 0; z < 4; ++z)
+      {
+        // Layers are offset so the stack topples
+        Vector3 pos(x * 1.1f + y * 0.2f, 0.6f + y * 1.2f, z * 1.1f - y * 0.1f);
+        PhysicsObject *sphere = AddObject(world, new SphereCollisionShape(0.5f), pos, 1.0f);
+        sphere->SetContactEventsEnabled(true);
+      }
+    }
+  }
+
+  PhysicsObject *trigger = AddObject(world, new CuboidCollisionShape(Vector3(1.0f, 1.0f, 1.0f)), Vector3(1.5f, 1.0f, 1.5f), 0.0f);
+  trigger->SetTrigger(true);
+  trigger->SetContactEventsEnabled(true);
+}
+
+/**
+ * @brief Captures the motion state of every object in a world.
+ */
+std::vector<BodyState> CaptureState(PhysicsEngine &world)
+{
+  std::vector<BodyState> states;
+  for (PhysicsObject *obj : world.GetPhysicsObjects())
+  {
+    BodyState s;
+    s.position = obj->GetPosition();
+    s.linearVelocity = obj->GetLinearVelocity();
+    s.orientation = obj->GetOrientation();
+    s.angularVelocity = obj->GetAngularVelocity();
+    states.push_back(s);
+  }
+  return states;
+}
+
+void AssertIdentical(const Vector3 &expected, const Vector3 &actual)
+{
+  Assert::AreEqual(expected.x, actual.x);
+  Assert::AreEqual(expected.y, actual.y);
+  Assert::AreEqual(expected.z, actual.z);
+}
+
+/**
+ * @brief Checks that stepping after restoring a snapshot exactly reproduces the steps taken after saving it.
+ * @param broadphase Broadphase to use, owned by the world
+ */
+void TestRoundTrip(IBroadphase *broadphase)
+{
+  PhysicsEngine world;
+  world.SetBroadphase(broadphase);
+  BuildScene(world);
+
+  world.Step(60);
+
+  PhysicsWorldSnapshot snapshot;
+  world.SaveSnapshot(snapshot);
+
+  world.Step(100);
+  std::vector<BodyState> expected = CaptureState(world);
+  std::vector<ContactEvent> expectedEvents = world.GetContactEvents();
+
+  Assert::IsTrue(world.RestoreSnapshot(snapshot));
+  world.Step(100);
+  std::vector<BodyState> actual = CaptureState(world);
+  const std::vector<ContactEvent> &actualEvents = world.GetContactEvents();
+
+  // Objects may be reordered by the broadphase, but are put back in their saved order on restore
+  Assert::AreEqual(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    AssertIdentical(expected[i].position, actual[i].position);
+    AssertIdentical(expected[i].linearVelocity, actual[i].linearVelocity);
+    AssertIdentical(expected[i].angularVelocity, actual[i].angularVelocity);
+
+    Assert::AreEqual(expected[i].orientation.x, actual[i].orientation.x);
+    Assert::AreEqual(expected[i].orientation.y, actual[i].orientation.y);
+    Assert::AreEqual(expected[i].orientation.z, actual[i].orientation.z);
+    Assert::AreEqual(expected[i].orientation.w, actual[i].orientation.w);
+  }
+
+  Assert::IsFalse(expectedEvents.empty());
+  Assert::AreEqual(expectedEvents.size(), actualEvents.size());
+  for (size_t i = 0; i < expectedEvents.size(); ++i)
+  {
+    Assert::IsTrue(expectedEvents[i].type == actualEvents[i].type);
+    Assert::IsTrue(expectedEvents[i].objectA == actualEvents[i].objectA);
+    Assert::IsTrue(expectedEvents[i].objectB == actualEvents[i].objectB);
+    Assert::AreEqual(expectedEvents[i].penetration, actualEvents[i].penetration);
+  }
+}
+}
+
+// clang-format off
+TEST_CLASS(PhysicsWorldSnapshotTest)
+{
+public:
+  TEST_METHOD(PhysicsWorldSnapshot_RoundTripBruteForce)
+  {
+    TestRoundTrip(new BruteForceBroadphase());
+  }
+
+  TEST_METHOD(PhysicsWorldSnapshot_RoundTripSortAndSweep)
+  {
+    TestRoundTrip(new SortAndSweepBroadphase());
+  }
+
+  TEST_METHOD(PhysicsWorldSnapshot_RoundTripIncrementalSortAndSweep)
+  {
+    TestRoundTrip(new IncrementalSortAndSweepBroadphase());
+  }
+
+  TEST_METHOD(PhysicsWorldSnapshot_RoundTripOctree)
+  {
+    TestRoundTrip(new OctreeBroadphase(10, 4));
+  }
+
+  TEST_METHOD(PhysicsWorldSnapshot_RoundTripDynamicTree)
+  {
+    TestRoundTrip(new DynamicTreeBroadphase());
+  }
+
+  TEST_METHOD(PhysicsWorldSnapshot_RestoresObjectFlags)
+  {
+    PhysicsEngine world;
+    world.SetBroadphase(new BruteForceBroadphase());
+
+    PhysicsObject *obj = AddObject(world, new SphereCollisionShape(0.5f), Vector3(0.0f, 0.0f, 0.0f), 1.0f);
+
+    PhysicsWorldSnapshot snapshot;
+    world.SaveSnapshot(snapshot);
+
+    obj->SetTrigger(true);
+    obj->SetKinematic(true);
+    obj->SetContactEventsEnabled(true);
+
+    Assert::IsTrue(world.RestoreSnapshot(snapshot));
+    Assert::IsFalse(obj->IsTrigger());
+    Assert::IsFalse(obj->IsKinematic());
+    Assert::IsFalse(obj->IsContactEventsEnabled());
+  }
+};
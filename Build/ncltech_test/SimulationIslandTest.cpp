@@ -0,0 +1,64 @@
+#include "CppUnitTest.h"
+
+#include <ncltech/BruteForceBroadphase.h>
+#include <ncltech/PhysicsEngine.h>
+#include <ncltech/WeldConstraint.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+/**
+ * @brief Steps a world holding a static cube welded to a kinematic sphere spinning about the Y axis at 1 rad/s.
+ * @param islandSolving If island solving is enabled
+ * @param solver Constraint solver to use
+ * @return Position of the cube after 60 steps
+ */
+Vector3 StepWeldToKinematic(bool islandSolving, SolverType solver)
+{
+  PhysicsEngine world;
+  world.SetBroadphase(new BruteForceBroadphase());
+  world.SetIslandSolvingEnabled(islandSolving);
+  world.SetSolverType(solver);
+
+  PhysicsObject *sphere = new PhysicsObject();
+  sphere->SetInverseMass(0.0f);
+  sphere->SetKinematic(true);
+  sphere->SetAngularVelocity(Vector3(0.0f, 1.0f, 0.0f));
+  world.AddPhysicsObject(sphere);
+
+  PhysicsObject *cube = new PhysicsObject();
+  cube->SetInverseMass(0.0f);
+  cube->SetPosition(Vector3(6.0f, 0.0f, 0.0f));
+  world.AddPhysicsObject(cube);
+
+  world.AddConstraint(new WeldConstraint(sphere, cube));
+
+  world.Step(60);
+
+  return cube->GetPosition();
+}
+}
+
+// clang-format off
+TEST_CLASS(SimulationIslandTest)
+{
+public:
+  TEST_METHOD(SimulationIsland_StaticConstraintSolved)
+  {
+    Vector3 expected = StepWeldToKinematic(false, SOLVER_SEQUENTIAL);
+    Vector3 islands = StepWeldToKinematic(true, SOLVER_SEQUENTIAL);
+    Vector3 coloured = StepWeldToKinematic(true, SOLVER_GRAPH_COLOURED);
+
+    // Cube is carried around by the sphere
+    Assert::IsTrue((expected - Vector3(6.0f, 0.0f, 0.0f)).Length() > 1.0f);
+
+    Assert::AreEqual(expected.x, islands.x, 0.0001f);
+    Assert::AreEqual(expected.y, islands.y, 0.0001f);
+    Assert::AreEqual(expected.z, islands.z, 0.0001f);
+
+    Assert::AreEqual(expected.x, coloured.x, 0.0001f);
+    Assert::AreEqual(expected.y, coloured.y, 0.0001f);
+    Assert::AreEqual(expected.z, coloured.z, 0.0001f);
+  }
+};
@@ -1,5 +1,9 @@
 #include "TestDataGenerator.h"
 
+#include <algorithm>
+
+#include <ncltech/BruteForceBroadphase.h>
+
 void GenerateTestDataSet1(std::vector<PathNode *> &nodes, std::vector<PathEdge *> &edges)
 {
   nodes.push_back(new PathNode(Vector3(0.0f, 0.0f, 0.0f)));
@@ -32,4 +36,96 @@ void GenerateTestDataSet1(std::vector<PathNode *> &nodes, std::vector<PathEdge *
   edges.push_back(new PathEdge(nodes[7], nodes[5]));
   edges.push_back(new PathEdge(nodes[6], nodes[4]));
   edges.push_back(new PathEdge(nodes[4], nodes[8]));
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Creates a grid of unit box objects with a given spacing (heights are offset so no boxes exactly touch).
+ * @param n Number of objects along each side of the grid
+ * @param spacing Distance between neighbouring object centres
+ * @return Objects, owned by the caller
+ */
+std::vector<PhysicsObject *> GenerateBoxGrid(size_t n, float spacing)
+{
+  std::vector<PhysicsObject *> objects;
+  for (size_t i = 0; i < n; ++i)
+  {
+    for (size_t j = 0; j < n; ++j)
+    {
+      PhysicsObject *obj = new PhysicsObject();
+      obj->SetPosition(Vector3(i * spacing, (i + j) % 3 * 0.3f, j * spacing));
+      objects.push_back(obj);
+    }
+  }
+  return objects;
+}
+
+/**
+ * @brief Converts a list of collision pairs to a set of unordered pairs.
+ * @param pairs Collision pairs
+ * @return Set of pairs
+ */
+PairSet ToPairSet(const std::vector<CollisionPair> &pairs)
+{
+  PairSet s;
+  for (auto it = pairs.begin(); it != pairs.end(); ++it)
+    s.insert(std::make_pair(std::min(it->pObjectA, it->pObjectB), std::max(it->pObjectA, it->pObjectB)));
+  return s;
+}
+
+/**
+ * @brief Finds the pairs of objects with overlapping AABBs by testing every pair.
+ * @param objects Objects to test
+ * @return Set of overlapping pairs
+ */
+PairSet OverlappingPairs(const std::vector<PhysicsObject *> &objects)
+{
+  PairSet s;
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    for (size_t j = i + 1; j < objects.size(); ++j)
+    {
+      if (objects[i]->GetWorldSpaceAABB().Intersects(objects[j]->GetWorldSpaceAABB()))
+        s.insert(std::make_pair(std::min(objects[i], objects[j]), std::max(objects[i], objects[j])));
+    }
+  }
+  return s;
+}
+
+/**
+ * @brief Finds the pairs reported by BruteForceBroadphase that have overlapping AABBs.
+ * @param objects Objects to test, only objects with collision shapes are paired
+ * @return Overlapping pairs, in the order reported by BruteForceBroadphase
+ */
+std::vector<CollisionPair> BruteForceOverlappingPairs(std::vector<PhysicsObject *> &objects)
+{
+  BruteForceBroadphase bruteForce;
+  std::vector<CollisionPair> allPairs;
+  bruteForce.FindPotentialCollisionPairs(objects, allPairs);
+
+  std::vector<CollisionPair> pairs;
+  for (auto it = allPairs.begin(); it != allPairs.end(); ++it)
+  {
+    if (it->pObjectA->GetWorldSpaceAABB().Intersects(it->pObjectB->GetWorldSpaceAABB()))
+      pairs.push_back(*it);
+  }
+  return pairs;
+}
+
+/**
+ * @brief Checks if two lists of collision pairs are identical, including the order of the objects within each pair.
+ * @param a First list
+ * @param b Second list
+ * @return True if the lists are identical
+ */
+bool SamePairOrder(const std::vector<CollisionPair> &a, const std::vector<CollisionPair> &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i].pObjectA != b[i].pObjectA || a[i].pObjectB != b[i].pObjectB)
+      return false;
+  }
+  return true;
+}
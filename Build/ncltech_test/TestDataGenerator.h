@@ -1,8 +1,19 @@
 #pragma once
 
+#include <set>
+#include <utility>
 #include <vector>
 
+#include <ncltech/IBroadphase.h>
 #include <ncltech/PathEdge.h>
 #include <ncltech/PathNode.h>
 
-void GenerateTestDataSet1(std::vector<PathNode *> &nodes, std::vector<PathEdge *> &edges);
\ No newline at end of file
+typedef std::set<std::pair<PhysicsObject *, PhysicsObject *>> PairSet;
+
+void GenerateTestDataSet1(std::vector<PathNode *> &nodes, std::vector<PathEdge *> &edges);
+
+std::vector<PhysicsObject *> GenerateBoxGrid(size_t n, float spacing);
+PairSet ToPairSet(const std::vector<CollisionPair> &pairs);
+PairSet OverlappingPairs(const std::vector<PhysicsObject *> &objects);
+std::vector<CollisionPair> BruteForceOverlappingPairs(std::vector<PhysicsObject *> &objects);
+bool SamePairOrder(const std::vector<CollisionPair> &a, const std::vector<CollisionPair> &b);
\ No newline at end of file